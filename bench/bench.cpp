@@ -0,0 +1,374 @@
+/*
+ *  bench.cpp
+ *  input throughput and per-phase benchmark for the parser
+ *  author: jordan sun
+ */
+
+#include "parser.hpp"
+#include "mapped_file.hpp"
+#include "rewriter.hpp"
+#include "emitter.hpp"
+#include "what_if_engine.hpp"
+#include "response_time_analysis.hpp"
+#include "thread_pool.hpp"
+#include "workload.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <getopt.h>
+
+using namespace std;
+
+// Time the function over a number of iterations, return the best run in seconds.
+static double best_of(size_t iterations, const function<void()> &run)
+{
+    double best = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        auto start = chrono::steady_clock::now();
+        run();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best)
+        {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+static void report(const string &mode, size_t bytes, size_t statement_count, double seconds)
+{
+    cout << mode << ": " << bytes << " bytes, " << statement_count << " statements, " << seconds * 1000 << " ms, "
+         << (seconds > 0 ? bytes / seconds / (1024 * 1024) : 0) << " MiB/s" << endl;
+}
+
+// Best time of each phase over the iterations, in seconds.
+struct phase_times
+{
+    size_t bytes = 0;
+    size_t nodes = 0;
+    size_t edges = 0;
+    // phases in pipeline order, see PHASE_NAMES
+    vector<double> seconds;
+};
+
+const vector<string> PHASE_NAMES = {"parse", "build", "cycles", "incremental", "freeze", "priorities", "threads", "print", "rewrite", "what-if", "response"};
+
+// Run every phase of the pipeline over the configuration, keeping the best time of each phase.
+// build inserts the edges with the cycle check deferred and cycles runs the batch check,
+// incremental builds the graph again checking each edge as it is inserted,
+// what-if raises the priority of the first task and recomputes only what it reaches,
+// response analyses the response times of the tasks.
+// parse scans chunks of the configuration, and priorities and threads analyse the regions of the graph, on the pool, if any.
+static phase_times time_phases(const string &config, size_t iterations, thread_pool *pool)
+{
+    phase_times times;
+    times.bytes = config.size();
+    times.seconds.assign(PHASE_NAMES.size(), 0);
+    const char *begin = config.data();
+    const char *end = begin + config.size();
+    // errors are expected from hand-written inputs, and printing is timed into memory
+    ostringstream sink;
+    logger no_log;
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        vector<double> seconds;
+        auto start = chrono::steady_clock::now();
+        auto lap = [&]()
+        {
+            auto now = chrono::steady_clock::now();
+            seconds.push_back(chrono::duration<double>(now - start).count());
+            start = now;
+        };
+
+        // diagnosed from scratch on every iteration, as on every run
+        diagnostics diags;
+        diagnostics incremental_diags;
+
+        statements stmts;
+        if (pool != nullptr)
+        {
+            scan_statements(begin, end, stmts, *pool, 0);
+        }
+        else
+        {
+            scan_statements(begin, end, stmts);
+        }
+        lap();
+        graph g;
+        g.defer_cycle_check = true;
+        g.output = &sink;
+        g.diags = &diags;
+        build_graph(stmts, g, no_log);
+        lap();
+        g.check_cycles();
+        lap();
+        {
+            graph incremental;
+            incremental.output = &sink;
+            incremental.diags = &incremental_diags;
+            build_graph(stmts, incremental, no_log);
+        }
+        lap();
+        frozen_graph frozen = g.freeze();
+        frozen.pool = pool;
+        lap();
+        frozen.propagate_priorities();
+        lap();
+        frozen.count_threads();
+        lap();
+        ostringstream printed;
+        emit(frozen.analyse(true), output_format::text, true, printed);
+        lap();
+        string rewritten;
+        rewrite_configuration(begin, end, frozen, rewritten);
+        lap();
+        what_if_engine engine(frozen);
+        uint32_t task = 0;
+        while (task < frozen.size() && frozen.types[task] != type_t::task)
+        {
+            task++;
+        }
+        start = chrono::steady_clock::now();
+        if (task < frozen.size())
+        {
+            engine.apply({what_if_edit::set_priority(frozen.identifiers[task], frozen.get_priority(task) + 1)});
+        }
+        lap();
+        response_time_analysis(frozen).analyse(diags);
+        lap();
+
+        for (size_t phase = 0; phase < seconds.size(); phase++)
+        {
+            if (i == 0 || seconds[phase] < times.seconds[phase])
+            {
+                times.seconds[phase] = seconds[phase];
+            }
+        }
+        times.nodes = frozen.size();
+        times.edges = frozen.requestor_ids.size();
+        sink.str("");
+    }
+    return times;
+}
+
+static void print_phase_header()
+{
+    cout << setw(10) << "bytes" << setw(9) << "nodes" << setw(9) << "edges";
+    for (const string &name : PHASE_NAMES)
+    {
+        cout << setw(12) << name;
+    }
+    cout << "  (ms)" << endl;
+}
+
+static void print_phase_row(const phase_times &times)
+{
+    cout << setw(10) << times.bytes << setw(9) << times.nodes << setw(9) << times.edges << fixed << setprecision(3);
+    for (double seconds : times.seconds)
+    {
+        cout << setw(12) << seconds * 1000;
+    }
+    cout << defaultfloat << endl;
+}
+
+// print how each phase grows with the number of nodes, as the exponent k of time ~ nodes^k between the first and last size
+// phases near 1 scale linearly, anything well above 1 is super-linear
+static void print_scaling(const phase_times &first, const phase_times &last)
+{
+    cout << setw(28) << "scaling exponent" << fixed << setprecision(2);
+    double size_ratio = double(last.nodes) / first.nodes;
+    for (size_t phase = 0; phase < PHASE_NAMES.size(); phase++)
+    {
+        if (first.seconds[phase] > 0 && last.seconds[phase] > 0 && size_ratio > 1)
+        {
+            cout << setw(12) << log(last.seconds[phase] / first.seconds[phase]) / log(size_ratio);
+        }
+        else
+        {
+            cout << setw(12) << "-";
+        }
+    }
+    cout << defaultfloat << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    string input_file_name = "";
+    string output_file_name = "";
+    size_t repeat = 1;
+    size_t iterations = 5;
+    bool generate = false;
+    size_t steps = 1;
+    // analyse in the calling thread unless jobs are given
+    size_t jobs = 1;
+    workload_shape shape;
+    while (true)
+    {
+        int c = getopt(argc, argv, "i:r:n:go:x:s:t:d:w:f:D:S:j:");
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+        case 'i':
+            input_file_name = optarg;
+            break;
+        case 'r':
+            repeat = stoul(optarg);
+            break;
+        case 'n':
+            iterations = stoul(optarg);
+            break;
+        case 'g':
+            generate = true;
+            break;
+        case 'o':
+            output_file_name = optarg;
+            break;
+        case 'x':
+            steps = stoul(optarg);
+            break;
+        case 's':
+            shape.systems = stoul(optarg);
+            break;
+        case 't':
+            shape.tasks = stoul(optarg);
+            break;
+        case 'd':
+            shape.ladder_depth = stoul(optarg);
+            break;
+        case 'w':
+            shape.width = stoul(optarg);
+            break;
+        case 'f':
+            shape.fan_in = stoul(optarg);
+            break;
+        case 'D':
+            shape.diamond_depth = stoul(optarg);
+            break;
+        case 'S':
+            shape.seed = stoull(optarg);
+            break;
+        case 'j':
+            jobs = stoul(optarg);
+            break;
+        default:
+            break;
+        }
+    }
+    if ((input_file_name == "") == !generate || repeat == 0 || iterations == 0 || steps == 0)
+    {
+        cout << "Usage: " << argv[0] << " -i <input file> [-r <repeat>] [-n <iterations>] [-j <jobs>]" << endl;
+        cout << "       " << argv[0] << " -g [-s <systems>] [-t <tasks>] [-d <ladder depth>] [-w <width>] [-f <fan-in>] [-D <diamond depth>] [-S <seed>] [-x <steps>] [-n <iterations>] [-j <jobs>] [-o <output file>]" << endl;
+        return 1;
+    }
+    unique_ptr<thread_pool> pool = jobs != 1 ? make_unique<thread_pool>(jobs) : nullptr;
+
+    if (generate)
+    {
+        if (output_file_name != "")
+        {
+            // write the workload for use with Parser
+            ofstream output_file(output_file_name, ios::binary);
+            output_file << generate_workload(shape);
+            return output_file ? 0 : 1;
+        }
+        // time every phase, doubling the number of systems at each step
+        print_phase_header();
+        vector<phase_times> sweep;
+        size_t systems = shape.systems;
+        for (size_t step = 0; step < steps; step++)
+        {
+            shape.systems = systems << step;
+            sweep.push_back(time_phases(generate_workload(shape), iterations, pool.get()));
+            print_phase_row(sweep.back());
+        }
+        if (sweep.size() > 1)
+        {
+            print_scaling(sweep.front(), sweep.back());
+        }
+        return 0;
+    }
+
+    // replicate the input to build a configuration of the requested size
+    ifstream input_file(input_file_name);
+    if (!input_file.is_open())
+    {
+        cerr << "Error: failed to open input file " << input_file_name << endl;
+        return 1;
+    }
+    ostringstream input_stream;
+    input_stream << input_file.rdbuf();
+    string input = input_stream.str();
+
+    filesystem::path bench_file_name = filesystem::temp_directory_path() / "parser_bench.camkes";
+    {
+        ofstream bench_file(bench_file_name, ios::binary);
+        for (size_t i = 0; i < repeat; i++)
+        {
+            bench_file << input;
+        }
+    }
+    size_t bytes = input.size() * repeat;
+
+    // read the whole file through an ifstream, then scan the copy
+    size_t statement_count = 0;
+    double seconds = best_of(iterations, [&]()
+    {
+        ifstream bench_file(bench_file_name, ios::binary);
+        ostringstream buffer_stream;
+        buffer_stream << bench_file.rdbuf();
+        string buffer = buffer_stream.str();
+        statements stmts;
+        scan_statements(buffer.data(), buffer.data() + buffer.size(), stmts);
+        statement_count = stmts.components.size() + stmts.connections.size() + stmts.priorities.size() + stmts.protocols.size();
+    });
+    report("stream", bytes, statement_count, seconds);
+
+    // map the file and scan it in place
+    seconds = best_of(iterations, [&]()
+    {
+        mapped_file mapped;
+        mapped.open(bench_file_name);
+        statements stmts;
+        scan_statements(mapped.data(), mapped.data() + mapped.size(), stmts);
+        statement_count = stmts.components.size() + stmts.connections.size() + stmts.priorities.size() + stmts.protocols.size();
+    });
+    report("mmap", bytes, statement_count, seconds);
+
+    // map the file and scan it in a chunk per pool thread
+    if (pool != nullptr)
+    {
+        seconds = best_of(iterations, [&]()
+        {
+            mapped_file mapped;
+            mapped.open(bench_file_name);
+            statements stmts;
+            scan_statements(mapped.data(), mapped.data() + mapped.size(), stmts, *pool, 0);
+            statement_count = stmts.components.size() + stmts.connections.size() + stmts.priorities.size() + stmts.protocols.size();
+        });
+        report("chunked", bytes, statement_count, seconds);
+    }
+
+    // every phase over the replicated input
+    print_phase_header();
+    string replicated;
+    replicated.reserve(bytes);
+    for (size_t i = 0; i < repeat; i++)
+    {
+        replicated += input;
+    }
+    print_phase_row(time_phases(replicated, iterations, pool.get()));
+
+    filesystem::remove(bench_file_name);
+    return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ *  workload.cpp
+ *  source file for the synthetic workload generator
+ *  author: jordan sun
+ */
+
+#include "workload.hpp"
+#include <vector>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+
+const char *const PROTOCOLS[] = {"fixed", "inherited", "propagated"};
+
+// Builds one assembly, with the defines, composition and configuration collected separately.
+class workload_writer
+{
+private:
+    mt19937_64 random;
+    // the times are drawn apart, so the priorities and protocols of a seed do not change with them
+    mt19937_64 timing_random;
+    size_t connection_count = 0;
+
+public:
+    string defines;
+    string composition;
+    string configuration;
+
+    explicit workload_writer(uint64_t seed) : random(seed), timing_random(~seed) {}
+
+    // draw a number in [0, bound)
+    size_t draw(size_t bound)
+    {
+        return random() % bound;
+    }
+
+    // draw a time in [0, bound)
+    size_t draw_time(size_t bound)
+    {
+        return timing_random() % bound;
+    }
+
+    void add_task(const string &name)
+    {
+        composition += "\t\tcomponent Task " + name + ";\n";
+        configuration += "\t\t" + name + "._priority = " + to_string(1 + draw(254)) + ";\n";
+        configuration += "\t\t" + name + ".execution_time_pre = " + to_string(draw_time(100)) + ";\n";
+        configuration += "\t\t" + name + ".execution_time_post = " + to_string(draw_time(100)) + ";\n";
+        configuration += "\t\t" + name + ".period = " + to_string(100000 * (1 + draw_time(100))) + ";\n";
+        configuration += "\t\t" + name + ".release_time = 0;\n";
+    }
+
+    // add a server and the connection of its port to some of the requestors, starting at a random one
+    void add_server(const string &name, const vector<string> &requestors, size_t fan_in)
+    {
+        string macro = name + "_num_threads";
+        string conn = "conn_" + to_string(connection_count++);
+        defines += "#define " + macro + " 0\n";
+        composition += "\t\tcomponent Server " + name + ";\n";
+        composition += "\t\tconnection rpc(" + macro + ") " + conn + "(";
+        size_t start = requestors.empty() ? 0 : draw(requestors.size());
+        for (size_t i = 0; i < min(fan_in, requestors.size()); i++)
+        {
+            composition += "from " + requestors[(start + i) % requestors.size()] + ".r_" + name + ", ";
+        }
+        composition += "to " + name + ".r);\n";
+        configuration += "\t\t" + name + ".r_priority = 0;\n";
+        configuration += "\t\t" + name + ".r_priority_protocol = \"" + PROTOCOLS[draw(3)] + "\";\n";
+        configuration += "\t\t" + name + ".r_execution_time = " + to_string(draw_time(20)) + ";\n";
+        configuration += "\t\t" + name + ".r_execution_time_post = " + to_string(draw_time(20)) + ";\n";
+    }
+
+    // add a diamond nested to the depth below the entry, return the server joining it
+    string add_diamond(const string &prefix, const vector<string> &entry, size_t depth, size_t fan_in)
+    {
+        if (depth == 0)
+        {
+            return entry.front();
+        }
+        string left = prefix + "a";
+        string right = prefix + "b";
+        add_server(left, entry, fan_in);
+        add_server(right, entry, fan_in);
+        string left_exit = add_diamond(left + "_", {left}, depth - 1, fan_in);
+        string right_exit = add_diamond(right + "_", {right}, depth - 1, fan_in);
+        string join = prefix + "j";
+        add_server(join, {left_exit, right_exit}, 2);
+        return join;
+    }
+};
+
+string generate_workload(const workload_shape &shape)
+{
+    workload_writer writer(shape.seed);
+    for (size_t system = 0; system < shape.systems; system++)
+    {
+        string prefix = "s" + to_string(system) + "_";
+        vector<string> level;
+        for (size_t task = 0; task < shape.tasks; task++)
+        {
+            level.push_back(prefix + "t" + to_string(task));
+            writer.add_task(level.back());
+        }
+        // each level of the ladder is requested by the level above
+        for (size_t depth = 1; depth <= shape.ladder_depth; depth++)
+        {
+            vector<string> next;
+            for (size_t server = 0; server < shape.width; server++)
+            {
+                next.push_back(prefix + "l" + to_string(depth) + "_" + to_string(server));
+                writer.add_server(next.back(), level, shape.fan_in);
+            }
+            level = next;
+        }
+        if (!level.empty())
+        {
+            writer.add_diamond(prefix + "d", level, shape.diamond_depth, shape.fan_in);
+        }
+    }
+
+    return "// synthetic workload, generated by ParserBench\n" + writer.defines + "\nassembly {\n\tcomposition {\n" + writer.composition + "\t}\n\tconfiguration {\n" + writer.configuration + "\t}\n}\n";
+}
@@ -0,0 +1,35 @@
+/*
+ *  workload.hpp
+ *  header file for the synthetic workload generator
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Shape of a synthetic assembly, following the test configurations.
+// Each system is independent: its tasks request a ladder of server levels, the last level requests nested diamonds.
+struct workload_shape
+{
+    // number of independent systems in the assembly
+    size_t systems = 16;
+    // tasks per system
+    size_t tasks = 8;
+    // server levels below the tasks, like l1 -> l2 -> l3
+    size_t ladder_depth = 4;
+    // servers per level
+    size_t width = 4;
+    // requestors of each server, from the level above, like t1 and t2 on l1a
+    size_t fan_in = 3;
+    // nesting depth of the diamonds below the ladder, each diamond forks into two diamonds and joins them
+    size_t diamond_depth = 2;
+    // seed for the priorities, the mix of fixed, inherited and propagated protocols, and the times
+    uint64_t seed = 1;
+};
+
+// Generate the configuration, with a thread count macro, a port priority and execution times for every connection,
+// and a period for every task, so every phase has work.
+std::string generate_workload(const workload_shape &shape);
@@ -0,0 +1,97 @@
+/*
+ *  analysis_result.hpp
+ *  header file for the analysis results
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "node.hpp"
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Analysed attributes of one node.
+struct node_result
+{
+    // identifier of the node, "node.port" for connections
+    std::string_view identifier;
+    // name of the component or connection
+    std::string_view name;
+    type_t type;
+    protocol_t protocol;
+    std::vector<std::string_view> requestors;
+    // propagated priority, with the ladder applied to nodes that are not tasks
+    size_t priority;
+    size_t thread_count;
+    // whether the thread count comes from the threads reaching the node, rather than being fixed (tasks, ipcp and unset connections)
+    bool traced = false;
+    // the trace behind a traced thread count, only filled when requested:
+    // the tasks reaching the node, the fixed thread sets condensed by ipcp and pip connections, and whether a nested thread is required
+    std::vector<std::string_view> threads;
+    std::vector<std::vector<std::string_view>> fixed_threads;
+    bool nested_thread = false;
+};
+
+// Results of analysing a graph, computed once by frozen_graph::analyse, with the nodes sorted by identifier.
+// The identifiers and names view storage.
+struct analysis_result
+{
+    std::shared_ptr<const void> storage;
+    std::vector<node_result> nodes;
+};
+
+// One protocol assignment on the pareto front.
+struct explored_assignment
+{
+    // sum of the thread counts of all connections
+    size_t threads = 0;
+    // most priority levels below a task that can block it, through a thread it shares with them at a fixed or inherited connection
+    size_t blocking_levels = 0;
+    // protocol of each explored connection, in the order of exploration_result::connections
+    std::vector<protocol_t> protocols;
+};
+
+// Pareto front of the protocol assignments of a graph.
+struct exploration_result
+{
+    // keeps the memory the connections view alive
+    std::shared_ptr<const void> storage;
+    // identifiers of the explored connections, in topological order
+    std::vector<std::string_view> connections;
+    // assignments no other assignment beats on both threads and blocking levels, by increasing threads
+    // of assignments scoring the same, the first in enumeration order (fixed, inherited, propagated) is kept
+    std::vector<explored_assignment> front;
+    // number of partial assignments visited
+    size_t visited = 0;
+    // whether every assignment was covered, false if the search stopped at its limit
+    bool exhaustive = true;
+};
+
+// Worst case response time of one task.
+struct task_response
+{
+    std::string_view identifier;
+    size_t priority;
+    // period of the task, which is also its deadline, and the release time of its first job, UNKNOWN_TIME if not set
+    size_t period;
+    size_t release_time;
+    // worst case execution time of the task, with the servers it calls
+    size_t execution_time;
+    // longest the task can be blocked by tasks of lower priority
+    size_t blocking;
+    // worst case response time, or where the analysis stopped if it is past the period
+    size_t response_time;
+    bool schedulable;
+};
+
+// Results of a response time analysis, with the tasks by decreasing priority then identifier.
+// The identifiers view storage.
+struct schedulability_result
+{
+    std::shared_ptr<const void> storage;
+    std::vector<task_response> tasks;
+    // whether every task meets its deadline
+    bool schedulable = true;
+};
@@ -0,0 +1,36 @@
+/*
+ *  arena.cpp
+ *  source file for the arena class
+ *  author: jordan sun
+ */
+
+#include "arena.hpp"
+#include <cstring>
+#include <cstdint>
+
+using namespace std;
+
+void *arena::allocate(size_t size, size_t alignment)
+{
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+    if (padding + size > remaining)
+    {
+        // large allocations get a block of their own
+        size_t block_size = max(BLOCK_SIZE, size + alignment);
+        blocks.emplace_back(new char[block_size]);
+        cursor = blocks.back().get();
+        remaining = block_size;
+        padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+    }
+    char *result = cursor + padding;
+    cursor += padding + size;
+    remaining -= padding + size;
+    return result;
+}
+
+string_view arena::copy(string_view text)
+{
+    char *result = static_cast<char *>(allocate(text.size(), 1));
+    memcpy(result, text.data(), text.size());
+    return string_view(result, text.size());
+}
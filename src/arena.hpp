@@ -0,0 +1,33 @@
+/*
+ *  arena.hpp
+ *  header file for the arena class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string_view>
+#include <cstddef>
+
+// Bump allocator, everything allocated from it is freed at once when it is destroyed.
+class arena
+{
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char *cursor = nullptr;
+    size_t remaining = 0;
+
+public:
+    arena() = default;
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    // allocate uninitialized memory with the given alignment
+    void *allocate(size_t size, size_t alignment);
+    // copy a string into the arena, return a view of the copy
+    std::string_view copy(std::string_view text);
+};
@@ -0,0 +1,223 @@
+/*
+ *  camkes_parser.cpp
+ *  source file for the camkes_parser class
+ *  author: jordan sun
+ */
+
+#include "camkes_parser.hpp"
+#include "graph.hpp"
+#include "parser.hpp"
+#include "import_resolver.hpp"
+#include "snapshot_cache.hpp"
+#include "stats.hpp"
+#include <sstream>
+#include <fstream>
+
+using namespace std;
+
+camkes_parser::camkes_parser(size_t jobs) : owned_pool(make_unique<thread_pool>(jobs)), pool(*owned_pool), sources(make_unique<source_cache>())
+{
+}
+
+camkes_parser::camkes_parser(thread_pool &pool) : pool(pool), sources(make_unique<source_cache>())
+{
+}
+
+camkes_parser::~camkes_parser() = default;
+
+// Phases 0-4, parse the configuration into the graph, return false if it cannot be read
+// contents is null for a file, the files the graph was built from are added to dependencies
+static bool parse_input(const string &name, const string_view *contents, const parse_options &options, thread_pool &pool, source_cache &sources, graph &g, vector<file_dependency> &dependencies, logger &log)
+{
+    if (options.regex)
+    {
+        /*
+            Phases 1-4: Parse through the original regex passes over the configuration, without expanding imports.
+         */
+        g.files = {name};
+        if (contents != nullptr)
+        {
+            istringstream input{string(*contents)};
+            parse_regex(input, g, log);
+            return true;
+        }
+        ifstream input_file(name);
+        if (!input_file.is_open())
+        {
+            g.diags->report(severity_t::error, "unreadable-input", name, "", 0, "failed to open input file ", name, ".");
+            return false;
+        }
+        parse_regex(input_file, g, log);
+        return true;
+    }
+
+    /*
+        Phase 0: Expand the configuration in place.
+            import "[File]"; and #include "[File]" are searched next to the importing file, then in the include paths.
+            import <[File]>; and #include <[File]> are searched in the include paths only.
+        Imported files are read and scanned concurrently, each file is expanded once, at its first import.
+        Contents scanned by an earlier parse of this parser are found by their hash and not scanned again.
+     */
+    LOG_INFO(log, "Phase 0: Expanding imports...");
+    STATS_START(expand);
+    import_resolver resolver(options.include_paths, options.mmap, options.chunks, pool, sources);
+    resolver.diags = g.diags;
+    statements stmts;
+    if (contents != nullptr)
+    {
+        resolver.expand(name, *contents, stmts, log);
+    }
+    else if (!resolver.expand(name, stmts, log))
+    {
+        STATS_STOP(expand);
+        g.diags->report(severity_t::error, "unreadable-input", name, "", 0, "failed to open input file ", name, ".");
+        return false;
+    }
+    STATS_STOP(expand);
+    LOG_INFO(log, "Scanned ", resolver.get_scanned_count(), " files");
+
+    /*
+        Phases 1-4: Build the graph from the statements classified while scanning.
+            component [ComponentType] [Component];
+            connection rpc([Threads]) [Connection](from/to [Component].[Port], ...);
+            [Component]._priority = [Priority];
+            [Component].[Port]_priority_protocol = "[Protocol]";
+        The statements are views into the file buffers held by the resolver, which are either mapped or read in full.
+     */
+    build_graph(stmts, g, log);
+    dependencies = resolver.get_dependencies();
+    return true;
+}
+
+// Phases 0-4 and the cycle check, then freeze the graph, return false if the configuration cannot be read
+static bool build(const string &name, const string_view *contents, const parse_options &options, thread_pool &pool, source_cache &sources, parse_result &result, frozen_graph &frozen, vector<file_dependency> &dependencies, logger &log)
+{
+    graph g;
+    g.ladder_flag = options.ladder;
+    // defer the cycle check until all edges are inserted
+    g.defer_cycle_check = options.batch_edges;
+    ostringstream cycles;
+    g.output = &cycles;
+    g.diags = &result.diags;
+
+    if (!parse_input(name, contents, options, pool, sources, g, dependencies, log))
+    {
+        return false;
+    }
+    if (options.batch_edges)
+    {
+        LOG_INFO(log, "Checking cycles...");
+        // check all deferred edges at once, removing those that close a cycle
+        STATS_START(cycles);
+        g.check_cycles();
+        STATS_STOP(cycles);
+    }
+    result.cycles = cycles.str();
+
+    LOG_INFO(log, "Finished parsing. Freezing graph...");
+
+    // freeze the graph into its compact form, all analyses run over it
+    STATS_START(freeze);
+    frozen = g.freeze();
+    STATS_STOP(freeze);
+    return true;
+}
+
+// run the analyses over the frozen graph, once, and keep it with the results
+// the independent regions of the graph are analysed concurrently on the pool
+static void analyse(frozen_graph &&frozen, const parse_options &options, thread_pool &pool, parse_result &result, logger &log)
+{
+    frozen.ladder_flag = options.ladder;
+    frozen.diags = &result.diags;
+    frozen.pool = &pool;
+
+    LOG_INFO(log, "Propagating priorities...");
+
+    // propagate the priorities once, the results read the cached values
+    STATS_START(propagate);
+    frozen.propagate_priorities();
+    STATS_STOP(propagate);
+
+    LOG_INFO(log, "Counting threads...");
+
+    // count the threads of every node once, bottom-up
+    STATS_START(count_threads);
+    frozen.count_threads();
+    STATS_STOP(count_threads);
+
+    // the counts declared through rpc([Threads]) are checked against the counted ones
+    frozen.check_thread_counts();
+
+    result.analysis = frozen.analyse(options.trace);
+    // the diagnostics move with the result, which may outlive the pool
+    frozen.diags = nullptr;
+    frozen.pool = nullptr;
+    result.graph = make_shared<const frozen_graph>(move(frozen));
+    result.parsed = true;
+}
+
+parse_result camkes_parser::parse_file(const string &path, const parse_options &options, logger &log) const
+{
+    parse_result result;
+    result.diags.warnings_as_errors = options.warnings_as_errors;
+    result.diags.max_errors = options.max_errors;
+
+    // the graph is loaded from the snapshot cache while none of the files it was built from changed, skipping phases 0-4
+    snapshot_cache cache(options.cache_dir);
+    bool use_cache = options.cache_dir != "" && !options.regex;
+    frozen_graph frozen;
+    vector<diagnostic> messages;
+    STATS_START(cache);
+    bool loaded = use_cache && cache.load(path, options.include_paths, frozen, result.cycles, messages);
+    STATS_STOP(cache);
+    if (loaded)
+    {
+        LOG_INFO(log, "Loaded snapshot from cache.");
+        // replay what was diagnosed while the snapshot was built
+        for (diagnostic &message : messages)
+        {
+            result.diags.add(move(message));
+        }
+    }
+    else
+    {
+        vector<file_dependency> dependencies;
+        if (!build(path, nullptr, options, pool, *sources, result, frozen, dependencies, log))
+        {
+            return result;
+        }
+        STATS_START(cache);
+        if (use_cache && !cache.save(path, options.include_paths, frozen, dependencies, result.cycles, result.diags.get_entries()))
+        {
+            result.diags.report(severity_t::warning, "cache-write", options.cache_dir, "", 0, "failed to write snapshot to ", options.cache_dir, ".");
+        }
+        STATS_STOP(cache);
+    }
+    analyse(move(frozen), options, pool, result, log);
+    return result;
+}
+
+parse_result camkes_parser::parse_file(const string &path, const parse_options &options) const
+{
+    logger log;
+    return parse_file(path, options, log);
+}
+
+parse_result camkes_parser::parse_buffer(string_view contents, const string &name, const parse_options &options, logger &log) const
+{
+    parse_result result;
+    result.diags.warnings_as_errors = options.warnings_as_errors;
+    result.diags.max_errors = options.max_errors;
+
+    frozen_graph frozen;
+    vector<file_dependency> dependencies;
+    build(name, &contents, options, pool, *sources, result, frozen, dependencies, log);
+    analyse(move(frozen), options, pool, result, log);
+    return result;
+}
+
+parse_result camkes_parser::parse_buffer(string_view contents, const string &name, const parse_options &options) const
+{
+    logger log;
+    return parse_buffer(contents, name, options, log);
+}
@@ -0,0 +1,91 @@
+/*
+ *  camkes_parser.hpp
+ *  header file for the camkes_parser class, the entry point of the library
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "analysis_result.hpp"
+#include "diagnostics.hpp"
+#include "frozen_graph.hpp"
+#include "thread_pool.hpp"
+#include "logger.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// How a configuration is parsed and analysed, the library side of the command line flags.
+struct parse_options
+{
+    // searched for imports in order, after the importing file's directory for quoted imports
+    std::vector<std::string> include_paths;
+    // add one to the priority of nodes that are not tasks
+    bool ladder = false;
+    // parse through the original regex passes, without expanding imports
+    bool regex = false;
+    // map files instead of reading them
+    bool mmap = false;
+    // scan each file in up to this many chunks on the pool, one per pool thread for 0, files under 64 KiB are not split
+    size_t chunks = 1;
+    // check for cycles once all edges are inserted, rather than on every edge
+    bool batch_edges = false;
+    // fill in the threads behind each thread count
+    bool trace = false;
+    // directory of graph snapshots, empty for none, only used for files
+    std::string cache_dir;
+    // count warnings as errors
+    bool warnings_as_errors = false;
+    // print only the first errors, 0 for no limit, every error is still collected and counted
+    size_t max_errors = 0;
+};
+
+// Everything found in one configuration.
+struct parse_result
+{
+    // false if the configuration could not be read, the diagnostics say why and nothing else is set
+    bool parsed = false;
+    // priorities, thread counts and requestors of every node
+    analysis_result analysis;
+    // warnings and errors, printed by diagnostics::print
+    diagnostics diags;
+    // edges rejected because they close a cycle, as reported alongside the printed graph
+    std::string cycles;
+    // the analysed graph, to rewrite the configuration with, its diagnostics are already collected above
+    std::shared_ptr<const frozen_graph> graph;
+
+    // whether the configuration was read and no error was diagnosed
+    bool ok() const { return parsed && diags.error_count() == 0; }
+};
+
+class source_cache;
+
+// Parses and analyses configurations in process, from files or from memory.
+// One parser can be shared by any number of threads, imported files are read on its pool.
+// Files read by earlier parses are read again, but contents the parser has already scanned are not scanned again.
+class camkes_parser
+{
+private:
+    std::unique_ptr<thread_pool> owned_pool;
+    thread_pool &pool;
+    // scanned contents of the files read so far, by content hash
+    std::unique_ptr<source_cache> sources;
+
+public:
+    // read imports on a pool of jobs threads, one per hardware thread for 0
+    explicit camkes_parser(size_t jobs = 0);
+    // read imports on a pool shared with other work
+    explicit camkes_parser(thread_pool &pool);
+    ~camkes_parser();
+    camkes_parser(const camkes_parser &) = delete;
+    camkes_parser &operator=(const camkes_parser &) = delete;
+
+    // parse and analyse a configuration file and its imports
+    parse_result parse_file(const std::string &path, const parse_options &options, logger &log) const;
+    parse_result parse_file(const std::string &path, const parse_options &options) const;
+    // parse and analyse a configuration held in memory, name is where it is reported from and where quoted imports are searched next to
+    parse_result parse_buffer(std::string_view contents, const std::string &name, const parse_options &options, logger &log) const;
+    parse_result parse_buffer(std::string_view contents, const std::string &name, const parse_options &options) const;
+};
@@ -0,0 +1,153 @@
+/*
+ *  composition_tree.cpp
+ *  source file for the composition_tree class
+ *  author: jordan sun
+ */
+
+#include "composition_tree.hpp"
+#include <unordered_set>
+#include <algorithm>
+
+using namespace std;
+
+composition_tree::composition_tree(const statements &stmts, diagnostics &diags)
+{
+    // instance 0 is the root of the assemblies and of the statements outside of composite scopes
+    instances.push_back({string_view(), string()});
+    for (const component_statement &stmt : stmts.components)
+    {
+        scope_info &info = scopes[stmt.scope];
+        if (info.member_types.emplace(stmt.name, stmt.type).second)
+        {
+            info.members.push_back(&stmt);
+        }
+    }
+    for (const export_statement &stmt : stmts.exports)
+    {
+        scopes[stmt.scope].exports.emplace(stmt.exported, &stmt);
+    }
+
+    // a composite type no component is declared with is a root, in the order the types are first declared in
+    unordered_set<string_view> instantiated;
+    for (const component_statement &stmt : stmts.components)
+    {
+        instantiated.insert(stmt.type);
+    }
+    for (auto &[scope, info] : scopes)
+    {
+        info.has_composites = any_of(info.members.begin(), info.members.end(), [this](const component_statement *member) { return is_composite(member->type); });
+    }
+
+    vector<string_view> stack;
+    scopes[string_view()].instances.push_back(0);
+    expand(0, stack, stmts.files, diags);
+    for (const component_statement &stmt : stmts.components)
+    {
+        scope_info &info = scopes[stmt.scope];
+        if (stmt.scope.empty() || instantiated.count(stmt.scope) != 0 || !info.instances.empty())
+        {
+            continue;
+        }
+        info.instances.push_back(instances.size());
+        instances.push_back({stmt.scope, string()});
+        expand(info.instances.back(), stack, stmts.files, diags);
+    }
+}
+
+void composition_tree::expand(uint32_t index, vector<string_view> &stack, const vector<string> &files, diagnostics &diags)
+{
+    string_view scope = instances[index].scope;
+    const scope_info &info = scopes.find(scope)->second;
+    stack.push_back(scope);
+    for (const component_statement *member : info.members)
+    {
+        if (!is_composite(member->type))
+        {
+            continue;
+        }
+        if (find(stack.begin(), stack.end(), member->type) != stack.end())
+        {
+            string_view file = member->location.file < files.size() ? string_view(files[member->location.file]) : string_view();
+            diags.report(severity_t::error, "recursive-composition", member->type, file, member->location.line, "component ", member->name, " of type ", member->type, " is declared within its own composition.");
+            continue;
+        }
+        // the instances are appended to while expanding, so the prefix is copied first
+        uint32_t child = instances.size();
+        instances.push_back({member->type, instances[index].prefix + string(member->name) + "."});
+        scopes.find(member->type)->second.instances.push_back(child);
+        expand(child, stack, files, diags);
+    }
+    stack.pop_back();
+}
+
+bool composition_tree::is_composite(string_view type) const
+{
+    if (type.empty())
+    {
+        return false;
+    }
+    auto it = scopes.find(type);
+    return it != scopes.end() && !it->second.members.empty();
+}
+
+const vector<uint32_t> &composition_tree::get_instances(string_view scope) const
+{
+    return is_composite(scope) ? scopes.find(scope)->second.instances : root_instances;
+}
+
+string_view composition_tree::qualify(uint32_t index, string_view name, string &buffer) const
+{
+    const string &prefix = instances[index].prefix;
+    if (prefix.empty())
+    {
+        return name;
+    }
+    buffer = prefix;
+    buffer += name;
+    return buffer;
+}
+
+bool composition_tree::resolve(uint32_t index, string_view &component, string_view &port, string &buffer) const
+{
+    string_view scope = instances[index].scope;
+    // whether buffer holds the prefix of the component, once an export has been followed
+    bool descended = false;
+    // a composite type cannot be nested within itself, so the exports lead down at most once through each scope
+    for (size_t depth = 0; depth <= scopes.size(); depth++)
+    {
+        auto info = scopes.find(scope);
+        if (info == scopes.end() || !info->second.has_composites)
+        {
+            break;
+        }
+        auto member = info->second.member_types.find(component);
+        if (member == info->second.member_types.end() || !is_composite(member->second))
+        {
+            break;
+        }
+        const scope_info &type = scopes.find(member->second)->second;
+        auto exported = type.exports.find(port);
+        if (exported == type.exports.end())
+        {
+            return false;
+        }
+        if (!descended)
+        {
+            buffer = instances[index].prefix;
+            descended = true;
+        }
+        buffer += component;
+        buffer += '.';
+        scope = member->second;
+        component = exported->second->component_name;
+        port = exported->second->port_name;
+    }
+    if (descended)
+    {
+        buffer += component;
+        component = buffer;
+        return true;
+    }
+    component = qualify(index, component, buffer);
+    return true;
+}
@@ -0,0 +1,67 @@
+/*
+ *  composition_tree.hpp
+ *  header file for the composition_tree class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "parser.hpp"
+#include "diagnostics.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Composition scopes of the statements, and the instances they are expanded into.
+// A component type whose definition declares components of its own is composite: every component of that type is
+// expanded into the components of its composition, named [Component].[Inner] after it, and its ports are the ports
+// the composition exports. Assemblies, and composite types no component is declared with, are the roots, expanded
+// once and unprefixed. Statements in other scopes belong to the root.
+class composition_tree
+{
+private:
+    // a composition expanded under a prefix, "[Component]." for every component it is nested in
+    struct instance
+    {
+        std::string_view scope;
+        std::string prefix;
+    };
+
+    struct scope_info
+    {
+        // the components declared in the scope, in declaration order, and their types by name
+        std::vector<const component_statement *> members;
+        std::unordered_map<std::string_view, std::string_view> member_types;
+        // the inner port of each exported port, the first export of a port is kept
+        std::unordered_map<std::string_view, const export_statement *> exports;
+        std::vector<uint32_t> instances;
+        // whether a member is composite, ports of the scope resolve to themselves otherwise
+        bool has_composites = false;
+    };
+
+    std::unordered_map<std::string_view, scope_info> scopes;
+    std::vector<instance> instances;
+    // the root instance of statements outside of any composite scope
+    std::vector<uint32_t> root_instances = {0};
+
+    // expand the composite components an instance declares into instances of their own, recursively
+    // scopes on the stack are being expanded, declaring a component of one of them is reported instead
+    void expand(uint32_t index, std::vector<std::string_view> &stack, const std::vector<std::string> &files, diagnostics &diags);
+
+public:
+    // build the scopes from the statements and expand the roots, reporting recursive compositions to diags
+    composition_tree(const statements &stmts, diagnostics &diags);
+
+    // check if a component type is composite
+    bool is_composite(std::string_view type) const;
+    // get the instances of the scope a statement is declared in
+    const std::vector<uint32_t> &get_instances(std::string_view scope) const;
+    // get the qualified name of a component or connection of an instance, name itself in a root instance
+    // buffer holds the qualified name if it has a prefix
+    std::string_view qualify(uint32_t instance, std::string_view name, std::string &buffer) const;
+    // resolve a port of a component of an instance through the exports of composite components, down to the port of a component node
+    // component is qualified into buffer if needed, return false if a composite component does not export the port
+    bool resolve(uint32_t instance, std::string_view &component, std::string_view &port, std::string &buffer) const;
+};
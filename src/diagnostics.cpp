@@ -0,0 +1,84 @@
+/*
+ *  diagnostics.cpp
+ *  source file for the diagnostics class
+ *  author: jordan sun
+ */
+
+#include "diagnostics.hpp"
+#include <algorithm>
+#include <tuple>
+
+using namespace std;
+
+bool diagnostics::claim(string_view code, string_view subject)
+{
+    return reported.insert({string(code), string(subject)}).second;
+}
+
+void diagnostics::record(diagnostic entry)
+{
+    if (entry.severity == severity_t::error)
+    {
+        errors++;
+    }
+    else
+    {
+        warnings++;
+    }
+    entries.push_back(move(entry));
+}
+
+bool diagnostics::add(diagnostic entry)
+{
+    if (!claim(entry.code, entry.subject))
+    {
+        return false;
+    }
+    record(move(entry));
+    return true;
+}
+
+void diagnostics::print(ostream &os) const
+{
+    vector<const diagnostic *> sorted;
+    sorted.reserve(entries.size());
+    size_t shown_errors = 0;
+    for (const diagnostic &entry : entries)
+    {
+        bool error = entry.severity == severity_t::error || warnings_as_errors;
+        if (error && max_errors != 0 && shown_errors == max_errors)
+        {
+            continue;
+        }
+        shown_errors += error;
+        sorted.push_back(&entry);
+    }
+    // diagnostics without a location first, ties keep the order they were reported in
+    stable_sort(sorted.begin(), sorted.end(), [](const diagnostic *lhs, const diagnostic *rhs)
+    {
+        return tie(lhs->file, lhs->line, lhs->code) < tie(rhs->file, rhs->line, rhs->code);
+    });
+
+    for (const diagnostic *entry : sorted)
+    {
+        if (!entry->file.empty())
+        {
+            os << entry->file << ":";
+            if (entry->line != 0)
+            {
+                os << entry->line << ":";
+            }
+            os << " ";
+        }
+        bool error = entry->severity == severity_t::error || warnings_as_errors;
+        os << (error ? "Error: " : "Warning: ") << entry->message << " [" << entry->code << "]" << endl;
+    }
+    if (shown_errors < error_count())
+    {
+        os << "Error: too many errors, " << error_count() - shown_errors << " more not shown (--max-errors " << max_errors << ")." << endl;
+    }
+    if (error_count() > 0 || warning_count() > 0)
+    {
+        os << warning_count() << (warning_count() == 1 ? " warning" : " warnings") << " and " << error_count() << (error_count() == 1 ? " error" : " errors") << " generated." << endl;
+    }
+}
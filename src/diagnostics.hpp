@@ -0,0 +1,113 @@
+/*
+ *  diagnostics.hpp
+ *  header file for the diagnostics class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_set>
+#include <utility>
+#include <functional>
+#include <sstream>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+enum class severity_t : uint8_t
+{
+    warning,
+    error
+};
+
+// where a statement or node is declared, as an index into a list of files and a 1-based line, 0 if unknown
+struct source_location
+{
+    uint32_t file = 0;
+    uint32_t line = 0;
+};
+
+struct diagnostic
+{
+    severity_t severity;
+    // short name of the check, printed after the message
+    std::string code;
+    // what the diagnostic is about, such as a node, each code is reported once per subject
+    std::string subject;
+    // file and 1-based line, empty and 0 if unknown
+    std::string file;
+    uint32_t line;
+    std::string message;
+};
+
+// Code and subject a diagnostic is reported once for.
+struct diagnostic_key
+{
+    std::string code;
+    std::string subject;
+
+    bool operator==(const diagnostic_key &other) const { return code == other.code && subject == other.subject; }
+};
+
+struct diagnostic_key_hash
+{
+    size_t operator()(const diagnostic_key &key) const
+    {
+        std::hash<std::string> hash;
+        return hash(key.code) * 31 + hash(key.subject);
+    }
+};
+
+// Issues found while parsing and analysing one input.
+// Each is recorded once per code and subject however often the analysis runs into it,
+// and all of them are printed at the end, sorted by location.
+class diagnostics
+{
+private:
+    std::vector<diagnostic> entries;
+    // code and subject of every reported diagnostic
+    std::unordered_set<diagnostic_key, diagnostic_key_hash> reported;
+    size_t errors = 0;
+    size_t warnings = 0;
+
+    // claim a code and subject, return false if already reported
+    bool claim(std::string_view code, std::string_view subject);
+    // count a claimed diagnostic and keep it
+    void record(diagnostic entry);
+
+public:
+    // count warnings as errors, -Werror
+    bool warnings_as_errors = false;
+    // print only the first errors reported, 0 for no limit
+    // every error is still recorded and counted, print reports how many were left out
+    size_t max_errors = 0;
+
+    // record a diagnostic, the message is the concatenation of the arguments
+    // return false if the code was already reported for the subject
+    template <typename... args_t>
+    bool report(severity_t severity, std::string_view code, std::string_view subject, std::string_view file, uint32_t line, const args_t &...args)
+    {
+        if (!claim(code, subject))
+        {
+            return false;
+        }
+        std::ostringstream message;
+        (message << ... << args);
+        record({severity, std::string(code), std::string(subject), std::string(file), line, message.str()});
+        return true;
+    }
+    // record a diagnostic already formatted, such as one replayed from a snapshot, return false if it is a duplicate
+    bool add(diagnostic entry);
+
+    // get the number of errors, counting warnings with warnings_as_errors
+    size_t error_count() const { return errors + (warnings_as_errors ? warnings : 0); }
+    size_t warning_count() const { return warnings_as_errors ? 0 : warnings; }
+    // get the recorded diagnostics in the order they were reported
+    const std::vector<diagnostic> &get_entries() const { return entries; }
+    // print the diagnostics sorted by file, line and code, then a summary of the counts
+    // past max_errors, the errors reported later are left out
+    void print(std::ostream &os) const;
+};
@@ -0,0 +1,460 @@
+/*
+ *  emitter.cpp
+ *  source file for the analysis result emitters
+ *  author: jordan sun
+ */
+
+#include "emitter.hpp"
+#include <charconv>
+
+using namespace std;
+
+bool parse_output_format(string_view name, output_format &format)
+{
+    if (name == "text")
+    {
+        format = output_format::text;
+    }
+    else if (name == "json")
+    {
+        format = output_format::json;
+    }
+    else if (name == "csv")
+    {
+        format = output_format::csv;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+output_buffer &output_buffer::operator<<(size_t value)
+{
+    char digits[24];
+    buffer.append(digits, to_chars(digits, digits + sizeof(digits), value).ptr);
+    return *this;
+}
+
+void output_buffer::flush()
+{
+    os.write(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+static string_view type_name(type_t type)
+{
+    return type == type_t::connection ? "connection" : type == type_t::task ? "task" : "component";
+}
+
+static string_view protocol_name(protocol_t protocol)
+{
+    return protocol == protocol_t::ipcp ? "ipcp" : protocol == protocol_t::pip ? "pip" : protocol == protocol_t::propagation ? "propagation" : "none";
+}
+
+// write the names separated by ", "
+static void write_list(output_buffer &out, const vector<string_view> &names)
+{
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (i > 0)
+        {
+            out << ", ";
+        }
+        out << names[i];
+    }
+}
+
+// {threads{fixed}, {fixed}} + nested thread = , as the original parser traced it
+static void write_text_trace(output_buffer &out, const node_result &node)
+{
+    out << '{';
+    write_list(out, node.threads);
+    if (!node.fixed_threads.empty())
+    {
+        out << '{';
+    }
+    for (size_t i = 0; i < node.fixed_threads.size(); i++)
+    {
+        if (i > 0)
+        {
+            out << ", {";
+        }
+        write_list(out, node.fixed_threads[i]);
+        out << '}';
+    }
+    out << '}';
+    if (node.nested_thread)
+    {
+        out << " + nested thread";
+    }
+    out << " = ";
+}
+
+static void emit_text(const analysis_result &result, bool trace, output_buffer &out)
+{
+    for (const node_result &node : result.nodes)
+    {
+        if (node.type == type_t::connection)
+        {
+            out << "connection " << node.name << '\n';
+            out << "\tport of component: " << node.identifier << '\n';
+            out << "\tprotocol: " << protocol_name(node.protocol) << '\n';
+        }
+        else
+        {
+            out << "component " << node.name << '\n';
+            out << "\ttype: " << type_name(node.type) << '\n';
+        }
+        out << "\trequestors: \n";
+        for (string_view requestor : node.requestors)
+        {
+            out << "\t\t" << requestor << '\n';
+        }
+        out << "\tpriority: " << node.priority << '\n';
+        out << "\tnumber of threads: ";
+        if (trace && node.traced)
+        {
+            write_text_trace(out, node);
+        }
+        out << node.thread_count << '\n';
+    }
+}
+
+static void write_json_string(output_buffer &out, string_view text)
+{
+    static const char HEX[] = "0123456789abcdef";
+    out << '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            out << "\\u00" << HEX[c >> 4] << HEX[c & 15];
+        }
+        else
+        {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+static void write_json_list(output_buffer &out, const vector<string_view> &names)
+{
+    out << '[';
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (i > 0)
+        {
+            out << ", ";
+        }
+        write_json_string(out, names[i]);
+    }
+    out << ']';
+}
+
+static void emit_json(const analysis_result &result, bool trace, output_buffer &out)
+{
+    out << "{\n  \"nodes\": [";
+    for (size_t i = 0; i < result.nodes.size(); i++)
+    {
+        const node_result &node = result.nodes[i];
+        out << (i > 0 ? ",\n    {" : "\n    {");
+        out << "\"identifier\": ";
+        write_json_string(out, node.identifier);
+        out << ", \"name\": ";
+        write_json_string(out, node.name);
+        out << ", \"type\": \"" << type_name(node.type) << '"';
+        if (node.type == type_t::connection)
+        {
+            out << ", \"protocol\": \"" << protocol_name(node.protocol) << '"';
+        }
+        out << ", \"requestors\": ";
+        write_json_list(out, node.requestors);
+        out << ", \"priority\": " << node.priority << ", \"threads\": " << node.thread_count;
+        if (trace && node.traced)
+        {
+            out << ", \"trace\": {\"threads\": ";
+            write_json_list(out, node.threads);
+            out << ", \"fixed_threads\": [";
+            for (size_t j = 0; j < node.fixed_threads.size(); j++)
+            {
+                if (j > 0)
+                {
+                    out << ", ";
+                }
+                write_json_list(out, node.fixed_threads[j]);
+            }
+            out << "], \"nested_thread\": " << (node.nested_thread ? "true" : "false") << '}';
+        }
+        out << '}';
+    }
+    out << (result.nodes.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+// quote a field if it holds a comma, a quote or a line break
+static void write_csv_field(output_buffer &out, string_view text)
+{
+    if (text.find_first_of(",\"\r\n") == string_view::npos)
+    {
+        out << text;
+        return;
+    }
+    out << '"';
+    for (char c : text)
+    {
+        if (c == '"')
+        {
+            out << '"';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+// join the names with a separator into one field
+static void write_csv_list(output_buffer &out, const vector<string_view> &names, string_view separator)
+{
+    string joined;
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (i > 0)
+        {
+            joined.append(separator);
+        }
+        joined.append(names[i]);
+    }
+    write_csv_field(out, joined);
+}
+
+static void emit_csv(const analysis_result &result, bool trace, output_buffer &out)
+{
+    out << "identifier,name,type,protocol,requestors,priority,threads";
+    if (trace)
+    {
+        out << ",trace_threads,trace_fixed_threads,trace_nested_thread";
+    }
+    out << '\n';
+    for (const node_result &node : result.nodes)
+    {
+        write_csv_field(out, node.identifier);
+        out << ',';
+        write_csv_field(out, node.name);
+        out << ',' << type_name(node.type) << ',';
+        if (node.type == type_t::connection)
+        {
+            out << protocol_name(node.protocol);
+        }
+        out << ',';
+        write_csv_list(out, node.requestors, ";");
+        out << ',' << node.priority << ',' << node.thread_count;
+        if (trace)
+        {
+            out << ',';
+            // fixed thread sets are separated by '|', their threads by ';'
+            if (node.traced)
+            {
+                write_csv_list(out, node.threads, ";");
+                out << ',';
+                string fixed;
+                for (size_t i = 0; i < node.fixed_threads.size(); i++)
+                {
+                    if (i > 0)
+                    {
+                        fixed.push_back('|');
+                    }
+                    for (size_t j = 0; j < node.fixed_threads[i].size(); j++)
+                    {
+                        if (j > 0)
+                        {
+                            fixed.push_back(';');
+                        }
+                        fixed.append(node.fixed_threads[i][j]);
+                    }
+                }
+                write_csv_field(out, fixed);
+                out << ',' << (node.nested_thread ? "true" : "false");
+            }
+            else
+            {
+                out << ",,";
+            }
+        }
+        out << '\n';
+    }
+}
+
+// protocol as written in a configuration
+static string_view configured_protocol_name(protocol_t protocol)
+{
+    return protocol == protocol_t::ipcp ? "fixed" : protocol == protocol_t::pip ? "inherited" : "propagated";
+}
+
+static void emit_exploration_text(const exploration_result &result, output_buffer &out)
+{
+    out << "explored " << result.connections.size() << " connections, " << result.visited << " partial assignments visited, " << (result.exhaustive ? "exhaustive" : "stopped at the limit") << '\n';
+    for (const explored_assignment &point : result.front)
+    {
+        out << "threads: " << point.threads << ", blocking levels: " << point.blocking_levels << '\n';
+        for (size_t i = 0; i < result.connections.size(); i++)
+        {
+            out << '\t' << result.connections[i] << "_priority_protocol = \"" << configured_protocol_name(point.protocols[i]) << "\";\n";
+        }
+    }
+}
+
+static void emit_exploration_json(const exploration_result &result, output_buffer &out)
+{
+    out << "{\n  \"connections\": ";
+    write_json_list(out, result.connections);
+    out << ",\n  \"visited\": " << result.visited << ",\n  \"exhaustive\": " << (result.exhaustive ? "true" : "false") << ",\n  \"front\": [";
+    for (size_t i = 0; i < result.front.size(); i++)
+    {
+        const explored_assignment &point = result.front[i];
+        out << (i > 0 ? ",\n    {" : "\n    {");
+        out << "\"threads\": " << point.threads << ", \"blocking_levels\": " << point.blocking_levels << ", \"protocols\": {";
+        for (size_t j = 0; j < result.connections.size(); j++)
+        {
+            if (j > 0)
+            {
+                out << ", ";
+            }
+            write_json_string(out, result.connections[j]);
+            out << ": \"" << configured_protocol_name(point.protocols[j]) << '"';
+        }
+        out << "}}";
+    }
+    out << (result.front.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+static void emit_exploration_csv(const exploration_result &result, output_buffer &out)
+{
+    out << "threads,blocking_levels";
+    for (string_view connection : result.connections)
+    {
+        out << ',';
+        write_csv_field(out, connection);
+    }
+    out << '\n';
+    for (const explored_assignment &point : result.front)
+    {
+        out << point.threads << ',' << point.blocking_levels;
+        for (protocol_t protocol : point.protocols)
+        {
+            out << ',' << configured_protocol_name(protocol);
+        }
+        out << '\n';
+    }
+}
+
+void emit(const exploration_result &result, output_format format, ostream &os)
+{
+    output_buffer out(os);
+    switch (format)
+    {
+    case output_format::text:
+        emit_exploration_text(result, out);
+        break;
+    case output_format::json:
+        emit_exploration_json(result, out);
+        break;
+    case output_format::csv:
+        emit_exploration_csv(result, out);
+        break;
+    }
+}
+
+static void emit_schedulability_text(const schedulability_result &result, output_buffer &out)
+{
+    out << "analysed " << result.tasks.size() << " tasks, " << (result.schedulable ? "schedulable" : "not schedulable") << '\n';
+    for (const task_response &task : result.tasks)
+    {
+        out << task.identifier << ": priority " << task.priority << ", period " << task.period << ", release time ";
+        if (task.release_time == UNKNOWN_TIME)
+        {
+            out << "none";
+        }
+        else
+        {
+            out << task.release_time;
+        }
+        out << ", execution time " << task.execution_time << ", blocking " << task.blocking << ", response time " << task.response_time << (task.schedulable ? ", meets its deadline\n" : ", misses its deadline\n");
+    }
+}
+
+static void emit_schedulability_json(const schedulability_result &result, output_buffer &out)
+{
+    out << "{\n  \"schedulable\": " << (result.schedulable ? "true" : "false") << ",\n  \"tasks\": [";
+    for (size_t i = 0; i < result.tasks.size(); i++)
+    {
+        const task_response &task = result.tasks[i];
+        out << (i > 0 ? ",\n    {" : "\n    {");
+        out << "\"identifier\": ";
+        write_json_string(out, task.identifier);
+        out << ", \"priority\": " << task.priority << ", \"period\": " << task.period << ", \"release_time\": ";
+        if (task.release_time == UNKNOWN_TIME)
+        {
+            out << "null";
+        }
+        else
+        {
+            out << task.release_time;
+        }
+        out << ", \"execution_time\": " << task.execution_time << ", \"blocking\": " << task.blocking << ", \"response_time\": " << task.response_time << ", \"schedulable\": " << (task.schedulable ? "true" : "false") << '}';
+    }
+    out << (result.tasks.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+static void emit_schedulability_csv(const schedulability_result &result, output_buffer &out)
+{
+    out << "identifier,priority,period,release_time,execution_time,blocking,response_time,schedulable\n";
+    for (const task_response &task : result.tasks)
+    {
+        write_csv_field(out, task.identifier);
+        out << ',' << task.priority << ',' << task.period << ',';
+        if (task.release_time != UNKNOWN_TIME)
+        {
+            out << task.release_time;
+        }
+        out << ',' << task.execution_time << ',' << task.blocking << ',' << task.response_time << ',' << (task.schedulable ? "true" : "false") << '\n';
+    }
+}
+
+void emit(const schedulability_result &result, output_format format, ostream &os)
+{
+    output_buffer out(os);
+    switch (format)
+    {
+    case output_format::text:
+        emit_schedulability_text(result, out);
+        break;
+    case output_format::json:
+        emit_schedulability_json(result, out);
+        break;
+    case output_format::csv:
+        emit_schedulability_csv(result, out);
+        break;
+    }
+}
+
+void emit(const analysis_result &result, output_format format, bool trace, ostream &os)
+{
+    output_buffer out(os);
+    switch (format)
+    {
+    case output_format::text:
+        emit_text(result, trace, out);
+        break;
+    case output_format::json:
+        emit_json(result, trace, out);
+        break;
+    case output_format::csv:
+        emit_csv(result, trace, out);
+        break;
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ *  emitter.hpp
+ *  header file for the analysis result emitters
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "analysis_result.hpp"
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <cstddef>
+
+enum class output_format
+{
+    text,
+    json,
+    csv
+};
+
+// parse a format name (text, json or csv), return false if unknown
+bool parse_output_format(std::string_view name, output_format &format);
+
+// Formats into a string and hands it to the stream in large blocks, never flushing it.
+class output_buffer
+{
+private:
+    std::ostream &os;
+    std::string buffer;
+
+public:
+    static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+    explicit output_buffer(std::ostream &os) : os(os) { buffer.reserve(BLOCK_SIZE); }
+    ~output_buffer() { flush(); }
+    output_buffer(const output_buffer &) = delete;
+    output_buffer &operator=(const output_buffer &) = delete;
+
+    output_buffer &operator<<(std::string_view text)
+    {
+        buffer.append(text);
+        if (buffer.size() >= BLOCK_SIZE)
+        {
+            flush();
+        }
+        return *this;
+    }
+    output_buffer &operator<<(char c)
+    {
+        buffer.push_back(c);
+        return *this;
+    }
+    output_buffer &operator<<(size_t value);
+
+    // hand what is buffered to the stream
+    void flush();
+};
+
+// Write the results in the format, the trace of the thread counts is only written if requested and filled in.
+//     text    the graph as printed by the original parser, one block per node
+//     json    {"nodes": [{...}, ...]} with one object per node
+//     csv     a header, then one row per node, requestors separated by ';'
+void emit(const analysis_result &result, output_format format, bool trace, std::ostream &os);
+
+// Write the pareto front of an exploration in the format.
+//     text    each point followed by its assignment, as the configuration would set it
+//     json    {"connections": [...], "front": [{...}, ...]} with the protocols of each point by connection
+//     csv     a header naming the connections, then one row per point
+void emit(const exploration_result &result, output_format format, std::ostream &os);
+
+// Write the response times of an analysis in the format, unset release times as none, null or empty.
+//     text    whether the tasks are schedulable, then one line per task
+//     json    {"schedulable": ..., "tasks": [{...}, ...]} with one object per task
+//     csv     a header, then one row per task
+void emit(const schedulability_result &result, output_format format, std::ostream &os);
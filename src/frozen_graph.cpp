@@ -0,0 +1,642 @@
+/*
+ *  frozen_graph.cpp
+ *  source file for the frozen_graph class
+ *  author: jordan sun
+ */
+
+#include "frozen_graph.hpp"
+#include "stats.hpp"
+#include <iostream>
+#include <algorithm>
+#include <queue>
+#include <future>
+#include <cctype>
+
+using namespace std;
+
+// regions are packed into jobs of at least this many nodes, so small regions do not each pay for a task
+const uint32_t JOB_NODES = 1024;
+
+bool frozen_graph::build_index()
+{
+    sorted_ids.resize(size());
+    for (uint32_t id = 0; id < size(); id++)
+    {
+        sorted_ids[id] = id;
+    }
+    sort(sorted_ids.begin(), sorted_ids.end(), [this](uint32_t lhs, uint32_t rhs)
+    {
+        return identifiers[lhs] < identifiers[rhs];
+    });
+    auto duplicate = adjacent_find(sorted_ids.begin(), sorted_ids.end(), [this](uint32_t lhs, uint32_t rhs)
+    {
+        return identifiers[lhs] == identifiers[rhs];
+    });
+    return duplicate == sorted_ids.end() && index.build(identifiers);
+}
+
+uint32_t frozen_graph::find(string_view identifier) const
+{
+    uint32_t id = index.lookup(identifier);
+    if (id == perfect_hash::NOT_FOUND || identifiers[id] != identifier)
+    {
+        return NO_NODE;
+    }
+    return id;
+}
+
+vector<uint32_t> frozen_graph::topological_order() const
+{
+    uint32_t num_nodes = size();
+    vector<uint32_t> order;
+    order.reserve(num_nodes);
+
+    // a node is ready once all of its requestors are (kahn's algorithm)
+    vector<uint32_t> pending(num_nodes);
+    for (uint32_t id = 0; id < num_nodes; id++)
+    {
+        pending[id] = requestor_count(id);
+        if (pending[id] == 0)
+        {
+            order.push_back(id);
+        }
+    }
+    // the order doubles as the queue of ready nodes
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        uint32_t id = order[i];
+        for (uint32_t j = dependent_offsets[id]; j < dependent_offsets[id + 1]; j++)
+        {
+            uint32_t dependent = dependent_ids[j];
+            if (--pending[dependent] == 0)
+            {
+                order.push_back(dependent);
+            }
+        }
+    }
+    return order;
+}
+
+size_t frozen_graph::compute_priority(uint32_t id) const
+{
+    if (requestor_count(id) == 0)
+    {
+        // nodes without requestors keep their own priority
+        return assigned_priorities[id];
+    }
+    // propagate the max priority of all requestors, which are already visited
+    size_t max_priority = 0;
+    for (uint32_t i = requestor_offsets[id]; i < requestor_offsets[id + 1]; i++)
+    {
+        max_priority = max(max_priority, priorities[requestor_ids[i]]);
+    }
+    return max_priority;
+}
+
+void frozen_graph::build_regions() const
+{
+    uint32_t num_nodes = size();
+    // union find over the edges, each region is named by its smallest node id
+    vector<uint32_t> parent(num_nodes);
+    for (uint32_t id = 0; id < num_nodes; id++)
+    {
+        parent[id] = id;
+    }
+    auto find_root = [&](uint32_t id)
+    {
+        while (parent[id] != id)
+        {
+            parent[id] = parent[parent[id]];
+            id = parent[id];
+        }
+        return id;
+    };
+    for (uint32_t id = 0; id < num_nodes; id++)
+    {
+        for (uint32_t i = requestor_offsets[id]; i < requestor_offsets[id + 1]; i++)
+        {
+            uint32_t lhs = find_root(id);
+            uint32_t rhs = find_root(requestor_ids[i]);
+            parent[max(lhs, rhs)] = min(lhs, rhs);
+        }
+    }
+
+    // number the regions in the order of their smallest node, and count their nodes
+    vector<uint32_t> region(num_nodes);
+    vector<uint32_t> region_offsets(1, 0);
+    for (uint32_t id = 0; id < num_nodes; id++)
+    {
+        uint32_t root = find_root(id);
+        if (root == id)
+        {
+            region[id] = region_offsets.size() - 1;
+            region_offsets.push_back(0);
+        }
+        else
+        {
+            region[id] = region[root];
+        }
+        region_offsets[region[id] + 1]++;
+    }
+    for (size_t i = 1; i < region_offsets.size(); i++)
+    {
+        region_offsets[i] += region_offsets[i - 1];
+    }
+
+    // bucket the topological order by region, which keeps it topological within each region
+    region_order.resize(num_nodes);
+    vector<uint32_t> next(region_offsets.begin(), region_offsets.end() - 1);
+    for (uint32_t id : topological_order())
+    {
+        region_order[next[region[id]]++] = id;
+    }
+    job_offsets.assign(1, 0);
+    for (size_t i = 1; i < region_offsets.size(); i++)
+    {
+        if (region_offsets[i] - job_offsets.back() >= JOB_NODES || i + 1 == region_offsets.size())
+        {
+            job_offsets.push_back(region_offsets[i]);
+        }
+    }
+}
+
+template <typename visit_t>
+void frozen_graph::run_jobs(const visit_t &visit) const
+{
+    // built once, job_offsets then holds at least the start of the first job, even without nodes
+    if (job_offsets.empty())
+    {
+        build_regions();
+    }
+    size_t jobs = job_offsets.size() - 1;
+    if (pool == nullptr || pool->size() <= 1 || jobs <= 1)
+    {
+        pass_context context{fixed_sets, *diags};
+        for (uint32_t id : region_order)
+        {
+            visit(id, context);
+        }
+        return;
+    }
+
+    // the jobs share no nodes, only the fixed sets and diagnostics, which each job keeps to itself
+    vector<fixed_set_table> job_sets(jobs);
+    vector<diagnostics> job_diags(jobs);
+    vector<task_future<void>> runs;
+    runs.reserve(jobs);
+    for (size_t job = 0; job < jobs; job++)
+    {
+        runs.push_back(pool->submit([this, &visit, &job_sets, &job_diags, job]()
+        {
+            pass_context context{job_sets[job], job_diags[job]};
+            for (uint32_t i = job_offsets[job]; i < job_offsets[job + 1]; i++)
+            {
+                visit(region_order[i], context);
+            }
+        }));
+    }
+    for (task_future<void> &run : runs)
+    {
+        pool->wait(run);
+    }
+
+    for (size_t job = 0; job < jobs; job++)
+    {
+        for (const diagnostic &entry : job_diags[job].get_entries())
+        {
+            diags->add(entry);
+        }
+        if (job_sets[job].sets.empty())
+        {
+            continue;
+        }
+        // intern the job's fixed sets, and point the summaries of its nodes at them
+        vector<uint32_t> handles(job_sets[job].sets.size());
+        for (size_t handle = 0; handle < handles.size(); handle++)
+        {
+            handles[handle] = fixed_sets.intern(job_sets[job].sets[handle]);
+        }
+        for (uint32_t i = job_offsets[job]; i < job_offsets[job + 1]; i++)
+        {
+            uint32_t id = region_order[i];
+            for (uint32_t slot : {requested_summary[id], requested_summary[id] + 1})
+            {
+                for (uint32_t &handle : summaries[slot].fixed_threads_pool)
+                {
+                    handle = handles[handle];
+                }
+            }
+        }
+    }
+}
+
+void frozen_graph::propagate_priorities() const
+{
+    priorities.assign(size(), 0);
+
+    // a node's priority only depends on its requestors, within its region
+    run_jobs([this](uint32_t id, pass_context &context)
+    {
+        if (requestor_count(id) > 1 && types[id] == type_t::component)
+        {
+            context.diags.report(severity_t::warning, "multiple-input-ports", identifiers[id], get_file(id), locations[id].line, "component ", names[id], " has more than one input port.");
+        }
+        priorities[id] = compute_priority(id);
+    });
+
+    priorities_valid = true;
+}
+
+size_t frozen_graph::get_priority(uint32_t id) const
+{
+    STATS_ADD(get_priority_calls, 1);
+    if (!priorities_valid)
+    {
+        propagate_priorities();
+    }
+    return priorities[id];
+}
+
+uint32_t fixed_set_table::intern(const thread_set &set)
+{
+    auto it = handles.find(set);
+    if (it != handles.end())
+    {
+        return it->second;
+    }
+    uint32_t handle = sets.size();
+    sets.push_back(set);
+    handles.emplace(set, handle);
+    return handle;
+}
+
+// append the threads provided by a requestor to the accumulated summary
+static void accumulate(thread_summary &summary, const thread_summary &provided)
+{
+    summary.threads |= provided.threads;
+    summary.fixed_threads_pool.insert(summary.fixed_threads_pool.end(), provided.fixed_threads_pool.begin(), provided.fixed_threads_pool.end());
+    // the last ipcp or pip connection visited decides on the nested thread
+    if (provided.nested_decided)
+    {
+        summary.nested_decided = true;
+        summary.require_nested_thread = provided.require_nested_thread;
+    }
+}
+
+void frozen_graph::count_threads() const
+{
+    uint32_t num_nodes = size();
+
+    // assign dense task indices in id order
+    task_index.assign(num_nodes, NO_NODE);
+    tasks.clear();
+    for (uint32_t id = 0; id < num_nodes; id++)
+    {
+        if (types[id] == type_t::task)
+        {
+            task_index[id] = tasks.size();
+            tasks.push_back(id);
+        }
+    }
+
+    fixed_sets.clear();
+    // each node has two slots, for what it requests and for what it provides unless it passes that on
+    summaries.assign(num_nodes * 2, thread_summary());
+    requested_summary.resize(num_nodes);
+    provided_summary.resize(num_nodes);
+    for (uint32_t id = 0; id < num_nodes; id++)
+    {
+        requested_summary[id] = id * 2;
+        provided_summary[id] = id * 2 + 1;
+    }
+    thread_counts.assign(num_nodes, 0);
+
+    // requestors are summarized before the nodes they request, within each region
+    run_jobs([this](uint32_t id, pass_context &context)
+    {
+        summarize(id, context);
+    });
+
+    threads_valid = true;
+}
+
+thread_summary &frozen_graph::gather(uint32_t id) const
+{
+    // what the requestors provide, in id order, into the node's own slot
+    thread_summary &requested = summaries[requested_summary[id]];
+    requested.threads.reset(tasks.size());
+    requested.fixed_threads_pool.clear();
+    requested.nested_decided = false;
+    requested.require_nested_thread = false;
+    for (uint32_t i = requestor_offsets[id]; i < requestor_offsets[id + 1]; i++)
+    {
+        accumulate(requested, summaries[provided_summary[requestor_ids[i]]]);
+    }
+    STATS_PEAK(thread_set_size, requested.threads.size());
+    STATS_PEAK(fixed_threads_pool, requested.fixed_threads_pool.size());
+    return requested;
+}
+
+size_t frozen_graph::count_requested(const thread_summary &requested, const fixed_set_table &sets) const
+{
+    size_t count = requested.threads.size();
+    for (uint32_t handle : requested.fixed_threads_pool)
+    {
+        // if fixed threads is not a subset of threads, increment count by 1.
+        if (!sets[handle].is_subset_of(requested.threads))
+        {
+            count++;
+        }
+    }
+    // increment count if nested thread is required.
+    if (requested.require_nested_thread)
+    {
+        count++;
+    }
+    return count;
+}
+
+void frozen_graph::summarize_task(uint32_t id) const
+{
+    // a task has no requestors and runs on its own thread, which it provides
+    gather(id);
+    thread_summary &provided = summaries[requested_summary[id] + 1];
+    provided.threads.reset(tasks.size());
+    provided.threads.insert(task_index[id]);
+    provided.fixed_threads_pool.clear();
+    provided.nested_decided = false;
+    provided.require_nested_thread = false;
+    provided_summary[id] = requested_summary[id] + 1;
+    thread_counts[id] = 1;
+}
+
+void frozen_graph::summarize_passing(uint32_t id, const fixed_set_table &sets) const
+{
+    // components and propagation connections provide what they request
+    const thread_summary &requested = gather(id);
+    provided_summary[id] = requested_summary[id];
+    thread_counts[id] = count_requested(requested, sets);
+}
+
+void frozen_graph::summarize_condensing(uint32_t id, fixed_set_table &sets) const
+{
+    const thread_summary &requested = gather(id);
+    // both the threads and the fixed threads pool are condensed into a single fixed set
+    thread_summary &provided = summaries[requested_summary[id] + 1];
+    provided.threads = requested.threads;
+    for (uint32_t handle : requested.fixed_threads_pool)
+    {
+        provided.threads |= sets[handle];
+    }
+    uint32_t handle = sets.intern(provided.threads);
+    provided.threads.reset(tasks.size());
+    provided.fixed_threads_pool.assign(1, handle);
+    // require nested thread if protocol is pip, do not if protocol is ipcp
+    provided.nested_decided = true;
+    provided.require_nested_thread = (protocols[id] == protocol_t::pip);
+    provided_summary[id] = requested_summary[id] + 1;
+    // fixed thread count of 1 for ipcp
+    thread_counts[id] = protocols[id] == protocol_t::ipcp ? 1 : count_requested(requested, sets);
+}
+
+void frozen_graph::summarize_unset(uint32_t id, diagnostics &reported) const
+{
+    gather(id);
+    reported.report(severity_t::error, "missing-protocol", identifiers[id], get_file(id), locations[id].line, names[id], " has no protocol set.");
+    thread_summary &provided = summaries[requested_summary[id] + 1];
+    provided.threads.reset(tasks.size());
+    provided.fixed_threads_pool.clear();
+    provided.nested_decided = false;
+    provided.require_nested_thread = false;
+    provided_summary[id] = requested_summary[id] + 1;
+    thread_counts[id] = 0;
+}
+
+void frozen_graph::summarize(uint32_t id, pass_context &context) const
+{
+    switch (types[id])
+    {
+    case type_t::task:
+        summarize_task(id);
+        break;
+    case type_t::component:
+        summarize_passing(id, context.fixed_sets);
+        break;
+    default:
+        switch (protocols[id])
+        {
+        case protocol_t::propagation:
+            summarize_passing(id, context.fixed_sets);
+            break;
+        case protocol_t::ipcp:
+        case protocol_t::pip:
+            summarize_condensing(id, context.fixed_sets);
+            break;
+        default:
+            summarize_unset(id, context.diags);
+            break;
+        }
+        break;
+    }
+}
+
+void frozen_graph::summarize(uint32_t id) const
+{
+    pass_context context{fixed_sets, *diags};
+    summarize(id, context);
+}
+
+size_t frozen_graph::get_thread_count(uint32_t id) const
+{
+    STATS_ADD(get_thread_count_calls, 1);
+    if (!threads_valid)
+    {
+        count_threads();
+    }
+    return thread_counts[id];
+}
+
+vector<uint32_t> frozen_graph::update(const vector<uint32_t> &edited) const
+{
+    vector<uint32_t> changed;
+    if (!priorities_valid || !threads_valid)
+    {
+        // nothing to compare against, every node is new
+        propagate_priorities();
+        count_threads();
+        changed.resize(size());
+        for (uint32_t id = 0; id < size(); id++)
+        {
+            changed[id] = id;
+        }
+        return changed;
+    }
+    if (topological_positions.size() != size())
+    {
+        vector<uint32_t> order = topological_order();
+        topological_positions.resize(size());
+        for (uint32_t position = 0; position < order.size(); position++)
+        {
+            topological_positions[order[position]] = position;
+        }
+    }
+
+    // dirty nodes by topological position, so every node is visited after its dirty requestors
+    priority_queue<pair<uint32_t, uint32_t>, vector<pair<uint32_t, uint32_t>>, greater<pair<uint32_t, uint32_t>>> dirty;
+    vector<bool> queued(size(), false);
+    auto mark = [&](uint32_t id)
+    {
+        if (!queued[id])
+        {
+            queued[id] = true;
+            dirty.emplace(topological_positions[id], id);
+        }
+    };
+    for (uint32_t id : edited)
+    {
+        mark(id);
+    }
+
+    while (!dirty.empty())
+    {
+        uint32_t id = dirty.top().second;
+        dirty.pop();
+        STATS_ADD(update_visits, 1);
+
+        size_t priority = compute_priority(id);
+        size_t thread_count = thread_counts[id];
+        thread_summary provided = summaries[provided_summary[id]];
+        summarize(id);
+
+        // the nodes it requests only see its priority and what it provides
+        bool propagate = priority != priorities[id] || !(summaries[provided_summary[id]] == provided);
+        if (priority != priorities[id] || thread_count != thread_counts[id])
+        {
+            changed.push_back(id);
+        }
+        priorities[id] = priority;
+        if (propagate)
+        {
+            for (uint32_t i = dependent_offsets[id]; i < dependent_offsets[id + 1]; i++)
+            {
+                mark(dependent_ids[i]);
+            }
+        }
+    }
+    return changed;
+}
+
+void frozen_graph::check_thread_counts() const
+{
+    if (!threads_valid)
+    {
+        count_threads();
+    }
+    // a macro may be shared by several connections, it has to cover the largest of them
+    auto is_macro = [](string_view threads)
+    {
+        return !threads.empty() && (isalpha(static_cast<unsigned char>(threads[0])) || threads[0] == '_');
+    };
+    unordered_map<string_view, size_t> macro_threads;
+    for (uint32_t id = 0; id < size(); id++)
+    {
+        if (types[id] == type_t::connection && is_macro(thread_macros[id]))
+        {
+            size_t &threads = macro_threads[thread_macros[id]];
+            threads = max(threads, thread_counts[id]);
+        }
+    }
+    for (uint32_t id = 0; id < size(); id++)
+    {
+        if (types[id] != type_t::connection || declared_threads[id] == UNKNOWN_THREADS)
+        {
+            continue;
+        }
+        size_t needed = is_macro(thread_macros[id]) ? macro_threads[thread_macros[id]] : thread_counts[id];
+        if (declared_threads[id] != needed)
+        {
+            diags->report(severity_t::warning, "thread-count-mismatch", identifiers[id], get_file(id), locations[id].line, "connection ", identifiers[id], " declares rpc(", thread_macros[id], ") = ", declared_threads[id], ", but ", needed, " threads are counted.");
+        }
+    }
+}
+
+vector<string_view> frozen_graph::task_identifiers(const thread_set &set) const
+{
+    vector<string_view> names;
+    set.for_each([&](size_t index)
+    {
+        names.push_back(identifiers[tasks[index]]);
+    });
+    return names;
+}
+
+void frozen_graph::fill_result(uint32_t id, bool trace, node_result &node) const
+{
+    node.identifier = identifiers[id];
+    node.name = names[id];
+    node.type = types[id];
+    node.protocol = protocols[id];
+    node.requestors.reserve(requestor_count(id));
+    for (uint32_t j = requestor_offsets[id]; j < requestor_offsets[id + 1]; j++)
+    {
+        node.requestors.push_back(identifiers[requestor_ids[j]]);
+    }
+    node.priority = priorities[id] + (node.type == type_t::task ? 0 : ladder_flag);
+    node.thread_count = thread_counts[id];
+    // the count is fixed for tasks, ipcp and unset connections, otherwise it comes from the threads reaching the node
+    node.traced = node.type == type_t::component || node.protocol == protocol_t::pip || node.protocol == protocol_t::propagation;
+    if (trace && node.traced)
+    {
+        const thread_summary &summary = summaries[requested_summary[id]];
+        node.threads = task_identifiers(summary.threads);
+        for (uint32_t handle : summary.fixed_threads_pool)
+        {
+            node.fixed_threads.push_back(task_identifiers(fixed_sets[handle]));
+        }
+        node.nested_thread = summary.require_nested_thread;
+    }
+}
+
+analysis_result frozen_graph::analyse(bool trace) const
+{
+    if (!priorities_valid)
+    {
+        propagate_priorities();
+    }
+    if (!threads_valid)
+    {
+        count_threads();
+    }
+    analysis_result result;
+    result.storage = storage;
+    result.nodes.resize(size());
+    for (uint32_t i = 0; i < size(); i++)
+    {
+        fill_result(sorted_ids[i], trace, result.nodes[i]);
+    }
+    return result;
+}
+
+analysis_result frozen_graph::analyse(vector<uint32_t> ids, bool trace) const
+{
+    if (!priorities_valid)
+    {
+        propagate_priorities();
+    }
+    if (!threads_valid)
+    {
+        count_threads();
+    }
+    sort(ids.begin(), ids.end(), [this](uint32_t lhs, uint32_t rhs)
+    {
+        return identifiers[lhs] < identifiers[rhs];
+    });
+    analysis_result result;
+    result.storage = storage;
+    result.nodes.resize(ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        fill_result(ids[i], trace, result.nodes[i]);
+    }
+    return result;
+}
@@ -0,0 +1,204 @@
+/*
+ *  frozen_graph.hpp
+ *  header file for the frozen_graph class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "node.hpp"
+#include "thread_set.hpp"
+#include "perfect_hash.hpp"
+#include "diagnostics.hpp"
+#include "analysis_result.hpp"
+#include "thread_pool.hpp"
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <iostream>
+
+const uint32_t NO_NODE = UINT32_MAX;
+
+// Threads contributed by a node to the nodes it requests.
+struct thread_summary
+{
+    // tasks whose threads run through the node
+    thread_set threads;
+    // fixed thread sets condensed by ipcp and pip connections, as handles into frozen_graph::fixed_sets, in visiting order
+    std::vector<uint32_t> fixed_threads_pool;
+    // whether an ipcp or pip connection below the node decided on a nested thread, and the last decision
+    bool nested_decided = false;
+    bool require_nested_thread = false;
+
+    bool operator==(const thread_summary &other) const
+    {
+        return threads == other.threads && fixed_threads_pool == other.fixed_threads_pool && nested_decided == other.nested_decided && require_nested_thread == other.require_nested_thread;
+    }
+};
+
+// Fixed thread sets, hash-consed into handles so identical sets reached through diamonds are stored once.
+struct fixed_set_table
+{
+    std::vector<thread_set> sets;
+    std::unordered_map<thread_set, uint32_t, thread_set_hash> handles;
+
+    const thread_set &operator[](uint32_t handle) const { return sets[handle]; }
+    // get the handle of a set, interning it if needed
+    uint32_t intern(const thread_set &set);
+    void clear()
+    {
+        sets.clear();
+        handles.clear();
+    }
+};
+
+// What a pass over the nodes writes besides the nodes themselves, one per job when the jobs run concurrently.
+struct pass_context
+{
+    fixed_set_table &fixed_sets;
+    diagnostics &diags;
+};
+
+// Read-only compressed sparse row form of a graph, built by graph::freeze once parsing finishes.
+// Nodes have dense ids in insertion order, attributes and adjacency are contiguous arrays indexed by id.
+class frozen_graph
+{
+private:
+    // propagated priority of each node by id, cached by propagate_priorities
+    mutable std::vector<size_t> priorities;
+    mutable bool priorities_valid = false;
+    // dense task index of each node by id, or NO_NODE for nodes that are not tasks
+    mutable std::vector<uint32_t> task_index;
+    mutable std::vector<uint32_t> tasks;
+    // the fixed thread sets the summaries refer to
+    mutable fixed_set_table fixed_sets;
+    // thread summaries, each node has one for what its requestors provide and one for what it provides, unless it passes the former on
+    mutable std::vector<thread_summary> summaries;
+    mutable std::vector<uint32_t> requested_summary;
+    mutable std::vector<uint32_t> provided_summary;
+    // number of threads of each node by id, cached by count_threads
+    mutable std::vector<size_t> thread_counts;
+    mutable bool threads_valid = false;
+    // position of each node by id in the topological order, built by update
+    mutable std::vector<uint32_t> topological_positions;
+    // node ids grouped by weakly connected region, in topological order within each region, built by build_regions
+    // regions share no nodes, so they are analysed independently, packed into jobs of region_order[job_offsets[j], job_offsets[j + 1])
+    mutable std::vector<uint32_t> region_order;
+    mutable std::vector<uint32_t> job_offsets;
+
+    // identifier lookup, built by build_index
+    perfect_hash index;
+
+    // split the graph into its weakly connected regions and pack them into jobs, once
+    void build_regions() const;
+    // visit the nodes of every job in order, the jobs concurrently on the pool if there is more than one
+    // each concurrent job has a context of its own, merged back in job order so the results do not depend on the schedule
+    template <typename visit_t>
+    void run_jobs(const visit_t &visit) const;
+    // compute the priority of a node from its requestors, which must be propagated already
+    size_t compute_priority(uint32_t id) const;
+    // summarize the threads a node requests and provides and count its threads, its requestors must be summarized already
+    // the node's summaries are overwritten, so nodes can be summarized again after their protocol changed
+    void summarize(uint32_t id, pass_context &context) const;
+    void summarize(uint32_t id) const;
+    // the kernels summarize dispatches to by kind, without branching on the kind again
+    // tasks, components and propagation connections, ipcp and pip connections, connections without a protocol
+    void summarize_task(uint32_t id) const;
+    void summarize_passing(uint32_t id, const fixed_set_table &sets) const;
+    void summarize_condensing(uint32_t id, fixed_set_table &sets) const;
+    void summarize_unset(uint32_t id, diagnostics &reported) const;
+    // accumulate what the requestors of a node provide into its requested summary, and return it
+    thread_summary &gather(uint32_t id) const;
+    // count the threads of a node from what its requestors provide
+    size_t count_requested(const thread_summary &requested, const fixed_set_table &sets) const;
+    // get the identifiers of the tasks in a thread set
+    std::vector<std::string_view> task_identifiers(const thread_set &set) const;
+    // fill in the result of a node from the computed priorities and thread counts
+    void fill_result(uint32_t id, bool trace, node_result &node) const;
+
+    friend class protocol_explorer;
+
+public:
+    // ladder flag
+    bool ladder_flag = false;
+    // where warnings and errors found by the analyses are reported, must be set before analysing
+    diagnostics *diags = nullptr;
+    // where the regions of the graph are analysed, in the calling thread if null
+    thread_pool *pool = nullptr;
+
+    // keeps the memory the identifiers and names view alive
+    std::shared_ptr<const void> storage;
+
+    // node attributes by id
+    // identifier of the node, "node.port" for connections
+    std::vector<std::string_view> identifiers;
+    // name of the component or connection
+    std::vector<std::string_view> names;
+    std::vector<type_t> types;
+    std::vector<protocol_t> protocols;
+    // priority assigned to the node itself, used when it has no requestors
+    std::vector<size_t> assigned_priorities;
+    // argument of rpc([Threads]) for connections, empty for other nodes
+    std::vector<std::string_view> thread_macros;
+    // value of the argument of rpc([Threads]) for connections, UNKNOWN_THREADS for other nodes or if it is not a constant
+    std::vector<size_t> declared_threads;
+    // timing of tasks and of the servers behind connections, UNKNOWN_TIME where the configuration does not set it
+    std::vector<node_timing> timings;
+    // where each node is declared, indexing files
+    std::vector<source_location> locations;
+    std::vector<std::string> files;
+
+    // adjacency, the requestors of node id are requestor_ids[requestor_offsets[id], requestor_offsets[id + 1]) in id order
+    std::vector<uint32_t> requestor_offsets;
+    std::vector<uint32_t> requestor_ids;
+    // the nodes requested by node id, in the same layout
+    std::vector<uint32_t> dependent_offsets;
+    std::vector<uint32_t> dependent_ids;
+
+    // node ids sorted by identifier, the order nodes are printed in
+    std::vector<uint32_t> sorted_ids;
+
+    frozen_graph() = default;
+    ~frozen_graph() = default;
+    frozen_graph(const frozen_graph &) = default;
+    frozen_graph &operator=(const frozen_graph &) = default;
+    frozen_graph(frozen_graph &&) = default;
+    frozen_graph &operator=(frozen_graph &&) = default;
+
+    // get the number of nodes
+    uint32_t size() const { return identifiers.size(); }
+    // get the number of requestors of a node
+    uint32_t requestor_count(uint32_t id) const { return requestor_offsets[id + 1] - requestor_offsets[id]; }
+    // build the sorted ids and the identifier index, once the identifiers are set
+    // return false if the identifiers are not distinct, which only a corrupt snapshot has
+    bool build_index();
+    // get the file a node is declared in, empty if unknown
+    std::string_view get_file(uint32_t id) const { return locations[id].file < files.size() ? std::string_view(files[locations[id].file]) : std::string_view(); }
+    // find a node by identifier, return NO_NODE if not found
+    uint32_t find(std::string_view identifier) const;
+    // get the node ids in topological order, requestors first
+    std::vector<uint32_t> topological_order() const;
+
+    // compute the propagated priority of every node once, in topological order
+    void propagate_priorities() const;
+    // get the propagated priority of a node, computing all priorities if needed
+    size_t get_priority(uint32_t id) const;
+    // compute the threads of every node once, bottom-up in topological order
+    void count_threads() const;
+    // get the number of threads of a node, computing all thread counts if needed
+    size_t get_thread_count(uint32_t id) const;
+    // recompute the priorities and thread counts after the assigned priorities or protocols of the edited nodes changed
+    // only the nodes downstream of the edited ones are visited, in topological order, and the walk stops wherever nothing changed
+    // return the ids of the nodes whose priority or thread count changed, every node if nothing was computed before
+    std::vector<uint32_t> update(const std::vector<uint32_t> &edited) const;
+    // warn about connections declaring a thread count other than the one counted, computing the thread counts if needed
+    // connections sharing a macro are checked against the largest count among them, the value the rewriter writes back
+    void check_thread_counts() const;
+    // get the priority, thread count and requestors of every node, computing them if needed
+    // trace fills in the threads behind each thread count
+    analysis_result analyse(bool trace) const;
+    // get the results of the given nodes only, sorted by identifier
+    analysis_result analyse(std::vector<uint32_t> ids, bool trace) const;
+};
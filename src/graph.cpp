@@ -5,91 +5,383 @@
  */
 
 #include "graph.hpp"
+#include "stats.hpp"
 #include <iostream>
-#include <list>
+#include <algorithm>
 
 using namespace std;
 
-bool graph::add_node(shared_ptr<node> node)
+uint32_t graph::add_node(type_t kind, string_view name, uint32_t identifier, string_view threads, size_t declared, source_location location)
 {
-    // apply ladder flag
-    node->ladder_flag = ladder_flag;
     // check if node already exists
-    if (nodes.find(node->get_identifier()) != nodes.end())
+    if (identifier >= nodes.size())
     {
-        return false;
+        nodes.resize(symbols->size(), NO_NODE);
+    }
+    if (nodes[identifier] != NO_NODE)
+    {
+        return nodes[identifier];
     }
     // add node to graph
-    nodes[node->get_identifier()] = node;
-    return true;
+    uint32_t id = size();
+    nodes[identifier] = id;
+    identifiers.push_back(symbols->str(identifier));
+    names.push_back(name);
+    kinds.push_back(kind);
+    priorities.push_back(DEFAULT_PRIORITY);
+    protocols.push_back(protocol_t::none);
+    thread_macros.push_back(threads);
+    declared_threads.push_back(declared);
+    timings.emplace_back();
+    locations.push_back(location);
+    requestors.emplace_back();
+    return id;
 }
 
-void print_path(shared_ptr<const node> node)
+void graph::dispatch(uint32_t dispatcher, uint32_t task)
 {
-    // recursively print the path from the source to the current node
-    if (node->last)
+    node_timing &timing = timings[task];
+    if (timing.period == UNKNOWN_TIME)
     {
-        print_path(node->last);
-        cout << " -> ";
+        timing.period = timings[dispatcher].period;
+    }
+    if (timing.release_time == UNKNOWN_TIME)
+    {
+        timing.release_time = timings[dispatcher].release_time;
     }
-    cout << node->name;
 }
 
-bool graph::add_edge(string src_name, string dest_name)
+uint32_t graph::add_component(string_view name, source_location location)
 {
-    // check if src and dest nodes exist
-    if (nodes.find(src_name) == nodes.end() || nodes.find(dest_name) == nodes.end())
+    uint32_t identifier = symbols->intern(name);
+    return add_node(type_t::component, symbols->str(identifier), identifier, string_view(), UNKNOWN_THREADS, location);
+}
+
+uint32_t graph::add_connection(string_view name, string_view comp_name, string_view comp_port, string_view threads, size_t declared, source_location location)
+{
+    uint32_t identifier = symbols->intern(comp_name, comp_port);
+    if (identifier < nodes.size() && nodes[identifier] != NO_NODE)
     {
-        return false;
+        return nodes[identifier];
     }
-    // check if there is a path from dest to src
-    // note: the direction of the edge is reversed, so we are checking if there is a path from src to dest in the graph through depth first search
-    shared_ptr<node> curr = nodes[src_name];
-    list<shared_ptr<node>> stack;
-    stack.push_front(curr);
+    string_view interned_name = symbols->str(symbols->intern(name));
+    string_view interned_threads = threads.empty() ? string_view() : symbols->str(symbols->intern(threads));
+    return add_node(type_t::connection, interned_name, identifier, interned_threads, declared, location);
+}
 
-    while (!stack.empty())
+void graph::set_protocol(uint32_t id, string_view protocol, source_location location)
+{
+    if (!parse_protocol(protocol, protocols[id]))
     {
-        curr = stack.front();
-        stack.pop_front();
+        diags->report(severity_t::error, "unknown-protocol", identifiers[id], get_file(location), location.line, "unknown protocol ", protocol, " for ", identifiers[id], ".");
+    }
+}
+
+void graph::add_requestor(uint32_t dest, uint32_t src)
+{
+    vector<uint32_t> &list = requestors[dest];
+    auto it = lower_bound(list.begin(), list.end(), src);
+    if (it == list.end() || *it != src)
+    {
+        list.insert(it, src);
+    }
+}
 
-        // if the current node is the source, return false
-        if (curr == nodes[dest_name])
+vector<uint32_t> graph::find_path(uint32_t src, uint32_t dest, uint32_t scope) const
+{
+    // depth first search through the requestors, remembering where each node was reached from
+    // note: the direction of the edge is reversed, so a path from src to dest means dest already requests src
+    if (reached_by.size() < size())
+    {
+        reached_by.resize(size(), 0);
+        reached_from.resize(size());
+    }
+    // a new search, the marks of earlier searches are stale
+    if (++search_count == 0)
+    {
+        fill(reached_by.begin(), reached_by.end(), 0);
+        search_count = 1;
+    }
+    size_t visits = 1;
+    reached_by[src] = search_count;
+    reached_from[src] = src;
+    search_stack.clear();
+    search_stack.push_back(src);
+
+    vector<uint32_t> path;
+    while (!search_stack.empty())
+    {
+        uint32_t curr = search_stack.back();
+        search_stack.pop_back();
+
+        // if the current node is the destination, walk back to the source
+        if (curr == dest)
         {
-            cout << "Error: cycle ";
-            print_path(curr);
-            // append the source node name again
-            cout << " -> " << nodes[src_name]->name << " detected" << endl;
-            return false;
+            for (uint32_t id = dest; id != src; id = reached_from[id])
+            {
+                path.push_back(id);
+            }
+            path.push_back(src);
+            reverse(path.begin(), path.end());
+            break;
+        }
+
+        // add the unvisited requestors of the current node to the stack
+        for (uint32_t requestor : requestors[curr])
+        {
+            if ((scope == NO_SCOPE || scc[requestor] == scope) && reached_by[requestor] != search_count)
+            {
+                reached_by[requestor] = search_count;
+                reached_from[requestor] = curr;
+                visits++;
+                search_stack.push_back(requestor);
+            }
         }
+    }
+    STATS_ADD(dfs_searches, 1);
+    STATS_ADD(dfs_visits, visits);
+    STATS_PEAK(dfs_visits, visits);
+    return path;
+}
+
+void graph::print_cycle(const vector<uint32_t> &path) const
+{
+    *output << "Error: cycle ";
+    for (uint32_t id : path)
+    {
+        *output << names[id] << " -> ";
+    }
+    // append the source node name again
+    *output << names[path.front()] << " detected" << endl;
+}
+
+bool graph::add_edge(string_view src_name, string_view dest_name)
+{
+    // check if src and dest nodes exist
+    uint32_t src = find(src_name);
+    uint32_t dest = find(dest_name);
+    if (src == NO_NODE || dest == NO_NODE)
+    {
+        return false;
+    }
 
-        // add the requestors of the current node to the stack
-        for (auto requestor : curr->requestors)
+    if (defer_cycle_check)
+    {
+        // insert unchecked, check_cycles removes the edges closing a cycle afterwards
+        unchecked_edges.emplace_back(src, dest);
+    }
+    else
+    {
+        // check if there is a path from dest to src
+        vector<uint32_t> path = find_path(src, dest, NO_SCOPE);
+        if (!path.empty())
         {
-            requestor->last = curr;
-            stack.push_front(requestor);
+            print_cycle(path);
+            return false;
         }
     }
 
     // add edge to graph
-    nodes[dest_name]->add_requestor(nodes[src_name]);
+    STATS_ADD(edges_added, 1);
+    add_requestor(dest, src);
     return true;
 }
 
-shared_ptr<node> graph::get_node(string identifier)
+vector<uint32_t> graph::strongly_connected_components() const
+{
+    // iterative tarjan's algorithm over the requestors
+    const uint32_t UNVISITED = UINT32_MAX;
+    uint32_t num_nodes = size();
+    vector<uint32_t> component(num_nodes, UNVISITED);
+    vector<uint32_t> index(num_nodes, UNVISITED);
+    vector<uint32_t> low(num_nodes);
+    vector<bool> on_stack(num_nodes, false);
+    vector<uint32_t> stack;
+    struct frame
+    {
+        uint32_t id;
+        // position of the next requestor to visit
+        uint32_t next;
+    };
+    vector<frame> call_stack;
+    uint32_t counter = 0;
+    uint32_t num_components = 0;
+
+    auto visit = [&](uint32_t id)
+    {
+        index[id] = low[id] = counter++;
+        stack.push_back(id);
+        on_stack[id] = true;
+        call_stack.push_back({id, 0});
+    };
+
+    for (uint32_t root = 0; root < num_nodes; root++)
+    {
+        if (index[root] != UNVISITED)
+        {
+            continue;
+        }
+        visit(root);
+        while (!call_stack.empty())
+        {
+            frame &top = call_stack.back();
+            uint32_t id = top.id;
+            if (top.next < requestors[id].size())
+            {
+                uint32_t requestor = requestors[id][top.next];
+                top.next++;
+                if (index[requestor] == UNVISITED)
+                {
+                    visit(requestor);
+                }
+                else if (on_stack[requestor])
+                {
+                    low[id] = min(low[id], index[requestor]);
+                }
+                continue;
+            }
+
+            // all requestors are visited, pop the component if this node is its root
+            call_stack.pop_back();
+            if (low[id] == index[id])
+            {
+                uint32_t member;
+                do
+                {
+                    member = stack.back();
+                    stack.pop_back();
+                    on_stack[member] = false;
+                    component[member] = num_components;
+                } while (member != id);
+                num_components++;
+            }
+            if (!call_stack.empty())
+            {
+                uint32_t parent = call_stack.back().id;
+                low[parent] = min(low[parent], low[id]);
+            }
+        }
+    }
+    return component;
+}
+
+size_t graph::check_cycles()
+{
+    if (unchecked_edges.empty())
+    {
+        return 0;
+    }
+
+    // an edge can only close a cycle if both of its ends are in the same strongly connected component
+    scc = strongly_connected_components();
+    vector<pair<uint32_t, uint32_t>> cyclic_edges;
+    for (auto &edge : unchecked_edges)
+    {
+        if (scc[edge.first] == scc[edge.second])
+        {
+            vector<uint32_t> &list = requestors[edge.second];
+            auto it = lower_bound(list.begin(), list.end(), edge.first);
+            if (it != list.end() && *it == edge.first)
+            {
+                list.erase(it);
+            }
+            cyclic_edges.push_back(edge);
+        }
+    }
+    unchecked_edges.clear();
+
+    // replay those edges in insertion order, searching only within their component,
+    // so exactly the edges rejected by the incremental check are rejected, with the same paths
+    size_t rejected = 0;
+    for (auto &edge : cyclic_edges)
+    {
+        vector<uint32_t> path = find_path(edge.first, edge.second, scc[edge.first]);
+        if (!path.empty())
+        {
+            print_cycle(path);
+            rejected++;
+            continue;
+        }
+        add_requestor(edge.second, edge.first);
+    }
+    scc.clear();
+    return rejected;
+}
+
+uint32_t graph::find(string_view identifier) const
 {
     // check if node exists
-    if (nodes.find(identifier) == nodes.end())
+    uint32_t symbol = symbols->find(identifier);
+    if (symbol == symbol_table::NOT_FOUND || symbol >= nodes.size())
+    {
+        return NO_NODE;
+    }
+    return nodes[symbol];
+}
+
+uint32_t graph::find(string_view comp_name, string_view comp_port) const
+{
+    uint32_t symbol = symbols->find(comp_name, comp_port);
+    if (symbol == symbol_table::NOT_FOUND || symbol >= nodes.size())
     {
-        return nullptr;
+        return NO_NODE;
     }
-    return nodes[identifier];
+    return nodes[symbol];
 }
 
-void graph::print(ostream &os) const
+frozen_graph graph::freeze() const
 {
-    for (auto node : nodes)
+    frozen_graph frozen;
+    uint32_t num_nodes = size();
+    frozen.ladder_flag = ladder_flag;
+    frozen.diags = diags;
+    frozen.files = files;
+    // the identifiers and names view the symbol table
+    frozen.storage = symbols;
+    frozen.identifiers = identifiers;
+    frozen.names = names;
+    frozen.protocols = protocols;
+    frozen.assigned_priorities = priorities;
+    frozen.thread_macros = thread_macros;
+    frozen.declared_threads = declared_threads;
+    frozen.timings = timings;
+    frozen.locations = locations;
+    frozen.types.resize(num_nodes);
+    frozen.requestor_offsets.resize(num_nodes + 1);
+    frozen.requestor_offsets[0] = 0;
+
+    // a component without requestors is a task, copy the requestors, which are already in id order
+    vector<uint32_t> dependent_counts(num_nodes + 1, 0);
+    for (uint32_t id = 0; id < num_nodes; id++)
+    {
+        frozen.types[id] = kinds[id] == type_t::connection ? type_t::connection : requestors[id].empty() ? type_t::task : type_t::component;
+        frozen.requestor_offsets[id + 1] = frozen.requestor_offsets[id] + requestors[id].size();
+    }
+    frozen.requestor_ids.resize(frozen.requestor_offsets[num_nodes]);
+    for (uint32_t id = 0; id < num_nodes; id++)
+    {
+        copy(requestors[id].begin(), requestors[id].end(), frozen.requestor_ids.begin() + frozen.requestor_offsets[id]);
+        for (uint32_t requestor : requestors[id])
+        {
+            dependent_counts[requestor + 1]++;
+        }
+    }
+
+    // transpose the requestors into the dependents
+    for (uint32_t id = 0; id < num_nodes; id++)
     {
-        node.second->print(os);
+        dependent_counts[id + 1] += dependent_counts[id];
     }
-}
\ No newline at end of file
+    frozen.dependent_offsets = dependent_counts;
+    frozen.dependent_ids.resize(frozen.requestor_ids.size());
+    for (uint32_t id = 0; id < num_nodes; id++)
+    {
+        for (uint32_t i = frozen.requestor_offsets[id]; i < frozen.requestor_offsets[id + 1]; i++)
+        {
+            frozen.dependent_ids[dependent_counts[frozen.requestor_ids[i]]++] = id;
+        }
+    }
+
+    frozen.build_index();
+    return frozen;
+}
@@ -7,26 +7,116 @@
 #pragma once
 
 #include "node.hpp"
-#include <map>
+#include "frozen_graph.hpp"
+#include "diagnostics.hpp"
+#include "symbol_table.hpp"
+#include <vector>
+#include <utility>
+#include <memory>
+#include <cstdint>
+#include <iostream>
 
+// Graph of components and connections while it is built, with cycles rejected as edges are added.
+// Nodes are values held in arrays indexed by their dense id, in insertion order: there is no object per node,
+// and every traversal reads the arrays directly. A component is told apart from a task once the graph is frozen.
 class graph
 {
 private:
-    // maps node identifiers to nodes, "node.port" for connections
-    std::map<std::string, std::shared_ptr<node>> nodes;
+    // node names and identifiers, "node.port" for connections, shared with the frozen graph
+    std::shared_ptr<symbol_table> symbols = std::make_shared<symbol_table>();
+    // node ids indexed by the symbol of their identifier, NO_NODE for symbols that are not identifiers
+    std::vector<uint32_t> nodes;
+
+    // node attributes by id
+    // identifier of the node, "node.port" for connections
+    std::vector<std::string_view> identifiers;
+    // name of the component or connection
+    std::vector<std::string_view> names;
+    // component or connection
+    std::vector<type_t> kinds;
+    // priority assigned to components, DEFAULT_PRIORITY if none
+    std::vector<size_t> priorities;
+    // protocol of connections, none for components
+    std::vector<protocol_t> protocols;
+    // argument of rpc([Threads]) for connections, empty for components
+    std::vector<std::string_view> thread_macros;
+    // value of the argument of rpc([Threads]) for connections, UNKNOWN_THREADS if it has none
+    std::vector<size_t> declared_threads;
+    // timing of tasks and of the servers behind connections, as set in the configuration
+    std::vector<node_timing> timings;
+    // where each node is declared
+    std::vector<source_location> locations;
+    // requestors of each node, sorted by id so they are visited in insertion order on every run
+    std::vector<std::vector<uint32_t>> requestors;
+
+    // edges inserted while the cycle check is deferred, as (src, dest) ids in insertion order
+    std::vector<std::pair<uint32_t, uint32_t>> unchecked_edges;
+    // strongly connected component of each node by id, only set while check_cycles runs
+    std::vector<uint32_t> scc;
+    static constexpr uint32_t NO_SCOPE = UINT32_MAX;
+    // scratch of find_path, reused across searches: the node each node was reached from, and the search that reached it
+    mutable std::vector<uint32_t> reached_from;
+    mutable std::vector<uint32_t> reached_by;
+    mutable uint32_t search_count = 0;
+    mutable std::vector<uint32_t> search_stack;
+
+    // add a node with its identifier interned, return its id, or the id of the node that already has the identifier
+    uint32_t add_node(type_t kind, std::string_view name, uint32_t identifier, std::string_view threads, size_t declared, source_location location);
+    // add src to the requestors of dest, unless it already is one
+    void add_requestor(uint32_t dest, uint32_t src);
+    // find a path from src to dest through the requestors, staying within the strongly connected component scope unless it is NO_SCOPE
+    // return the ids on the path from src to dest, or an empty path if there is none
+    std::vector<uint32_t> find_path(uint32_t src, uint32_t dest, uint32_t scope) const;
+    // print the cycle closed by an edge, given the path from its source to its destination
+    void print_cycle(const std::vector<uint32_t> &path) const;
+    // get the strongly connected component of each node by id
+    std::vector<uint32_t> strongly_connected_components() const;
 public:
     // ladder flag
     bool ladder_flag = false;
-    
+    // insert edges without checking for cycles until check_cycles is called
+    bool defer_cycle_check = false;
+    // where cycles are reported, alongside the printed graph
+    std::ostream *output = &std::cout;
+    // where errors in the statements are reported, must be set before building
+    diagnostics *diags = nullptr;
+    // files the nodes are declared in, indexed by their locations
+    std::vector<std::string> files;
+
     graph() = default;
     ~graph() = default;
 
-    // add a node to the graph, return true if successful
-    bool add_node(std::shared_ptr<node> node);
+    // get the number of nodes
+    uint32_t size() const { return identifiers.size(); }
+    // add a component, return its id, or the id of the node already named so, which is kept
+    uint32_t add_component(std::string_view name, source_location location);
+    // add the connection of a port, identified by "comp_name.comp_port", return its id, or the id of the node already identified so, which is kept
+    // threads is the argument of rpc([Threads]), if known, and declared its value, UNKNOWN_THREADS if it has none
+    uint32_t add_connection(std::string_view name, std::string_view comp_name, std::string_view comp_port, std::string_view threads, size_t declared, source_location location);
     // add an edge to the graph, return true if successful
-    bool add_edge(std::string src_name, std::string dest_name);
-    // get a node from the graph
-    std::shared_ptr<node> get_node(std::string identifier);
-    // print the graph
-    void print(std::ostream &os) const;
-};
\ No newline at end of file
+    // if the cycle check is deferred, the edge may still be removed by check_cycles
+    bool add_edge(std::string_view src_name, std::string_view dest_name);
+    // check all edges inserted while the cycle check was deferred in one pass over the strongly connected components
+    // every edge closing a cycle is reported with its path and removed, return the number of removed edges
+    size_t check_cycles();
+    // find a node by identifier, return NO_NODE if not found
+    uint32_t find(std::string_view identifier) const;
+    // find the connection of a port, return NO_NODE if not found
+    uint32_t find(std::string_view comp_name, std::string_view comp_port) const;
+    // get the identifier of a node, interned by the graph's symbol table
+    std::string_view get_identifier(uint32_t id) const { return identifiers[id]; }
+    // get whether a node is a component or a connection
+    type_t get_kind(uint32_t id) const { return kinds[id]; }
+    // set the priority of a component
+    void set_priority(uint32_t id, size_t priority) { priorities[id] = priority; }
+    // set the protocol of a connection as written in the configuration, report it and keep the protocol if it is unknown
+    void set_protocol(uint32_t id, std::string_view protocol, source_location location);
+    // set a time of a task or of the server behind a connection
+    void set_timing(uint32_t id, timing_t kind, size_t time) { timings[id].set(kind, time); }
+    // release a task by a dispatcher, which gives it the period and release time it does not set itself
+    void dispatch(uint32_t dispatcher, uint32_t task);
+    // get the file of a location, empty if unknown
+    std::string_view get_file(source_location location) const { return location.file < files.size() ? std::string_view(files[location.file]) : std::string_view(); }
+    // freeze the graph into its compressed sparse row form for analysis
+    frozen_graph freeze() const;
+};
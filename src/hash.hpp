@@ -0,0 +1,26 @@
+/*
+ *  hash.hpp
+ *  header file for the byte hash function
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+
+// Seeded 64-bit hash of a byte string, fnv-1a followed by a murmur3 finalizer to spread the low bits.
+inline uint64_t hash_bytes(std::string_view bytes, uint64_t seed = 0)
+{
+    uint64_t hash = 14695981039346656037ull ^ (seed * 0x9e3779b97f4a7c15ull);
+    for (char c : bytes)
+    {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
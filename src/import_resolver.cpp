@@ -0,0 +1,293 @@
+/*
+ *  import_resolver.cpp
+ *  source file for the import_resolver class
+ *  author: jordan sun
+ */
+
+#include "import_resolver.hpp"
+#include "hash.hpp"
+#include "stats.hpp"
+#include <iostream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+
+using namespace std;
+
+bool source_cache::find_or_add(uint64_t hash, const shared_future<shared_ptr<const parsed_source>> &scanning, shared_future<shared_ptr<const parsed_source>> &cached)
+{
+    lock_guard<mutex> lock(cache_mutex);
+    auto it = sources.find(hash);
+    if (it != sources.end())
+    {
+        cached = it->second;
+        return false;
+    }
+    sources.emplace(hash, scanning);
+    return true;
+}
+
+import_resolver::import_resolver(vector<string> include_paths, bool mmap_flag, size_t chunks, thread_pool &pool, source_cache &shared_sources) : include_paths(move(include_paths)), mmap_flag(mmap_flag), chunks(chunks), pool(pool), sources(mmap_flag ? mapped_sources : shared_sources)
+{
+}
+
+import_resolver::~import_resolver()
+{
+    // loading a file may start loading its imports, so wait until no new files appear
+    size_t waited = 0;
+    while (true)
+    {
+        vector<task_future<shared_ptr<const source_file>>> loading;
+        {
+            lock_guard<mutex> lock(cache_mutex);
+            if (files.size() == waited)
+            {
+                break;
+            }
+            waited = files.size();
+            for (auto &file : files)
+            {
+                loading.push_back(file.second);
+            }
+        }
+        for (auto &file : loading)
+        {
+            pool.wait(file);
+        }
+    }
+}
+
+task_future<shared_ptr<const source_file>> import_resolver::load(const string &path)
+{
+    lock_guard<mutex> lock(cache_mutex);
+    auto it = files.find(path);
+    if (it != files.end())
+    {
+        return it->second;
+    }
+    task_future<shared_ptr<const source_file>> file = pool.submit([this, path]()
+    {
+        return read(path);
+    });
+    files.emplace(path, file);
+    return file;
+}
+
+shared_ptr<const source_file> import_resolver::read(const string &path)
+{
+    shared_ptr<source_file> file = make_shared<source_file>();
+    file->path = path;
+
+    unique_ptr<parsed_source> source = make_unique<parsed_source>();
+    if (mmap_flag)
+    {
+        if (!source->mapped.open(path))
+        {
+            return file;
+        }
+    }
+    else
+    {
+        ifstream input_file(path);
+        if (!input_file.is_open())
+        {
+            return file;
+        }
+        ostringstream buffer_stream;
+        buffer_stream << input_file.rdbuf();
+        source->buffer = buffer_stream.str();
+    }
+    resolve_imports(*file, move(source));
+    return file;
+}
+
+void import_resolver::resolve_imports(source_file &file, unique_ptr<parsed_source> source)
+{
+    file.source = scan(move(source));
+
+    // resolve the imports and start loading them before the file is expanded
+    string directory = filesystem::path(file.path).parent_path().string();
+    for (const import_statement &import : file.source->stmts.imports)
+    {
+        file.imports.push_back(resolve(import, directory, file.missing));
+        if (!file.imports.back().empty())
+        {
+            load(file.imports.back());
+        }
+    }
+}
+
+shared_ptr<const parsed_source> import_resolver::scan(unique_ptr<parsed_source> source)
+{
+    source->hash = hash_bytes(source->contents());
+
+    promise<shared_ptr<const parsed_source>> scanned;
+    shared_future<shared_ptr<const parsed_source>> cached;
+    bool owner = sources.find_or_add(source->hash, scanned.get_future().share(), cached);
+    if (!owner)
+    {
+        // the owner is already running and waits on no other task until it has scanned, so it finishes without this thread
+        cached.wait();
+        shared_ptr<const parsed_source> other = cached.get();
+        if (other->contents() == source->contents())
+        {
+            return other;
+        }
+        // a hash collision, scan the contents without caching them
+    }
+
+    string_view contents = source->contents();
+    if (chunks == 1)
+    {
+        scan_statements(contents.data(), contents.data() + contents.size(), source->stmts);
+    }
+    else
+    {
+        // large files are split further, the chunks are scanned on the pool alongside the other files
+        scan_statements(contents.data(), contents.data() + contents.size(), source->stmts, pool, chunks);
+    }
+    scanned_count++;
+    STATS_ADD(files_scanned, 1);
+    shared_ptr<const parsed_source> result = move(source);
+    if (owner)
+    {
+        scanned.set_value(result);
+    }
+    return result;
+}
+
+string import_resolver::resolve(const import_statement &import, const string &directory, vector<string> &missing) const
+{
+    vector<filesystem::path> candidates;
+    if (!import.system)
+    {
+        candidates.push_back(filesystem::path(directory) / import.path);
+    }
+    for (const string &include_path : include_paths)
+    {
+        candidates.push_back(filesystem::path(include_path) / import.path);
+    }
+    for (const filesystem::path &candidate : candidates)
+    {
+        error_code error;
+        if (filesystem::is_regular_file(candidate, error))
+        {
+            filesystem::path canonical = filesystem::canonical(candidate, error);
+            if (!error)
+            {
+                return canonical.string();
+            }
+        }
+        missing.push_back(filesystem::absolute(candidate, error).lexically_normal().string());
+    }
+    return "";
+}
+
+void import_resolver::add_dependency(const string &path, bool exists, uint64_t hash)
+{
+    if (dependency_paths.insert(path).second)
+    {
+        dependencies.push_back({path, exists, hash});
+    }
+}
+
+bool import_resolver::expand(const string &path, statements &stmts, logger &log)
+{
+    error_code error;
+    string canonical = filesystem::canonical(path, error).string();
+    if (error)
+    {
+        return false;
+    }
+    task_future<shared_ptr<const source_file>> loading = load(canonical);
+    pool.wait(loading);
+    shared_ptr<const source_file> file = loading.get();
+    if (file->source == nullptr)
+    {
+        return false;
+    }
+    vector<string> stack;
+    expand(*file, stmts, stack, log);
+    return true;
+}
+
+void import_resolver::expand(const string &name, string_view contents, statements &stmts, logger &log)
+{
+    source_file file;
+    file.path = name;
+    unique_ptr<parsed_source> source = make_unique<parsed_source>();
+    source->buffer = contents;
+    resolve_imports(file, move(source));
+    vector<string> stack;
+    expand(file, stmts, stack, log);
+}
+
+void import_resolver::expand(const source_file &file, statements &stmts, vector<string> &stack, logger &log)
+{
+    expanded_files.insert(file.path);
+    expanded_sources.push_back(file.source);
+    stack.push_back(file.path);
+    add_dependency(file.path, true, file.source->hash);
+    for (const string &path : file.missing)
+    {
+        add_dependency(path, false, 0);
+    }
+    LOG_INFO(log, "Expanding ", file.path);
+    uint32_t file_index = stmts.files.size();
+    stmts.files.push_back(file.path);
+
+    const statements &from = file.source->stmts;
+    statement_counts position;
+    for (size_t i = 0; i < from.imports.size(); i++)
+    {
+        // the statements before the import, then the imported ones in its place
+        const import_statement &import = from.imports[i];
+        append_statements(from, position, import.position, stmts, file_index);
+        position = import.position;
+
+        const string &target = file.imports[i];
+        if (target.empty())
+        {
+            // system imports name the camkes headers, which are only expected to resolve when include paths are given
+            if (import.system && include_paths.empty())
+            {
+                LOG_INFO(log, "Skipping system import ", import.path);
+                continue;
+            }
+            // reported once per import statement, the same path may be imported from several files
+            string subject = file.path + ':' + to_string(import.location.line);
+            diags->report(severity_t::warning, "unresolved-import", subject, file.path, import.location.line, "cannot resolve import ", import.path, ".");
+            continue;
+        }
+        auto cycle = find(stack.begin(), stack.end(), target);
+        if (cycle != stack.end())
+        {
+            string path;
+            for (auto it = cycle; it != stack.end(); it++)
+            {
+                path += *it + " -> ";
+            }
+            path += target;
+            diags->report(severity_t::error, "import-cycle", path, file.path, import.location.line, "import cycle ", path, " detected.");
+            continue;
+        }
+        if (expanded_files.count(target) > 0)
+        {
+            // already expanded at an earlier import
+            continue;
+        }
+        task_future<shared_ptr<const source_file>> loading = load(target);
+        pool.wait(loading);
+        shared_ptr<const source_file> imported = loading.get();
+        if (imported->source == nullptr)
+        {
+            diags->report(severity_t::warning, "unreadable-import", target, file.path, import.location.line, "failed to read import ", target, ".");
+            add_dependency(target, false, 0);
+            continue;
+        }
+        expand(*imported, stmts, stack, log);
+    }
+    append_statements(from, position, from.counts(), stmts, file_index);
+
+    stack.pop_back();
+}
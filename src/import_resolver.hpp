@@ -0,0 +1,140 @@
+/*
+ *  import_resolver.hpp
+ *  header file for the import_resolver class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "parser.hpp"
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+
+// Contents of a file and the statements scanned from it, shared by every file with the same contents.
+struct parsed_source
+{
+    uint64_t hash;
+    // the statements are views into the contents, which are either mapped or read in full
+    mapped_file mapped;
+    std::string buffer;
+    statements stmts;
+
+    std::string_view contents() const { return mapped.size() > 0 ? std::string_view(mapped.data(), mapped.size()) : std::string_view(buffer); }
+};
+
+// Scanned contents by content hash, the first file with a hash scans it and later ones wait for it.
+// A camkes_parser shares one cache between its parses, so contents it has seen are not scanned again,
+// and keeps every distinct contents it scanned for its lifetime. Files are still read on every parse, so edits are seen.
+class source_cache
+{
+private:
+    std::mutex cache_mutex;
+    std::unordered_map<uint64_t, std::shared_future<std::shared_ptr<const parsed_source>>> sources;
+
+public:
+    // get the scanned contents with the hash into cached, or add the scan about to start if there are none
+    // return true if the scan was added, its owner must then set it
+    bool find_or_add(uint64_t hash, const std::shared_future<std::shared_ptr<const parsed_source>> &scanning, std::shared_future<std::shared_ptr<const parsed_source>> &cached);
+};
+
+// A file the expanded statements depend on, or a path that must stay missing for the imports to resolve the same way.
+struct file_dependency
+{
+    std::string path;
+    bool exists;
+    // content hash of the file if it exists
+    uint64_t hash;
+};
+
+// A file reached through the imports, with its imports resolved relative to where it is.
+struct source_file
+{
+    // canonical path of the file
+    std::string path;
+    // null if the file could not be read
+    std::shared_ptr<const parsed_source> source;
+    // canonical path of each import in statement order, empty if it could not be resolved
+    std::vector<std::string> imports;
+    // paths searched for the imports that did not exist
+    std::vector<std::string> missing;
+};
+
+// Phase 0, expands the imports of a configuration recursively and in place.
+// Files are read and scanned on a thread pool as soon as they are reached, expansion then walks them in order,
+// waiting through the pool so it can run from within a task of the same pool.
+// Each file is expanded once, at its first import, and files with the same contents are scanned once per source cache.
+class import_resolver
+{
+private:
+    std::vector<std::string> include_paths;
+    bool mmap_flag;
+    // chunks each file is scanned in, one per pool thread for 0
+    size_t chunks;
+    // files are read and scanned on the pool, which may be shared with other work
+    thread_pool &pool;
+
+    std::mutex cache_mutex;
+    // files by canonical path, each loaded once
+    std::unordered_map<std::string, task_future<std::shared_ptr<const source_file>>> files;
+    // mapped files can change under a mapping kept past this resolver, so their contents are only cached while it lives
+    source_cache mapped_sources;
+    // scanned contents, shared with other resolvers unless the files are mapped
+    source_cache &sources;
+    // number of files scanned, as opposed to found in the cache
+    std::atomic<size_t> scanned_count{0};
+
+    // the parsed sources the expanded statements view, kept alive for the resolver's lifetime
+    std::vector<std::shared_ptr<const parsed_source>> expanded_sources;
+    std::unordered_set<std::string> expanded_files;
+    std::vector<file_dependency> dependencies;
+    std::unordered_set<std::string> dependency_paths;
+
+    // start loading a file unless it already is, return its future
+    task_future<std::shared_ptr<const source_file>> load(const std::string &path);
+    // read and scan a file, run on the pool
+    std::shared_ptr<const source_file> read(const std::string &path);
+    // find the scanned contents in the cache, or scan and add them
+    std::shared_ptr<const parsed_source> scan(std::unique_ptr<parsed_source> source);
+    // scan the contents of a file, then resolve its imports and start loading them
+    void resolve_imports(source_file &file, std::unique_ptr<parsed_source> source);
+    // get the canonical path of an import, empty if not found, adding the paths searched before to missing
+    std::string resolve(const import_statement &import, const std::string &directory, std::vector<std::string> &missing) const;
+    // record a dependency of the expanded statements, once per path
+    void add_dependency(const std::string &path, bool exists, uint64_t hash);
+    // append the statements of a file, expanding its imports in place
+    void expand(const source_file &file, statements &stmts, std::vector<std::string> &stack, logger &log);
+
+public:
+    // where unresolved imports and import cycles are reported, must be set before expanding
+    diagnostics *diags = nullptr;
+
+    // include paths are searched in order, after the importing file's directory for quoted imports
+    // files are scanned in chunks on the pool, see scan_statements, and their scanned contents are shared through shared_sources
+    import_resolver(std::vector<std::string> include_paths, bool mmap_flag, size_t chunks, thread_pool &pool, source_cache &shared_sources);
+    // wait for the files still being loaded, which use the resolver
+    ~import_resolver();
+
+    // expand the file and its imports into stmts, return false if the file cannot be read
+    // the statements view buffers owned by the resolver, which must outlive them
+    bool expand(const std::string &path, statements &stmts, logger &log);
+    // expand configuration contents held in memory, named as if they were read from the path name
+    // quoted imports are searched next to that path
+    void expand(const std::string &name, std::string_view contents, statements &stmts, logger &log);
+
+    // get the number of files scanned, files with the same contents are scanned once
+    size_t get_scanned_count() const { return scanned_count; }
+    // get the files the expanded statements depend on, in expansion order
+    const std::vector<file_dependency> &get_dependencies() const { return dependencies; }
+};
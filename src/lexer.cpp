@@ -0,0 +1,153 @@
+/*
+ *  lexer.cpp
+ *  source file for the lexer class
+ *  author: jordan sun
+ */
+
+#include "lexer.hpp"
+
+using namespace std;
+
+static bool is_identifier_start(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool is_identifier_char(char c)
+{
+    return is_identifier_start(c) || (c >= '0' && c <= '9');
+}
+
+static bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+lexer::lexer(const char *begin, const char *end)
+    : cursor(begin), end(end)
+{
+}
+
+void lexer::skip()
+{
+    while (cursor < end)
+    {
+        char c = *cursor;
+        if (c == '\n')
+        {
+            line++;
+            line_start = true;
+            cursor++;
+        }
+        else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v')
+        {
+            cursor++;
+        }
+        else if (c == '/' && cursor + 1 < end && cursor[1] == '/')
+        {
+            // line comment, stop at the newline so it is counted above
+            while (cursor < end && *cursor != '\n')
+            {
+                cursor++;
+            }
+        }
+        else if (c == '/' && cursor + 1 < end && cursor[1] == '*')
+        {
+            // block comment
+            cursor += 2;
+            while (cursor < end && !(*cursor == '*' && cursor + 1 < end && cursor[1] == '/'))
+            {
+                if (*cursor == '\n')
+                {
+                    line++;
+                }
+                cursor++;
+            }
+            cursor = cursor < end ? cursor + 2 : end;
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+token lexer::next()
+{
+    skip();
+
+    token tok;
+    tok.line = line;
+    if (cursor >= end)
+    {
+        tok.type = token_t::end;
+        return tok;
+    }
+
+    const char *start = cursor;
+    char c = *cursor;
+
+    if (c == '#' && line_start)
+    {
+        // preprocessor directive, runs to the end of the line including continuations
+        while (cursor < end && *cursor != '\n')
+        {
+            if (*cursor == '\\' && cursor + 1 < end && cursor[1] == '\n')
+            {
+                line++;
+                cursor++;
+            }
+            cursor++;
+        }
+        tok.type = token_t::directive;
+        tok.text = string_view(start, cursor - start);
+        return tok;
+    }
+
+    line_start = false;
+
+    if (is_identifier_start(c))
+    {
+        while (cursor < end && is_identifier_char(*cursor))
+        {
+            cursor++;
+        }
+        tok.type = token_t::identifier;
+        tok.text = string_view(start, cursor - start);
+    }
+    else if (is_digit(c))
+    {
+        // numbers absorb suffixes and hex digits, e.g. 0x1f or 10u
+        while (cursor < end && is_identifier_char(*cursor))
+        {
+            cursor++;
+        }
+        tok.type = token_t::number;
+        tok.text = string_view(start, cursor - start);
+    }
+    else if (c == '"')
+    {
+        cursor++;
+        while (cursor < end && *cursor != '"' && *cursor != '\n')
+        {
+            if (*cursor == '\\' && cursor + 1 < end)
+            {
+                cursor++;
+            }
+            cursor++;
+        }
+        tok.type = token_t::string;
+        tok.text = string_view(start + 1, cursor - start - 1);
+        if (cursor < end && *cursor == '"')
+        {
+            cursor++;
+        }
+    }
+    else
+    {
+        cursor++;
+        tok.type = token_t::punctuation;
+        tok.text = string_view(start, cursor - start);
+    }
+    return tok;
+}
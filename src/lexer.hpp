@@ -0,0 +1,54 @@
+/*
+ *  lexer.hpp
+ *  header file for the lexer class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <string_view>
+#include <cstddef>
+
+enum class token_t
+{
+    end,
+    identifier,
+    number,
+    string,
+    punctuation,
+    directive
+};
+
+struct token
+{
+    token_t type = token_t::end;
+    // view of the token in the input buffer, string literals exclude the quotes
+    std::string_view text;
+    // line the token starts on, 1-based
+    size_t line = 0;
+};
+
+// Hand-written tokenizer over an in-memory buffer.
+// Whitespace and comments are skipped, preprocessor lines are returned as a single directive token.
+// Tokens are views into the buffer, which must outlive them.
+class lexer
+{
+private:
+    const char *cursor;
+    const char *end;
+    size_t line = 1;
+    // true if only whitespace has been seen since the last newline
+    bool line_start = true;
+
+    // skip whitespace and comments
+    void skip();
+
+public:
+    lexer(const char *begin, const char *end);
+
+    // Get the next token, returns a token of type end when the buffer is exhausted.
+    token next();
+
+    // get the current line, 1-based
+    size_t get_line() const { return line; }
+};
@@ -0,0 +1,133 @@
+/*
+ *  logger.cpp
+ *  source file for the logger class
+ *  author: jordan sun
+ */
+
+#include "logger.hpp"
+#include <chrono>
+
+using namespace std;
+
+logger::~logger()
+{
+    close();
+}
+
+bool logger::open(const string &file_name)
+{
+    close();
+    file.open(file_name);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    if (slots == nullptr)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        slots = make_unique<slot[]>(size);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++)
+        {
+            slots[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+    stopping.store(false, memory_order_relaxed);
+    writer = thread(&logger::write_messages, this);
+    return true;
+}
+
+void logger::close()
+{
+    if (!writer.joinable())
+    {
+        return;
+    }
+    stopping.store(true, memory_order_release);
+    writer.join();
+    file.close();
+}
+
+void logger::push(string &message)
+{
+    // claim a position whose slot the writer has released (bounded mpmc queue, one consumer)
+    size_t position = enqueue_position.load(memory_order_relaxed);
+    slot *target;
+    while (true)
+    {
+        target = &slots[position & mask];
+        size_t sequence = target->sequence.load(memory_order_acquire);
+        if (sequence == position)
+        {
+            if (enqueue_position.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (sequence < position)
+        {
+            // the ring is full, wait for the writer to catch up
+            this_thread::yield();
+            position = enqueue_position.load(memory_order_relaxed);
+        }
+        else
+        {
+            // another producer claimed the position first
+            position = enqueue_position.load(memory_order_relaxed);
+        }
+    }
+    // swap rather than copy, the producer keeps the capacity of the slot's previous message
+    target->message.swap(message);
+    target->sequence.store(position + 1, memory_order_release);
+}
+
+size_t logger::drain()
+{
+    size_t count = 0;
+    while (true)
+    {
+        slot &source = slots[dequeue_position & mask];
+        if (source.sequence.load(memory_order_acquire) != dequeue_position + 1)
+        {
+            return count;
+        }
+        file.write(source.message.data(), source.message.size());
+        source.message.clear();
+        source.sequence.store(dequeue_position + mask + 1, memory_order_release);
+        dequeue_position++;
+        count++;
+    }
+}
+
+void logger::write_messages()
+{
+    auto idle = chrono::microseconds(50);
+    bool dirty = false;
+    while (true)
+    {
+        // read the flag first, so every message pushed before close is drained below
+        bool stop = stopping.load(memory_order_acquire);
+        if (drain() > 0)
+        {
+            dirty = true;
+            idle = chrono::microseconds(50);
+            continue;
+        }
+        if (dirty)
+        {
+            file.flush();
+            dirty = false;
+        }
+        if (stop)
+        {
+            return;
+        }
+        // back off while the log is quiet
+        this_thread::sleep_for(idle);
+        idle = min(idle * 2, chrono::microseconds(2000));
+    }
+}
@@ -0,0 +1,113 @@
+/*
+ *  logger.hpp
+ *  header file for the logger class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+enum class log_level
+{
+    debug,
+    info,
+    warning,
+    error
+};
+
+// the least severe level compiled in, as the index of the log_level, set by the PARSER_LOG_LEVEL cmake option
+#ifndef PARSER_LOG_LEVEL
+#define PARSER_LOG_LEVEL 0
+#endif
+
+// Levelled log file written by a background thread.
+// Producers format each message into a thread local buffer and hand it over through a bounded lock-free ring,
+// so logging from the parsing loops costs no flush and no lock; the writer flushes once the ring runs dry.
+class logger
+{
+private:
+    struct slot
+    {
+        // the position the slot is next writable at, or one past the position it holds a message for
+        std::atomic<size_t> sequence;
+        std::string message;
+    };
+
+    std::ofstream file;
+    // the ring, allocated when the log file is first opened
+    std::unique_ptr<slot[]> slots;
+    size_t capacity;
+    size_t mask = 0;
+    // next position to write, claimed by producers
+    alignas(64) std::atomic<size_t> enqueue_position{0};
+    // next position to read, owned by the writer thread
+    alignas(64) size_t dequeue_position = 0;
+    std::atomic<bool> stopping{false};
+    std::thread writer;
+
+    // hand the formatted message over to the writer, waiting while the ring is full
+    void push(std::string &message);
+    // write every message in the ring, return the number written
+    size_t drain();
+    void write_messages();
+
+    static void append(std::string &message, std::string_view text) { message.append(text); }
+    static void append(std::string &message, char c) { message.push_back(c); }
+    template <typename integer_t, typename = std::enable_if_t<std::is_integral_v<integer_t>>>
+    static void append(std::string &message, integer_t value)
+    {
+        char digits[24];
+        message.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+    }
+
+public:
+    // capacity of the ring, rounded up to a power of two
+    explicit logger(size_t capacity = 4096) : capacity(capacity) {}
+    ~logger();
+    logger(const logger &) = delete;
+    logger &operator=(const logger &) = delete;
+
+    // open the log file and start the writer, return false if the file cannot be opened
+    bool open(const std::string &file_name);
+    // write the remaining messages and close the log file
+    void close();
+    bool is_open() const { return writer.joinable(); }
+
+    // log the concatenation of the arguments as one line
+    template <typename... args_t>
+    void write(const args_t &...args)
+    {
+        thread_local std::string message;
+        message.clear();
+        (append(message, args), ...);
+        message.push_back('\n');
+        push(message);
+    }
+};
+
+// log at a level, levels below PARSER_LOG_LEVEL and closed loggers skip formatting the arguments
+#define LOG_AT(log, level, ...)                                 \
+    do                                                          \
+    {                                                           \
+        if constexpr (int(level) >= PARSER_LOG_LEVEL)           \
+        {                                                       \
+            if ((log).is_open())                                \
+            {                                                   \
+                (log).write(__VA_ARGS__);                       \
+            }                                                   \
+        }                                                       \
+    } while (0)
+
+#define LOG_DEBUG(log, ...) LOG_AT(log, log_level::debug, __VA_ARGS__)
+#define LOG_INFO(log, ...) LOG_AT(log, log_level::info, __VA_ARGS__)
+#define LOG_WARNING(log, ...) LOG_AT(log, log_level::warning, __VA_ARGS__)
+#define LOG_ERROR(log, ...) LOG_AT(log, log_level::error, __VA_ARGS__)
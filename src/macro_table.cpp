@@ -0,0 +1,392 @@
+/*
+ *  macro_table.cpp
+ *  source file for the macro_table class
+ *  author: jordan sun
+ */
+
+#include "macro_table.hpp"
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+struct binary_operator
+{
+    const char *text;
+    size_t length;
+    // higher binds tighter, 0 for none
+    int precedence;
+};
+
+// binary operators with their C precedence, longer ones first so << is not read as <
+static const binary_operator BINARY_OPERATORS[] = {
+    {"||", 2, 1}, {"&&", 2, 2}, {"==", 2, 6}, {"!=", 2, 6}, {"<=", 2, 7}, {">=", 2, 7}, {"<<", 2, 8}, {">>", 2, 8},
+    {"|", 1, 3}, {"^", 1, 4}, {"&", 1, 5}, {"<", 1, 7}, {">", 1, 7}, {"+", 1, 9}, {"-", 1, 9}, {"*", 1, 10}, {"/", 1, 10}, {"%", 1, 10}};
+
+static bool is_identifier_start(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool is_identifier_char(char c)
+{
+    return is_identifier_start(c) || (c >= '0' && c <= '9');
+}
+
+// get the value of a digit in a base, or the base if it is not one
+static int digit_value(char c, int base)
+{
+    int digit = base;
+    if (c >= '0' && c <= '9')
+    {
+        digit = c - '0';
+    }
+    else if (c >= 'a' && c <= 'f')
+    {
+        digit = c - 'a' + 10;
+    }
+    else if (c >= 'A' && c <= 'F')
+    {
+        digit = c - 'A' + 10;
+    }
+    return digit < base ? digit : base;
+}
+
+// apply a binary operator, return false if the result is undefined
+static bool apply(const binary_operator &op, int64_t lhs, int64_t rhs, int64_t &value)
+{
+    // wrap around rather than overflow, as the preprocessor of the compilers does
+    uint64_t left = lhs;
+    uint64_t right = rhs;
+    switch (op.text[0])
+    {
+    case '|':
+        value = op.length == 2 ? (lhs || rhs) : int64_t(left | right);
+        return true;
+    case '&':
+        value = op.length == 2 ? (lhs && rhs) : int64_t(left & right);
+        return true;
+    case '^':
+        value = int64_t(left ^ right);
+        return true;
+    case '=':
+        value = lhs == rhs;
+        return true;
+    case '!':
+        value = lhs != rhs;
+        return true;
+    case '<':
+        if (op.length == 2 && op.text[1] == '<')
+        {
+            if (rhs < 0 || rhs >= 64)
+            {
+                return false;
+            }
+            value = int64_t(left << rhs);
+            return true;
+        }
+        value = op.length == 2 ? lhs <= rhs : lhs < rhs;
+        return true;
+    case '>':
+        if (op.length == 2 && op.text[1] == '>')
+        {
+            if (rhs < 0 || rhs >= 64)
+            {
+                return false;
+            }
+            value = lhs >> rhs;
+            return true;
+        }
+        value = op.length == 2 ? lhs >= rhs : lhs > rhs;
+        return true;
+    case '+':
+        value = int64_t(left + right);
+        return true;
+    case '-':
+        value = int64_t(left - right);
+        return true;
+    case '*':
+        value = int64_t(left * right);
+        return true;
+    default:
+        // division and remainder
+        if (rhs == 0 || (lhs == numeric_limits<int64_t>::min() && rhs == -1))
+        {
+            return false;
+        }
+        value = op.text[0] == '/' ? lhs / rhs : lhs % rhs;
+        return true;
+    }
+}
+
+// Recursive descent over one expression, by precedence level.
+struct macro_table::expression_parser
+{
+    macro_table &table;
+    const char *cursor;
+    const char *end;
+    // identifiers that are not macros are 0, as in #if
+    bool condition;
+    // within an operand that is not evaluated, whose value is ignored and which cannot fail but on its syntax
+    bool skipping = false;
+
+    // skip whitespace and line continuations
+    void skip()
+    {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n' || (*cursor == '\\' && cursor + 1 < end && (cursor[1] == '\n' || cursor[1] == '\r'))))
+        {
+            cursor++;
+        }
+    }
+
+    // consume a character if it is next
+    bool accept(char c)
+    {
+        skip();
+        if (cursor < end && *cursor == c)
+        {
+            cursor++;
+            return true;
+        }
+        return false;
+    }
+
+    // [Condition] ? [Value] : [Value]
+    bool conditional(int64_t &value)
+    {
+        if (!binary(1, value))
+        {
+            return false;
+        }
+        if (!accept('?'))
+        {
+            return true;
+        }
+        // only the branch chosen is evaluated
+        bool chosen = value != 0;
+        bool was_skipping = skipping;
+        int64_t if_true;
+        int64_t if_false;
+        skipping = was_skipping || !chosen;
+        bool parsed = conditional(if_true) && accept(':');
+        skipping = was_skipping || chosen;
+        parsed = parsed && conditional(if_false);
+        skipping = was_skipping;
+        if (!parsed)
+        {
+            return false;
+        }
+        value = chosen ? if_true : if_false;
+        return true;
+    }
+
+    // the binary operators binding at least as tight as precedence, left to right
+    bool binary(int precedence, int64_t &value)
+    {
+        if (!unary(value))
+        {
+            return false;
+        }
+        while (true)
+        {
+            skip();
+            const binary_operator *op = nullptr;
+            for (const binary_operator &candidate : BINARY_OPERATORS)
+            {
+                if (size_t(end - cursor) >= candidate.length && string_view(cursor, candidate.length) == string_view(candidate.text, candidate.length))
+                {
+                    op = &candidate;
+                    break;
+                }
+            }
+            if (op == nullptr || op->precedence < precedence)
+            {
+                return true;
+            }
+            cursor += op->length;
+            // the right operand of && and || is not evaluated once the left one decides the result
+            bool logical = op->length == 2 && (op->text[0] == '&' || op->text[0] == '|') && op->text[1] == op->text[0];
+            bool decided = logical && (op->text[0] == '&' ? value == 0 : value != 0);
+            bool was_skipping = skipping;
+            skipping = was_skipping || decided;
+            int64_t rhs;
+            bool parsed = binary(op->precedence + 1, rhs);
+            skipping = was_skipping;
+            if (!parsed)
+            {
+                return false;
+            }
+            if (decided)
+            {
+                value = op->text[0] == '|';
+            }
+            else if (!apply(*op, value, rhs, value) && !skipping)
+            {
+                return false;
+            }
+        }
+    }
+
+    // + - ~ ! [Value]
+    bool unary(int64_t &value)
+    {
+        skip();
+        if (cursor < end && (*cursor == '+' || *cursor == '-' || *cursor == '~' || *cursor == '!'))
+        {
+            char op = *cursor++;
+            if (!unary(value))
+            {
+                return false;
+            }
+            uint64_t operand = value;
+            value = op == '-' ? int64_t(0 - operand) : op == '~' ? int64_t(~operand) : op == '!' ? !value : value;
+            return true;
+        }
+        return primary(value);
+    }
+
+    // ([Expression]), [Number], [Macro], defined [Macro] or defined([Macro])
+    bool primary(int64_t &value)
+    {
+        if (accept('('))
+        {
+            return conditional(value) && accept(')');
+        }
+        if (cursor < end && *cursor >= '0' && *cursor <= '9')
+        {
+            return number(value);
+        }
+        string_view name = identifier();
+        if (name.empty())
+        {
+            return false;
+        }
+        if (name == "defined")
+        {
+            bool parenthesized = accept('(');
+            skip();
+            name = identifier();
+            if (name.empty() || (parenthesized && !accept(')')))
+            {
+                return false;
+            }
+            value = table.is_defined(name);
+            return true;
+        }
+        if (condition && !table.is_defined(name))
+        {
+            value = 0;
+            return true;
+        }
+        if (skipping)
+        {
+            // a macro that is not evaluated is not expanded either
+            value = 0;
+            return table.is_defined(name);
+        }
+        return table.expand(name, value);
+    }
+
+    string_view identifier()
+    {
+        const char *start = cursor;
+        if (cursor < end && is_identifier_start(*cursor))
+        {
+            while (cursor < end && is_identifier_char(*cursor))
+            {
+                cursor++;
+            }
+        }
+        return string_view(start, cursor - start);
+    }
+
+    // a decimal, octal, hexadecimal or binary literal, with an optional u and l suffix
+    bool number(int64_t &value)
+    {
+        int base = 10;
+        if (*cursor == '0' && cursor + 1 < end && (cursor[1] == 'x' || cursor[1] == 'X' || cursor[1] == 'b' || cursor[1] == 'B'))
+        {
+            base = cursor[1] == 'x' || cursor[1] == 'X' ? 16 : 2;
+            cursor += 2;
+        }
+        else if (*cursor == '0')
+        {
+            base = 8;
+        }
+        const char *digits = cursor;
+        uint64_t result = 0;
+        for (int digit; cursor < end && (digit = digit_value(*cursor, base)) < base; cursor++)
+        {
+            if (result > (numeric_limits<uint64_t>::max() - digit) / base)
+            {
+                return false;
+            }
+            result = result * base + digit;
+        }
+        if (cursor == digits && base != 8)
+        {
+            return false;
+        }
+        while (cursor < end && (*cursor == 'u' || *cursor == 'U' || *cursor == 'l' || *cursor == 'L'))
+        {
+            cursor++;
+        }
+        if (cursor < end && is_identifier_char(*cursor))
+        {
+            return false;
+        }
+        value = int64_t(result);
+        return true;
+    }
+};
+
+bool macro_table::expand(string_view name, int64_t &value)
+{
+    auto it = macros.find(name);
+    if (it == macros.end())
+    {
+        return false;
+    }
+    // the macro stays in place while its value is evaluated, elements of the map are not moved by insertions
+    macro &entry = it->second;
+    if (entry.state == state_t::pending)
+    {
+        // a macro expanding to itself is left unexpanded by the preprocessor, so it is no constant
+        entry.state = state_t::evaluating;
+        entry.state = evaluate(entry.value, entry.result) ? state_t::evaluated : state_t::failed;
+    }
+    value = entry.result;
+    return entry.state == state_t::evaluated;
+}
+
+bool macro_table::define(string_view name, string_view value)
+{
+    auto [it, inserted] = macros.try_emplace(name);
+    bool same = inserted || it->second.value == value;
+    if (!same)
+    {
+        // values already derived from the previous definition are stale, evaluate them again
+        for (auto &[other_name, other] : macros)
+        {
+            other.state = state_t::pending;
+        }
+    }
+    it->second.value = value;
+    return same;
+}
+
+bool macro_table::evaluate(string_view expression, int64_t &value, bool condition)
+{
+    // most expressions are a single macro, as in rpc(l1a_num_threads), which is expanded without parsing
+    if (!condition && !expression.empty() && is_identifier_start(expression[0]) && all_of(expression.begin(), expression.end(), is_identifier_char) && expression != "defined")
+    {
+        return expand(expression, value);
+    }
+    expression_parser parser{*this, expression.data(), expression.data() + expression.size(), condition};
+    if (!parser.conditional(value))
+    {
+        return false;
+    }
+    parser.skip();
+    return parser.cursor == parser.end;
+}
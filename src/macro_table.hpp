@@ -0,0 +1,61 @@
+/*
+ *  macro_table.hpp
+ *  header file for the macro_table class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <string_view>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// Object-like macros of one translation unit, and an evaluator for the integer constant expressions written with them,
+// as in #define l1a_num_threads 2 or t1._priority = BASE_PRIORITY + 2;
+// Expressions are evaluated in C preprocessor arithmetic: 64-bit integers, with the C operators and their precedence.
+// Operands of &&, || and ?: that do not decide the result are parsed but not evaluated, so 0 && 1 / 0 is 0.
+// Each macro is expanded and evaluated at most once, later expressions referring to it read its cached value.
+// Macro values are views, which must outlive the table.
+class macro_table
+{
+private:
+    struct expression_parser;
+
+    enum class state_t : uint8_t
+    {
+        pending,
+        evaluating,
+        evaluated,
+        failed
+    };
+
+    struct macro
+    {
+        std::string_view value;
+        state_t state = state_t::pending;
+        int64_t result = 0;
+    };
+
+    std::unordered_map<std::string_view, macro> macros;
+
+    // get the value of a macro, evaluating it once, return false if it is undefined, recursive or not a constant expression
+    bool expand(std::string_view name, int64_t &value);
+    // evaluate an expression, in a condition identifiers that are not macros are 0
+    bool evaluate(std::string_view expression, int64_t &value, bool condition);
+
+public:
+    // define a macro, replacing its previous definition
+    // return false if it was already defined with a different value
+    bool define(std::string_view name, std::string_view value);
+    // check if a macro is defined
+    bool is_defined(std::string_view name) const { return macros.count(name) != 0; }
+    // get the number of macros defined
+    size_t size() const { return macros.size(); }
+    // reserve room for a number of macros
+    void reserve(size_t count) { macros.reserve(count); }
+    // evaluate an integer constant expression, return false if it is not one
+    bool evaluate(std::string_view expression, int64_t &value) { return evaluate(expression, value, false); }
+    // evaluate the condition of an #if or #elif, where identifiers that are not macros are 0, return false if it is not a constant expression
+    bool evaluate_condition(std::string_view expression, int64_t &value) { return evaluate(expression, value, true); }
+};
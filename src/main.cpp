@@ -4,14 +4,25 @@
  *  author: jordan sun
  */
 
-#include "component.hpp"
-#include "connection.hpp"
-#include "graph.hpp"
+#include "camkes_parser.hpp"
+#include "protocol_explorer.hpp"
+#include "response_time_analysis.hpp"
+#include "snapshot_cache.hpp"
+#include "thread_pool.hpp"
+#include "rewriter.hpp"
+#include "emitter.hpp"
+#include "mapped_file.hpp"
+#include "stats.hpp"
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include <fstream>
-#include <regex>
-#include <list>
+#include <filesystem>
+#include <algorithm>
+#include <exception>
+#include <charconv>
+#include <cstring>
+#include <glob.h>
 #include <getopt.h>
 
 using namespace std;
@@ -21,35 +32,240 @@ enum return_codes
 {
     SUCCESS,
     INVALID_ARGS,
-    FAILED_TO_OPEN_FILE
+    FAILED_TO_OPEN_FILE,
+    ANALYSIS_FAILED
 };
 // array of long options
 int ladder_flag = false;
+int regex_flag = false;
+int mmap_flag = false;
+int batch_edges_flag = false;
+int inspect_cache_flag = false;
+int verbose_flag = false;
+int explore_flag = false;
+int response_times_flag = false;
+bool werror_flag = false;
+output_format format = output_format::text;
+size_t max_errors = 0;
+// partial assignments --explore visits at most
+size_t explore_limit = 10000000;
+// chunks each input file is scanned in
+size_t chunks = 1;
 struct option long_options[] =
     {
         {"input", required_argument, 0, 'i'},
         {"output", required_argument, 0, 'o'},
         {"log", required_argument, 0, 'l'},
+        {"include", required_argument, 0, 'I'},
+        {"cache-dir", required_argument, 0, 'c'},
+        {"results-dir", required_argument, 0, 'r'},
+        {"jobs", required_argument, 0, 'j'},
+        {"stats", required_argument, 0, 's'},
+        {"max-errors", required_argument, 0, 'm'},
+        {"format", required_argument, 0, 'f'},
+        {"verbose", no_argument, 0, 'v'},
         {"ladder", no_argument, &ladder_flag, true},
+        {"regex", no_argument, &regex_flag, true},
+        {"mmap", no_argument, &mmap_flag, true},
+        {"batch-edges", no_argument, &batch_edges_flag, true},
+        {"inspect-cache", no_argument, &inspect_cache_flag, true},
+        {"explore", no_argument, &explore_flag, true},
+        {"explore-limit", required_argument, 0, 'x'},
+        {"response-times", no_argument, &response_times_flag, true},
+        {"chunks", required_argument, 0, 'k'},
         {0, 0, 0, 0}};
 
-int main(int argc, char* argv[])
+/*
+    Phase 5: Output replaced configuration to output file.
+        #define [Macro] [Threads]               for each macro passed to rpc([Macro])
+        [Component].[Port]_priority = [Priority];
+    Only the values are replaced, every other byte is copied through, and the file is left alone if nothing changed.
+ */
+static int rewrite(const string &input_file_name, const string &output_file_name, const frozen_graph &frozen, ostream &err, logger &log)
 {
-    // parsing helper variables.
+    LOG_INFO(log, "Phase 5: Writing replaced configuration...");
+    STATS_SCOPE(rewrite);
+    mapped_file input;
+    if (!input.open(input_file_name))
+    {
+        err << "Error: failed to open input file " << input_file_name << endl;
+        return FAILED_TO_OPEN_FILE;
+    }
+    string replaced;
+    size_t count = rewrite_configuration(input.data(), input.data() + input.size(), frozen, replaced);
+    input.close();
+    bool written;
+    if (!write_if_changed(output_file_name, replaced, written))
+    {
+        err << "Error: failed to write output file " << output_file_name << endl;
+        return FAILED_TO_OPEN_FILE;
+    }
+    LOG_INFO(log, "Replaced ", count, " values, ", (written ? "wrote " : "unchanged "), output_file_name);
+    return SUCCESS;
+}
+
+// Analyse one input file, printing the graph to out and what was diagnosed to err, sorted by location.
+// With --explore the pareto front of the protocol assignments is printed instead of the graph, searched on the pool.
+// With --response-times the response times of the tasks are printed instead, a task missing its deadline is an error.
+// If an output file is given, the input with the computed values replaced is written to it.
+// Fails if an error was diagnosed, or a warning with -Werror.
+static int run(const camkes_parser &parser, const parse_options &options, thread_pool &pool, const string &input_file_name, const string &output_file_name, ostream &out, ostream &err, logger &log)
+{
+    // Phases 0-4 and the analyses
+    parse_result result = parser.parse_file(input_file_name, options, log);
+    out << result.cycles;
+    int code = FAILED_TO_OPEN_FILE;
+    if (result.parsed)
+    {
+        LOG_INFO(log, "Printing...");
+
+        if (explore_flag)
+        {
+            LOG_INFO(log, "Exploring protocol assignments...");
+            STATS_START(explore);
+            protocol_explorer explorer(*result.graph, pool);
+            explorer.max_visits = explore_limit;
+            exploration_result front = explorer.explore();
+            STATS_STOP(explore);
+            emit(front, format, out);
+        }
+        else if (response_times_flag)
+        {
+            LOG_INFO(log, "Analysing response times...");
+            STATS_START(response);
+            schedulability_result responses = response_time_analysis(*result.graph).analyse(result.diags);
+            STATS_STOP(response);
+            emit(responses, format, out);
+        }
+        else
+        {
+            // print the graph, with the threads behind each count if verbose
+            STATS_START(print);
+            emit(result.analysis, format, verbose_flag, out);
+            STATS_STOP(print);
+        }
+
+        // Phase 5
+        code = output_file_name == "" ? SUCCESS : rewrite(input_file_name, output_file_name, *result.graph, err, log);
+    }
+    result.diags.print(err);
+    if (code == SUCCESS && result.diags.error_count() > 0)
+    {
+        code = ANALYSIS_FAILED;
+    }
+    return code;
+}
+
+// Expand the inputs into files, directories to the .camkes files they contain and globs to their matches, each sorted.
+// return false if an input matches nothing
+static bool expand_inputs(const vector<string> &inputs, vector<string> &input_files)
+{
+    for (const string &input : inputs)
+    {
+        error_code error;
+        if (filesystem::is_directory(input, error))
+        {
+            vector<string> contained;
+            for (const filesystem::directory_entry &entry : filesystem::directory_iterator(input, error))
+            {
+                if (entry.is_regular_file(error) && entry.path().extension() == ".camkes")
+                {
+                    contained.push_back(entry.path().string());
+                }
+            }
+            sort(contained.begin(), contained.end());
+            input_files.insert(input_files.end(), contained.begin(), contained.end());
+        }
+        else if (input.find_first_of("*?[") != string::npos)
+        {
+            glob_t matches;
+            if (glob(input.c_str(), 0, nullptr, &matches) != 0)
+            {
+                globfree(&matches);
+                cerr << "Error: no input file matches " << input << endl;
+                return false;
+            }
+            input_files.insert(input_files.end(), matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+            globfree(&matches);
+        }
+        else
+        {
+            input_files.push_back(input);
+        }
+    }
+    return true;
+}
+
+// write each line of the text to os, prefixed with the input it is about
+static void print_prefixed(ostream &os, const string &input_file_name, const string &text)
+{
+    istringstream lines(text);
     string line;
-    smatch match;
+    while (getline(lines, line))
+    {
+        os << input_file_name << ": " << line << endl;
+    }
+}
+
+// Write the statistics of the whole run as json to the file, or to stderr for "-".
+static void write_stats(const string &stats_file_name)
+{
+    if (stats_file_name == "")
+    {
+        return;
+    }
+#ifdef PARSER_STATS
+    if (stats_file_name == "-")
+    {
+        stats::print_json(cerr);
+        return;
+    }
+    ofstream stats_file(stats_file_name);
+    if (!stats_file.is_open())
+    {
+        cerr << "Error: failed to open stats file " << stats_file_name << endl;
+        return;
+    }
+    stats::print_json(stats_file);
+#else
+    cerr << "Warning: built without PARSER_STATS, --stats is ignored." << endl;
+#endif
+}
 
-    // initialize the graph.
-    graph g;
+// print how the program is used
+static void print_usage(const char *program)
+{
+    cout << "Usage: " << program << " -i <input file, directory or glob>... [-o <output file, or directory with several inputs>] [-l <log file>] [-I <include path>]... [-j <jobs>] [--results-dir <directory>] [--stats <file>] [--max-errors <n>] [-Werror] [--format <text|json|csv>] [-v] [--explore] [--explore-limit <n>] [--response-times] [--ladder] [--regex] [--mmap] [--chunks <n>] [--batch-edges] [--cache-dir <directory>] [--inspect-cache]" << endl;
+}
+
+// parse the non-negative integer argument of an option, report it and return false if the whole argument is not one
+static bool parse_count(const char *option, const char *argument, size_t &value)
+{
+    const char *end = argument + strlen(argument);
+    from_chars_result parsed = from_chars(argument, end, value);
+    if (parsed.ec != errc() || parsed.ptr != end || argument == end)
+    {
+        cerr << "Error: invalid argument " << argument << " for " << option << ", expected a non-negative integer." << endl;
+        return false;
+    }
+    return true;
+}
 
+int main(int argc, char* argv[])
+{
     // parse the command line arguments
-    string input_file_name = "";
+    vector<string> inputs;
     string output_file_name = "";
     string log_file_name = "";
+    vector<string> include_paths;
+    string cache_dir = "";
+    string results_dir = "";
+    size_t num_jobs = 0;
+    string stats_file_name = "";
     while (true)
     {
         int option_index = 0;
-        int c = getopt_long(argc, argv, "i:o:l:", long_options, &option_index);
+        int c = getopt_long(argc, argv, "i:o:l:I:j:W:v", long_options, &option_index);
 
         if (c == -1)
             break;
@@ -57,7 +273,7 @@ int main(int argc, char* argv[])
         switch (c)
         {
         case 'i':
-            input_file_name = optarg;
+            inputs.push_back(optarg);
             break;
         case 'o':
             output_file_name = optarg;
@@ -65,296 +281,237 @@ int main(int argc, char* argv[])
         case 'l':
             log_file_name = optarg;
             break;
+        case 'I':
+            include_paths.push_back(optarg);
+            break;
+        case 'c':
+            cache_dir = optarg;
+            break;
+        case 'r':
+            results_dir = optarg;
+            break;
+        case 'j':
+            if (!parse_count("-j", optarg, num_jobs))
+            {
+                print_usage(argv[0]);
+                return INVALID_ARGS;
+            }
+            break;
+        case 's':
+            stats_file_name = optarg;
+            break;
+        case 'm':
+            if (!parse_count("--max-errors", optarg, max_errors))
+            {
+                print_usage(argv[0]);
+                return INVALID_ARGS;
+            }
+            break;
+        case 'f':
+            if (!parse_output_format(optarg, format))
+            {
+                cerr << "Error: unknown format " << optarg << ", expected text, json or csv." << endl;
+                return INVALID_ARGS;
+            }
+            break;
+        case 'v':
+            verbose_flag = true;
+            break;
+        case 'x':
+            if (!parse_count("--explore-limit", optarg, explore_limit))
+            {
+                print_usage(argv[0]);
+                return INVALID_ARGS;
+            }
+            break;
+        case 'k':
+            if (!parse_count("--chunks", optarg, chunks))
+            {
+                print_usage(argv[0]);
+                return INVALID_ARGS;
+            }
+            break;
+        case 'W':
+            // -Werror, the only warning option
+            if (string(optarg) != "error")
+            {
+                cerr << "Error: unknown option -W" << optarg << "." << endl;
+                return INVALID_ARGS;
+            }
+            werror_flag = true;
+            break;
         default:
             break;
         }
     }
-
-    // set the ladder flag
-    g.ladder_flag = ladder_flag;
-
-    // check if the input file was specified
-    if (input_file_name == "")
+    // the remaining arguments are inputs too
+    for (int i = optind; i < argc; i++)
     {
-        cerr << "Error: no input file specified." << endl;
-        cout << "Usage: " << argv[0] << " -i <input file> [-o <output file>] [-l <log file>] [--ladder]" << endl;
-        return INVALID_ARGS;
+        inputs.push_back(argv[i]);
     }
 
-    // open the log file if specified
-    ofstream log_file;
-    if (log_file_name != "")
+    // print the snapshot cache instead of parsing
+    if (inspect_cache_flag)
     {
-        log_file.open(log_file_name);
-        if (!log_file.is_open())
+        if (cache_dir == "")
         {
-            cerr << "Error: failed to open log file " << log_file_name << endl;
-            return FAILED_TO_OPEN_FILE;
+            cerr << "Error: --inspect-cache requires --cache-dir." << endl;
+            return INVALID_ARGS;
         }
+        snapshot_cache(cache_dir).inspect(cout);
+        return SUCCESS;
     }
 
-    /*
-        Phase 0: Expand the input file in place.   
-     */
-    // todo: implement this
-
-    /*
-        Phase 1: Parse the components through simple regex.
-        For each
-            component [ComponentType] [Component];
-                        ^- ignored      ^- name
-        in the input file, create a component object and add it to the graph.
-     */
-    regex component_regex("component (\\w+) (\\w+);");
-
-    if (log_file.is_open())
-    {
-        log_file << "Phase 1: Parsing components..." << endl;
-    }
-
-    // open the input file
-    ifstream input_file(input_file_name);
-    if (!input_file.is_open())
+    // check if the input file was specified
+    if (inputs.empty())
     {
-        cerr << "Error: failed to open input file " << input_file_name << endl;
-        return FAILED_TO_OPEN_FILE;
+        cerr << "Error: no input file specified." << endl;
+        print_usage(argv[0]);
+        return INVALID_ARGS;
     }
 
-    // parse the input file line by line
-    while (getline(input_file, line))
+    // analyse the inputs on one pool, which also reads imported files
+    thread_pool pool(num_jobs);
+    camkes_parser parser(pool);
+    parse_options options;
+    options.include_paths = include_paths;
+    options.ladder = ladder_flag;
+    options.regex = regex_flag;
+    options.mmap = mmap_flag;
+    options.chunks = chunks;
+    options.batch_edges = batch_edges_flag;
+    options.trace = verbose_flag;
+    options.cache_dir = cache_dir;
+    options.warnings_as_errors = werror_flag;
+    options.max_errors = max_errors;
+
+    // a single input file prints its graph
+    bool batch = inputs.size() > 1 || results_dir != "" || filesystem::is_directory(inputs[0]) || inputs[0].find_first_of("*?[") != string::npos;
+    if (!batch)
     {
-        // try matching the line with the component regex
-        if (regex_search(line, match, component_regex))
+        // open the log file if specified
+        logger log;
+        if (log_file_name != "")
         {
-            // create a component object and add it to the graph
-            string name = match[2];
-            g.add_node(make_shared<component>(name));
-            if (log_file.is_open())
+            if (!log.open(log_file_name))
             {
-                log_file << "Added component node " << name << endl;
+                cerr << "Error: failed to open log file " << log_file_name << endl;
+                return FAILED_TO_OPEN_FILE;
             }
         }
+        int code = run(parser, options, pool, inputs[0], output_file_name, cout, cerr, log);
+        write_stats(stats_file_name);
+        return code;
     }
 
     /*
-        Phase 2: Parse the connections through double regex.
-        For each
-            connection rpc([Threads]) [Connection]([Unparsed]);
-                            ^- ignored      ^- name
-        Split unparsed by comma, and for each
-            from/to [Component].[Port]
-                        ^- name     ^- port
-        in the input file, create a connection object and add it to the graph.
-        Then add an edge between each pair of source and destination component to the connection.
+        Batch mode: analyse every input file in parallel, each into its own result file.
+            The result of [Input] is written to [Input].result, or to [Results Directory]/[Input File Name].result.
+            The log of [Input] is written to [Log File].[Input File Name].
+            The replaced configuration of [Input] is written to [Output Directory]/[Input File Name].
+        Errors are reported per input, prefixed with the input, and everything is reported in input order.
      */
-    regex connection_regex("connection rpc([^ ]+) (\\w+)\\(([^)]+)\\);");
-    regex port_regex("(from|to) (\\w+).(\\w+)");
-
-    if (log_file.is_open())
+    vector<string> input_files;
+    if (!expand_inputs(inputs, input_files))
     {
-        log_file << "Phase 2: Parsing connections..." << endl;
+        return INVALID_ARGS;
     }
-
-    // reset the input file
-    input_file.clear();
-    input_file.seekg(0, ios::beg);
-
-    // parse the input file line by line
-    while (getline(input_file, line))
+    vector<string> result_files;
+    vector<string> output_files;
+    for (const string &input_file_name : input_files)
     {
-        // try matching the line with the connection regex
-        if (regex_search(line, match, connection_regex))
+        string file_name = filesystem::path(input_file_name).filename().string();
+        if (output_file_name != "")
         {
-            // create a connection object and add it to the graph
-            string name = match[2];
-            // parse the unparsed part of the connection
-            string unparsed = match[3];
-            // split the unparsed part by comma
-            istringstream unparsed_stream(unparsed);
-            // store the parsed nodes in a list
-            list<string> from_nodes;
-            list<string> conn_nodes;
-            // parse each port
-            while (getline(unparsed_stream, line, ','))
+            string output_file = (filesystem::path(output_file_name) / file_name).string();
+            auto other = find(output_files.begin(), output_files.end(), output_file);
+            if (other != output_files.end())
             {
-                // try matching the unparsed port with the port regex
-                if (regex_search(line, match, port_regex))
-                {
-                    // get the name and port of the component
-                    string direction = match[1];
-                    string component_name = match[2];
-                    string port_name = match[3];
-
-                    if (direction == "from")
-                    {
-                        // push the component's name to the from_nodes list
-                        from_nodes.push_back(component_name);
-                        if (log_file.is_open())
-                        {
-                            log_file << "Parsed from node " << component_name << endl;
-                        }
-                    }
-                    else if (direction == "to")
-                    {
-                        // create a connection node
-                        shared_ptr<node> conn = make_shared<connection>(name, component_name, port_name);
-                        string identifier = conn->get_identifier();
-                        // add the connection node to the graph
-                        g.add_node(conn);
-                        // push the connection node's name to the conn_nodes list
-                        conn_nodes.push_back(identifier);
-                        if (log_file.is_open())
-                        {
-                            log_file << "Added connection " << name << " (" << identifier << ")" << endl;
-                        }
-                        // add an edge from the connection to the component
-                        g.add_edge(identifier, component_name);
-                        if (log_file.is_open())
-                        {
-                            log_file << "Added edge " << identifier << " -> " << component_name << endl;
-                        }
-                    }
-                }
-            }
-            // add edges from each from node to each connection node
-            for (string from_node : from_nodes)
-            {
-                for (string conn_node : conn_nodes)
-                {
-                    g.add_edge(from_node, conn_node);
-                    if (log_file.is_open())
-                    {
-                        log_file << "Added edge " << from_node << " -> " << conn_node << endl;
-                    }
-                }
+                cerr << "Error: inputs " << input_files[other - output_files.begin()] << " and " << input_file_name << " both write " << output_file << endl;
+                return INVALID_ARGS;
             }
+            output_files.push_back(output_file);
+        }
+        else
+        {
+            output_files.push_back("");
+        }
+        string result_file_name = (results_dir == "" ? input_file_name : (filesystem::path(results_dir) / file_name).string()) + ".result";
+        auto other = find(result_files.begin(), result_files.end(), result_file_name);
+        if (other != result_files.end())
+        {
+            cerr << "Error: inputs " << input_files[other - result_files.begin()] << " and " << input_file_name << " both write " << result_file_name << endl;
+            return INVALID_ARGS;
         }
+        result_files.push_back(result_file_name);
     }
-
-    /*
-        Phase 3: Parse the priority.
-        For each
-            [Component]._priority = [Priority];
-            ^- name                     ^- priority
-        in the input file, set the priority of the component.
-     */
-    regex priority_regex("(\\w+)\\._priority = (\\d+);");
-
-    if (log_file.is_open())
+    error_code error;
+    if (results_dir != "")
     {
-        log_file << "Phase 3: Parsing priorities..." << endl;
+        filesystem::create_directories(results_dir, error);
+    }
+    if (output_file_name != "")
+    {
+        filesystem::create_directories(output_file_name, error);
     }
 
-    // reset the input file
-    input_file.clear();
-    input_file.seekg(0, ios::beg);
-
-    // parse the input file line by line
-    while (getline(input_file, line))
+    // each input keeps its messages until all earlier inputs are reported
+    vector<task_future<pair<int, string>>> runs;
+    for (size_t i = 0; i < input_files.size(); i++)
     {
-        // try matching the line with the priority regex
-        if (regex_search(line, match, priority_regex))
+        string input_file_name = input_files[i];
+        string result_file_name = result_files[i];
+        string input_output_file_name = output_files[i];
+        string input_log_file_name = log_file_name == "" ? "" : log_file_name + "." + filesystem::path(input_file_name).filename().string();
+        runs.push_back(pool.submit([&, input_file_name, result_file_name, input_output_file_name, input_log_file_name]()
         {
-            // get the name and priority of the component
-            string name = match[1];
-            istringstream priority_stream(match[2]);
-            size_t priority;
-            priority_stream >> priority;
-
-            // set the priority of the component
-            shared_ptr<node> node = g.get_node(name);
-            if (node == nullptr)
+            ostringstream messages;
+            ofstream result_file(result_file_name);
+            if (!result_file.is_open())
             {
-                cerr << "Error: component " << name << " not found." << endl;
+                messages << "Error: failed to open result file " << result_file_name << endl;
+                return make_pair(int(FAILED_TO_OPEN_FILE), messages.str());
             }
-            else
+            logger log;
+            if (input_log_file_name != "")
             {
-                shared_ptr<component> comp = dynamic_pointer_cast<component>(node);
-                if (comp == nullptr)
-                {
-                    cerr << "Error: node " << name << " is not a component." << endl;
-                }
-                else
+                if (!log.open(input_log_file_name))
                 {
-                    comp->set_priority(priority);
-                    if (log_file.is_open())
-                    {
-                        log_file << "Set priority of " << name << " to " << priority << endl;
-                    }
+                    messages << "Error: failed to open log file " << input_log_file_name << endl;
+                    return make_pair(int(FAILED_TO_OPEN_FILE), messages.str());
                 }
             }
-        }
-    }
-
-    /*
-        Phase 4: Parse the propagation protocol.
-        For each
-            [Component].[Port]_priority_protocol = "[Protocol]";
-            ^- name     ^- port                     ^- protocol
-        in the input file, set the propagation protocol of the connection.
-     */
-    regex protocol_regex("(\\w+)\\.(\\w+)_priority_protocol = \"([^\"]+)\";");
-
-    if (log_file.is_open())
-    {
-        log_file << "Phase 4: Parsing protocols..." << endl;
-    }
-
-    // reset the input file
-    input_file.clear();
-    input_file.seekg(0, ios::beg);
-
-    // parse the input file line by line
-    while (getline(input_file, line))
-    {
-        // try matching the line with the protocol regex
-        if (regex_search(line, match, protocol_regex))
-        {
-            // get the name, port and protocol of the connection
-            string name = match[1];
-            string port = match[2];
-            string protocol = match[3];
-
-            // set the propagation protocol of the connection
-            shared_ptr<node> node = g.get_node(name + "." + port);
-            if (node == nullptr)
+            // one input failing unexpectedly fails only its run, the others are still reported
+            int code;
+            try
             {
-                cerr << "Error: connection " << name << " not found." << endl;
+                code = run(parser, options, pool, input_file_name, input_output_file_name, result_file, messages, log);
             }
-            else
+            catch (const exception &e)
             {
-                shared_ptr<connection> conn = dynamic_pointer_cast<connection>(node);
-                if (conn == nullptr)
-                {
-                    cerr << "Error: node " << name << " is not a connection." << endl;
-                }
-                else
-                {
-                    conn->set_protocol(protocol);
-                    if (log_file.is_open())
-                    {
-                        log_file << "Set protocol of " << name << "." << port << " to " << protocol << endl;
-                    }
-                }
+                messages << "Error: analysis failed: " << e.what() << endl;
+                code = ANALYSIS_FAILED;
             }
-        }
+            return make_pair(code, messages.str());
+        }));
     }
 
-    // close the input file
-    input_file.close();
-
-    if (log_file.is_open())
+    int code = SUCCESS;
+    for (size_t i = 0; i < runs.size(); i++)
     {
-        log_file << "Finished parsing. Printing..." << endl;
+        pool.wait(runs[i]);
+        pair<int, string> result = runs[i].get();
+        print_prefixed(cerr, input_files[i], result.second);
+        if (result.first == SUCCESS)
+        {
+            cout << input_files[i] << " -> " << result_files[i] << endl;
+        }
+        else
+        {
+            cout << input_files[i] << " failed" << endl;
+            code = max(code, result.first);
+        }
     }
-
-    // print the graph
-    g.print(cout);
-
-    /*
-        Phase 5: Output replaced configuration to output file.
-     */
-    // todo: implement this
-
-    return SUCCESS;
+    write_stats(stats_file_name);
+    return code;
 }
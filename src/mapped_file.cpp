@@ -0,0 +1,63 @@
+/*
+ *  mapped_file.cpp
+ *  source file for the mapped_file class
+ *  author: jordan sun
+ */
+
+#include "mapped_file.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+mapped_file::~mapped_file()
+{
+    close();
+}
+
+bool mapped_file::open(const string &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    // an empty file cannot be mapped, but is still a valid empty buffer
+    if (st.st_size == 0)
+    {
+        ::close(fd);
+        buffer = "";
+        return true;
+    }
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        return false;
+    }
+    // the lexer reads the buffer front to back exactly once
+    madvise(addr, st.st_size, MADV_SEQUENTIAL);
+    buffer = static_cast<const char *>(addr);
+    length = st.st_size;
+    return true;
+}
+
+void mapped_file::close()
+{
+    if (length > 0)
+    {
+        munmap(const_cast<char *>(buffer), length);
+    }
+    buffer = nullptr;
+    length = 0;
+}
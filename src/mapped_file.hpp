@@ -0,0 +1,33 @@
+/*
+ *  mapped_file.hpp
+ *  header file for the mapped_file class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file, unmapped on destruction.
+class mapped_file
+{
+private:
+    const char *buffer = nullptr;
+    size_t length = 0;
+
+public:
+    mapped_file() = default;
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    // map the file into memory, return true if successful
+    bool open(const std::string &path);
+    // unmap the file
+    void close();
+
+    const char *data() const { return buffer; }
+    size_t size() const { return length; }
+};
@@ -1,16 +1,14 @@
 /*
  *  node.hpp
- *  header file for the node class
+ *  header file for the node attributes
  *  author: jordan sun
  */
 
 #pragma once
 
-#include <string>
-#include <vector>
-#include <iostream>
-#include <set>
-#include <memory>
+#include "diagnostics.hpp"
+#include <string_view>
+#include <cstddef>
 
 enum class type_t
 {
@@ -28,77 +26,72 @@ enum class protocol_t
     propagation
 };
 
-class node : public std::enable_shared_from_this<node>
-{
-public:
-    // auxiliary data
-    bool ladder_flag = false;
-    std::string name;
-    std::shared_ptr<node> last = nullptr;
-    std::set<std::shared_ptr<node>> requestors;
-
-    virtual ~node() = default;
+// priority of a component that is never assigned one, the largest priority once unsigned
+const size_t DEFAULT_PRIORITY = -1;
+// thread count declared by a connection whose rpc([Threads]) argument is empty or not a constant
+const size_t UNKNOWN_THREADS = -1;
+// time a configuration does not set
+const size_t UNKNOWN_TIME = -1;
+// times are below this bound, so the response time analysis computes with them exactly in doubles
+const size_t MAX_TIME = size_t(1) << 52;
 
-    // Get the name of the node
-    virtual std::string get_identifier() const = 0;
-    // Get the type of the node
-    virtual type_t get_type() const = 0;
-    // Get the protocol of the node
-    virtual protocol_t get_protocol() const = 0;
-    
-    // Get the max priority of all requestors of this node.
-    virtual size_t get_priority() const = 0;
-    // Get the number of threads needed to run this node.
-    virtual size_t get_thread_count() const = 0;
-    // Get all threads needed to run this node, recursive helper function for get_thread_count.
-    virtual void get_threads(std::set<std::shared_ptr<const node>> &threads, std::vector<std::set<std::shared_ptr<const node>>> &fixed_threads_pool, bool &require_nested_thread) const = 0;
+enum class timing_t
+{
+    execution_time,
+    execution_time_post,
+    period,
+    release_time
+};
 
-    // Print the node
-    virtual void print(std::ostream &os) const = 0;
+// Timing set in the configuration, of a task or of the server behind a connection, UNKNOWN_TIME where it is not set.
+struct node_timing
+{
+    // execution_time_pre and execution_time_post of a task, [Port]_execution_time and [Port]_execution_time_post of a connection,
+    // the time spent before and after the calls made to other servers
+    size_t execution_time = UNKNOWN_TIME;
+    size_t execution_time_post = UNKNOWN_TIME;
+    // period of a task, which is also its deadline, and the release time of its first job
+    size_t period = UNKNOWN_TIME;
+    size_t release_time = UNKNOWN_TIME;
 
-    // Add a requestor to this node.
-    void add_requestor(std::shared_ptr<node> requestor)
+    void set(timing_t kind, size_t value)
     {
-        requestors.insert(requestor);
+        switch (kind)
+        {
+        case timing_t::execution_time:
+            execution_time = value;
+            break;
+        case timing_t::execution_time_post:
+            execution_time_post = value;
+            break;
+        case timing_t::period:
+            period = value;
+            break;
+        case timing_t::release_time:
+            release_time = value;
+            break;
+        }
     }
+};
 
-    // Print the threads set
-    static void print_threads(std::ostream &os, const std::set<std::shared_ptr<const node>> &threads, std::vector<std::set<std::shared_ptr<const node>>> &fixed_threads_pool, bool require_nested_thread)
+// parse a protocol as written in a configuration (fixed, inherited or propagated), return false if unknown
+inline bool parse_protocol(std::string_view name, protocol_t &protocol)
+{
+    if (name == "fixed")
     {
-        os << "{";
-        for (auto it = threads.begin(); it != threads.end(); it++)
-        {
-            if (it != threads.begin())
-            {
-                os << ", ";
-            }
-            os << (*it)->get_identifier();
-        }
-        if (fixed_threads_pool.size() > 0)
-        {
-            os << "{";
-        }
-        for (auto it = fixed_threads_pool.begin(); it != fixed_threads_pool.end(); it++)
-        {
-            if (it != fixed_threads_pool.begin())
-            {
-                os << ", {";
-            }
-            for (auto it2 = it->begin(); it2 != it->end(); it2++)
-            {
-                if (it2 != it->begin())
-                {
-                    os << ", ";
-                }
-                os << (*it2)->get_identifier();
-            }
-            os << "}";
-        }
-        os << "}";
-        if (require_nested_thread)
-        {
-            os << " + nested thread";
-        }
-        os << " = ";
+        protocol = protocol_t::ipcp;
+    }
+    else if (name == "inherited")
+    {
+        protocol = protocol_t::pip;
+    }
+    else if (name == "propagated")
+    {
+        protocol = protocol_t::propagation;
+    }
+    else
+    {
+        return false;
     }
-};
\ No newline at end of file
+    return true;
+}
@@ -0,0 +1,1465 @@
+/*
+ *  parser.cpp
+ *  source file for the statement parser
+ *  author: jordan sun
+ */
+
+#include "parser.hpp"
+#include "lexer.hpp"
+#include "macro_table.hpp"
+#include "composition_tree.hpp"
+#include "stats.hpp"
+#include <iostream>
+#include <sstream>
+#include <regex>
+#include <list>
+#include <charconv>
+#include <cctype>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+const string_view PROTOCOL_SUFFIX = "_priority_protocol";
+const string_view EXECUTION_TIME_SUFFIX = "_execution_time";
+const string_view EXECUTION_TIME_POST_SUFFIX = "_execution_time_post";
+
+static bool is_punctuation(const token &tok, char c)
+{
+    return tok.type == token_t::punctuation && tok.text[0] == c;
+}
+
+static bool is_identifier(const token &tok, const char *text)
+{
+    return tok.type == token_t::identifier && tok.text == text;
+}
+
+// try to recognize: component [ComponentType] [Component];
+static bool match_component(const vector<token> &stmt, string_view scope, statements &stmts)
+{
+    if (stmt.size() != 4 || !is_identifier(stmt[0], "component") || stmt[1].type != token_t::identifier || stmt[2].type != token_t::identifier || !is_punctuation(stmt[3], ';'))
+    {
+        return false;
+    }
+    stmts.components.push_back({stmt[1].text, stmt[2].text, scope, {0, uint32_t(stmt[0].line)}});
+    return true;
+}
+
+// try to recognize: connection rpc([Threads]) [Connection](from/to [Component].[Port], ...);
+static bool match_connection(const vector<token> &stmt, string_view scope, statements &stmts)
+{
+    if (stmt.size() < 8 || !is_identifier(stmt[0], "connection") || !is_identifier(stmt[1], "rpc") || !is_punctuation(stmt[2], '('))
+    {
+        return false;
+    }
+    // the thread count argument, kept as raw text
+    size_t i = 3;
+    while (i < stmt.size() && !is_punctuation(stmt[i], ')'))
+    {
+        i++;
+    }
+    string_view threads;
+    if (i > 3 && i < stmt.size())
+    {
+        threads = string_view(stmt[3].text.data(), stmt[i - 1].text.data() + stmt[i - 1].text.size() - stmt[3].text.data());
+    }
+    i++;
+    if (i + 1 >= stmt.size() || stmt[i].type != token_t::identifier || !is_punctuation(stmt[i + 1], '('))
+    {
+        return false;
+    }
+
+    connection_statement conn = {stmt[i].text, threads, stmts.ports.size(), 0, scope, {0, uint32_t(stmt[0].line)}};
+    i += 2;
+    // parse each port: from/to [Component].[Port]
+    while (i + 3 < stmt.size())
+    {
+        const token &direction = stmt[i];
+        if (!(is_identifier(direction, "from") || is_identifier(direction, "to")) || stmt[i + 1].type != token_t::identifier || !is_punctuation(stmt[i + 2], '.') || stmt[i + 3].type != token_t::identifier)
+        {
+            stmts.ports.resize(conn.first_port);
+            return false;
+        }
+        stmts.ports.push_back({direction.text == "from", stmt[i + 1].text, stmt[i + 3].text});
+        conn.port_count++;
+        i += 4;
+        if (i < stmt.size() && is_punctuation(stmt[i], ','))
+        {
+            i++;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (i + 2 != stmt.size() || !is_punctuation(stmt[i], ')') || !is_punctuation(stmt[i + 1], ';'))
+    {
+        stmts.ports.resize(conn.first_port);
+        return false;
+    }
+    stmts.connections.push_back(conn);
+    return true;
+}
+
+// check if an attribute is [Port][suffix], with a port
+static bool has_suffix(string_view attribute, string_view suffix)
+{
+    return attribute.size() > suffix.size() && attribute.substr(attribute.size() - suffix.size()) == suffix;
+}
+
+// try to recognize: connection seL4RPCCall [Connection](from [Dispatcher].[Port], to [Task].[Port]);
+static bool match_dispatch(const vector<token> &stmt, string_view scope, statements &stmts)
+{
+    if (stmt.size() != 15 || !is_identifier(stmt[0], "connection") || !is_identifier(stmt[1], "seL4RPCCall") || stmt[2].type != token_t::identifier || !is_punctuation(stmt[3], '(') || !is_identifier(stmt[4], "from") || stmt[5].type != token_t::identifier || !is_punctuation(stmt[6], '.') || stmt[7].type != token_t::identifier || !is_punctuation(stmt[8], ',') || !is_identifier(stmt[9], "to") || stmt[10].type != token_t::identifier || !is_punctuation(stmt[11], '.') || stmt[12].type != token_t::identifier || !is_punctuation(stmt[13], ')') || !is_punctuation(stmt[14], ';'))
+    {
+        return false;
+    }
+    stmts.dispatches.push_back({stmt[5].text, stmt[7].text, stmt[10].text, stmt[12].text, scope, {0, uint32_t(stmt[0].line)}});
+    return true;
+}
+
+// try to recognize: [Component]._priority = [Priority];
+//               or: [Component].[Port]_priority_protocol = "[Protocol]";
+//               or: [Task].execution_time_pre, execution_time_post, period or release_time = [Time];
+//               or: [Component].[Port]_execution_time or [Port]_execution_time_post = [Time];
+static bool match_assignment(const vector<token> &stmt, string_view scope, statements &stmts)
+{
+    if (stmt.size() < 6 || stmt[0].type != token_t::identifier || !is_punctuation(stmt[1], '.') || stmt[2].type != token_t::identifier || !is_punctuation(stmt[3], '=') || !is_punctuation(stmt.back(), ';'))
+    {
+        return false;
+    }
+    string_view attribute = stmt[2].text;
+    if (attribute == "_priority")
+    {
+        // the priority is usually a literal, anything else is kept as raw text and evaluated with the macros
+        string_view value = stmt[4].text;
+        size_t priority = 0;
+        if (stmt.size() == 6 && stmt[4].type == token_t::number)
+        {
+            from_chars_result result = from_chars(value.data(), value.data() + value.size(), priority);
+            if (result.ec == errc() && result.ptr == value.data() + value.size())
+            {
+                stmts.priorities.push_back({stmt[0].text, priority, string_view(), scope, {0, uint32_t(stmt[0].line)}});
+                return true;
+            }
+        }
+        const token &last = stmt[stmt.size() - 2];
+        string_view expression(value.data(), last.text.data() + last.text.size() - value.data());
+        stmts.priorities.push_back({stmt[0].text, priority, expression, scope, {0, uint32_t(stmt[0].line)}});
+        return true;
+    }
+    if (stmt.size() == 6 && stmt[4].type == token_t::string && !stmt[4].text.empty() && has_suffix(attribute, PROTOCOL_SUFFIX))
+    {
+        stmts.protocols.push_back({stmt[0].text, attribute.substr(0, attribute.size() - PROTOCOL_SUFFIX.size()), stmt[4].text, scope, {0, uint32_t(stmt[0].line)}});
+        return true;
+    }
+
+    // times are kept as raw text and evaluated with the macros, as symbolic priorities are
+    string_view port;
+    timing_t kind;
+    if (attribute == "execution_time_pre")
+    {
+        kind = timing_t::execution_time;
+    }
+    else if (attribute == "execution_time_post")
+    {
+        kind = timing_t::execution_time_post;
+    }
+    else if (attribute == "period")
+    {
+        kind = timing_t::period;
+    }
+    else if (attribute == "release_time")
+    {
+        kind = timing_t::release_time;
+    }
+    else if (has_suffix(attribute, EXECUTION_TIME_SUFFIX))
+    {
+        port = attribute.substr(0, attribute.size() - EXECUTION_TIME_SUFFIX.size());
+        kind = timing_t::execution_time;
+    }
+    else if (has_suffix(attribute, EXECUTION_TIME_POST_SUFFIX))
+    {
+        port = attribute.substr(0, attribute.size() - EXECUTION_TIME_POST_SUFFIX.size());
+        kind = timing_t::execution_time_post;
+    }
+    else
+    {
+        return false;
+    }
+    const token &last = stmt[stmt.size() - 2];
+    string_view value(stmt[4].text.data(), last.text.data() + last.text.size() - stmt[4].text.data());
+    stmts.timings.push_back({stmt[0].text, port, kind, value, scope, {0, uint32_t(stmt[0].line)}});
+    return true;
+}
+
+// try to recognize: export [Component].[Port] -> [Exported];
+static bool match_export(const vector<token> &stmt, string_view scope, statements &stmts)
+{
+    if (stmt.size() != 8 || !is_identifier(stmt[0], "export") || stmt[1].type != token_t::identifier || !is_punctuation(stmt[2], '.') || stmt[3].type != token_t::identifier || !is_punctuation(stmt[4], '-') || !is_punctuation(stmt[5], '>') || stmt[6].type != token_t::identifier || !is_punctuation(stmt[7], ';'))
+    {
+        return false;
+    }
+    stmts.exports.push_back({stmt[1].text, stmt[3].text, stmt[6].text, scope, {0, uint32_t(stmt[0].line)}});
+    return true;
+}
+
+// try to recognize: import "[File]"; or import <[File]>;
+static bool match_import(const vector<token> &stmt, statements &stmts)
+{
+    if (stmt.size() < 3 || !is_identifier(stmt[0], "import") || !is_punctuation(stmt.back(), ';'))
+    {
+        return false;
+    }
+    if (stmt.size() == 3 && stmt[1].type == token_t::string)
+    {
+        stmts.imports.push_back({stmt[1].text, false, stmts.counts(), {0, uint32_t(stmt[0].line)}});
+        return true;
+    }
+    if (stmt.size() >= 5 && is_punctuation(stmt[1], '<') && is_punctuation(stmt[stmt.size() - 2], '>'))
+    {
+        // the path is the raw text between the brackets, tokens are views into the same buffer
+        const char *first = stmt[2].text.data();
+        const char *last = stmt[stmt.size() - 3].text.data() + stmt[stmt.size() - 3].text.size();
+        stmts.imports.push_back({string_view(first, last - first), true, stmts.counts(), {0, uint32_t(stmt[0].line)}});
+        return true;
+    }
+    return false;
+}
+
+// try to recognize: #include "[File]" or #include <[File]>
+static void match_include(const token &tok, statements &stmts)
+{
+    string_view directive = tok.text;
+    size_t i = directive.find_first_not_of(" \t", 1);
+    if (i == string_view::npos || directive.substr(i, 7) != "include")
+    {
+        return;
+    }
+    i = directive.find_first_not_of(" \t", i + 7);
+    if (i == string_view::npos || (directive[i] != '"' && directive[i] != '<'))
+    {
+        return;
+    }
+    size_t close = directive.find(directive[i] == '"' ? '"' : '>', i + 1);
+    if (close == string_view::npos)
+    {
+        return;
+    }
+    stmts.imports.push_back({directive.substr(i + 1, close - i - 1), directive[i] == '<', stmts.counts(), {0, uint32_t(tok.line)}});
+}
+
+// try to recognize: #define [Macro] [Value]
+static void match_define(const token &tok, statements &stmts)
+{
+    string_view name;
+    string_view value;
+    if (parse_define(tok.text, name, value))
+    {
+        stmts.defines.push_back({name, value, {0, uint32_t(tok.line)}, false});
+    }
+    else if (parse_directive(tok.text, name, value))
+    {
+        stmts.defines.push_back({name, value, {0, uint32_t(tok.line)}, true});
+    }
+}
+
+// the value of a directive from start, up to a trailing comment or the end of the line, without surrounding whitespace
+static string_view directive_value(string_view directive, size_t start)
+{
+    size_t value_end = min(directive.find("//", start), directive.find("/*", start));
+    value_end = min(value_end, directive.size());
+    size_t value_start = directive.find_first_not_of(" \t", start);
+    while (value_end > start && isspace(static_cast<unsigned char>(directive[value_end - 1])))
+    {
+        value_end--;
+    }
+    return value_start < value_end ? directive.substr(value_start, value_end - value_start) : string_view();
+}
+
+bool parse_define(string_view directive, string_view &name, string_view &value)
+{
+    size_t i = directive.find_first_not_of(" \t", 1);
+    if (i == string_view::npos || directive.substr(i, 6) != "define")
+    {
+        return false;
+    }
+    size_t name_start = directive.find_first_not_of(" \t", i + 6);
+    if (name_start == string_view::npos || name_start == i + 6)
+    {
+        return false;
+    }
+    size_t name_end = name_start;
+    while (name_end < directive.size() && (isalnum(static_cast<unsigned char>(directive[name_end])) || directive[name_end] == '_'))
+    {
+        name_end++;
+    }
+    if (name_end == name_start || (name_end < directive.size() && directive[name_end] == '('))
+    {
+        return false;
+    }
+    name = directive.substr(name_start, name_end - name_start);
+    value = directive_value(directive, name_end);
+    return true;
+}
+
+bool parse_directive(string_view directive, string_view &keyword, string_view &argument)
+{
+    static const string_view KEYWORDS[] = {"undef", "if", "ifdef", "ifndef", "elif", "else", "endif"};
+    size_t i = directive.find_first_not_of(" \t", 1);
+    if (i == string_view::npos)
+    {
+        return false;
+    }
+    size_t keyword_end = i;
+    while (keyword_end < directive.size() && isalpha(static_cast<unsigned char>(directive[keyword_end])))
+    {
+        keyword_end++;
+    }
+    keyword = directive.substr(i, keyword_end - i);
+    if (find(begin(KEYWORDS), end(KEYWORDS), keyword) == end(KEYWORDS))
+    {
+        return false;
+    }
+    argument = directive_value(directive, keyword_end);
+    return true;
+}
+
+// a chunk's scope of its own, rather than one of the blocks open at its start
+const uint32_t OWN_SCOPE = UINT32_MAX;
+// chunks are at least this large, smaller buffers are scanned in one piece
+const size_t MIN_CHUNK_BYTES = 1 << 16;
+
+// a block open while scanning, with the scope of the statements within
+struct open_block
+{
+    string_view scope;
+    // if the scope is that of a block open at the start of the chunk, the number of those closed before, else OWN_SCOPE
+    uint32_t inherited;
+};
+
+// the statements from a position on take their scope from the block open at the start of the chunk that inherited says, until the next run
+struct scope_run
+{
+    statement_counts position;
+    uint32_t inherited;
+};
+
+// What scanning a chunk leaves for merging it after the chunks before it, whose blocks are not known to it.
+// Statements at the top level of a chunk are in the blocks still open where it starts: their scope is empty, and the
+// runs say which of those blocks to resolve it to once the chunks before it are merged.
+struct scan_state
+{
+    // the blocks opened within the chunk and still open
+    vector<open_block> blocks;
+    // the number of blocks open at the start of the chunk closed within it
+    uint32_t closed = 0;
+    vector<scope_run> runs;
+    // the last token scanned, the chunk after starts at a statement only if the chunk ends on the semicolon before it
+    const char *last = nullptr;
+    // the number of lines scanned
+    size_t lines = 0;
+};
+
+// scan a buffer as if it started at the top level, or at a statement within the blocks open there
+static void scan_chunk(const char *begin, const char *end, statements &stmts, scan_state &state)
+{
+    lexer lex(begin, end);
+    // reused for every statement, so scanning does not allocate once it has grown
+    vector<token> stmt;
+    state.runs.push_back({stmts.counts(), 0});
+
+    while (true)
+    {
+        token tok = lex.next();
+        if (tok.type == token_t::end)
+        {
+            break;
+        }
+        state.last = tok.text.data();
+        if (tok.type == token_t::directive)
+        {
+            // other directives are handled by the preprocessor
+            match_include(tok, stmts);
+            match_define(tok, stmts);
+            continue;
+        }
+        stmt.push_back(tok);
+
+        // a statement ends at a semicolon or a brace
+        const token &last = stmt.back();
+        if (last.type != token_t::punctuation || (last.text[0] != ';' && last.text[0] != '{' && last.text[0] != '}'))
+        {
+            continue;
+        }
+        open_block current = state.blocks.empty() ? open_block{string_view(), state.closed} : state.blocks.back();
+        if (last.text[0] == '{')
+        {
+            // component [ComponentType] { opens a definition, assembly { and other blocks keep the enclosing scope
+            if (stmt.size() == 3 && is_identifier(stmt[0], "component") && stmt[1].type == token_t::identifier)
+            {
+                current = {stmt[1].text, OWN_SCOPE};
+            }
+            else if (stmt.size() == 2 && is_identifier(stmt[0], "assembly"))
+            {
+                current = {string_view(), OWN_SCOPE};
+            }
+            state.blocks.push_back(current);
+        }
+        else if (!match_component(stmt, current.scope, stmts) && !match_connection(stmt, current.scope, stmts) && !match_assignment(stmt, current.scope, stmts) && !match_export(stmt, current.scope, stmts) && !match_dispatch(stmt, current.scope, stmts))
+        {
+            match_import(stmt, stmts);
+        }
+        if (last.text[0] == '}')
+        {
+            if (!state.blocks.empty())
+            {
+                state.blocks.pop_back();
+            }
+            else
+            {
+                state.closed++;
+            }
+        }
+        if (last.text[0] != ';')
+        {
+            // the statements after a block opens or closes may be in another block open at the start
+            uint32_t inherited = state.blocks.empty() ? state.closed : state.blocks.back().inherited;
+            if (inherited != state.runs.back().inherited)
+            {
+                state.runs.push_back({stmts.counts(), inherited});
+            }
+        }
+        stmt.clear();
+    }
+    state.lines = lex.get_line() - 1;
+}
+
+#ifdef PARSER_STATS
+// count the lines scanned and the statements recognized since a position
+static void count_scanned(const statements &stmts, const statement_counts &before, size_t ports_before, size_t imports_before, size_t lines)
+{
+    statement_counts after = stmts.counts();
+    STATS_ADD(lines_scanned, lines);
+    STATS_ADD(component_matches, after.components - before.components);
+    STATS_ADD(connection_matches, after.connections - before.connections);
+    STATS_ADD(port_matches, stmts.ports.size() - ports_before);
+    STATS_ADD(priority_matches, after.priorities - before.priorities);
+    STATS_ADD(protocol_matches, after.protocols - before.protocols);
+    STATS_ADD(import_matches, stmts.imports.size() - imports_before);
+    STATS_ADD(export_matches, after.exports - before.exports);
+    STATS_ADD(timing_matches, after.timings - before.timings);
+    STATS_ADD(dispatch_matches, after.dispatches - before.dispatches);
+}
+#endif
+
+void scan_statements(const char *begin, const char *end, statements &stmts)
+{
+#ifdef PARSER_STATS
+    statement_counts before = stmts.counts();
+    size_t ports_before = stmts.ports.size();
+    size_t imports_before = stmts.imports.size();
+#endif
+    // at the top level, where statements outside of any block have the empty scope they are scanned with
+    scan_state state;
+    scan_chunk(begin, end, stmts, state);
+#ifdef PARSER_STATS
+    count_scanned(stmts, before, ports_before, imports_before, state.lines + 1);
+#endif
+}
+
+// get the scope of a block open at the start of a chunk, the innermost for 0, or the top level if it was not open
+static string_view inherited_scope(const vector<string_view> &open, uint32_t inherited)
+{
+    return inherited < open.size() ? open[open.size() - 1 - inherited] : string_view();
+}
+
+// where a chunk goes in the statements of the whole buffer
+struct chunk_placement
+{
+    size_t chunk;
+    statement_counts base;
+    size_t ports;
+    size_t lines;
+    // the blocks open at the start of the chunk, innermost last
+    vector<string_view> open;
+};
+
+// copy the statements of a kind of a chunk to theirs in the whole buffer, lines lines further down
+template <typename statement_t>
+static void place(const vector<statement_t> &from, vector<statement_t> &to, size_t base, size_t lines)
+{
+    copy(from.begin(), from.end(), to.begin() + base);
+    for (size_t i = base; i < base + from.size(); i++)
+    {
+        to[i].location.line += lines;
+    }
+}
+
+// set the scope of the statements of a kind [first, last)
+template <typename statement_t>
+static void set_scope(vector<statement_t> &to, size_t first, size_t last, string_view scope)
+{
+    for (size_t i = first; i < last; i++)
+    {
+        to[i].scope = scope;
+    }
+}
+
+// copy the statements of a chunk to where they go in the whole buffer, sized for them already,
+// resolving the scopes the chunk inherits from the blocks open at its start
+static void place_chunk(const statements &chunk, const scan_state &state, const chunk_placement &placement, statements &stmts)
+{
+    const statement_counts &base = placement.base;
+    place(chunk.components, stmts.components, base.components, placement.lines);
+    place(chunk.connections, stmts.connections, base.connections, placement.lines);
+    for (size_t i = base.connections; i < base.connections + chunk.connections.size(); i++)
+    {
+        stmts.connections[i].first_port += placement.ports;
+    }
+    copy(chunk.ports.begin(), chunk.ports.end(), stmts.ports.begin() + placement.ports);
+    place(chunk.priorities, stmts.priorities, base.priorities, placement.lines);
+    place(chunk.protocols, stmts.protocols, base.protocols, placement.lines);
+    place(chunk.defines, stmts.defines, base.defines, placement.lines);
+    place(chunk.exports, stmts.exports, base.exports, placement.lines);
+    place(chunk.timings, stmts.timings, base.timings, placement.lines);
+    place(chunk.dispatches, stmts.dispatches, base.dispatches, placement.lines);
+
+    for (size_t i = 0; i < state.runs.size(); i++)
+    {
+        const scope_run &run = state.runs[i];
+        if (run.inherited == OWN_SCOPE)
+        {
+            continue;
+        }
+        statement_counts last = i + 1 < state.runs.size() ? state.runs[i + 1].position : chunk.counts();
+        string_view scope = inherited_scope(placement.open, run.inherited);
+        set_scope(stmts.components, base.components + run.position.components, base.components + last.components, scope);
+        set_scope(stmts.connections, base.connections + run.position.connections, base.connections + last.connections, scope);
+        set_scope(stmts.priorities, base.priorities + run.position.priorities, base.priorities + last.priorities, scope);
+        set_scope(stmts.protocols, base.protocols + run.position.protocols, base.protocols + last.protocols, scope);
+        set_scope(stmts.exports, base.exports + run.position.exports, base.exports + last.exports, scope);
+        set_scope(stmts.timings, base.timings + run.position.timings, base.timings + last.timings, scope);
+        set_scope(stmts.dispatches, base.dispatches + run.position.dispatches, base.dispatches + last.dispatches, scope);
+    }
+}
+
+void scan_statements(const char *begin, const char *end, statements &stmts, thread_pool &pool, size_t chunks)
+{
+    if (chunks == 0)
+    {
+        chunks = pool.size();
+    }
+    chunks = min(chunks, size_t(end - begin) / MIN_CHUNK_BYTES);
+
+    // split the buffer into chunks of about the same size, each after the first starting after a line ending on a semicolon
+    vector<const char *> starts = {begin};
+    vector<const char *> semicolons = {nullptr};
+    for (size_t i = 1; i < chunks; i++)
+    {
+        const char *cursor = max(begin + (end - begin) * i / chunks, starts.back());
+        const char *newline;
+        while ((newline = static_cast<const char *>(memchr(cursor, '\n', end - cursor))) != nullptr)
+        {
+            cursor = newline + 1;
+            const char *semicolon = newline > begin && newline[-1] == '\r' ? newline - 1 : newline;
+            if (cursor < end && semicolon > begin && semicolon[-1] == ';')
+            {
+                starts.push_back(cursor);
+                semicolons.push_back(semicolon - 1);
+                break;
+            }
+        }
+        if (newline == nullptr)
+        {
+            break;
+        }
+    }
+    if (starts.size() == 1)
+    {
+        scan_statements(begin, end, stmts);
+        return;
+    }
+    starts.push_back(end);
+
+    // scan every chunk into statements of its own, as if it started at a statement
+    size_t count = semicolons.size();
+    vector<statements> scanned(count);
+    vector<scan_state> states(count);
+    pool.parallel_for(count, [&](size_t i) { scan_chunk(starts[i], starts[i + 1], scanned[i], states[i]); });
+
+#ifdef PARSER_STATS
+    statement_counts before = stmts.counts();
+    size_t ports_before = stmts.ports.size();
+    size_t imports_before = stmts.imports.size();
+#endif
+    // place the chunks in order, following the blocks open from one to the next, the first starts at the top level
+    vector<chunk_placement> placements;
+    chunk_placement next_placement{0, stmts.counts(), stmts.ports.size(), 0, {}};
+    for (size_t i = 0; i < count;)
+    {
+        size_t next = i + 1;
+        while (next < count && states[i].last != semicolons[next])
+        {
+            // the next chunk does not start at a statement, as within a comment, so the chunk is scanned again through it,
+            // or through the rest of the buffer if it still does not end on a statement
+            next = next == i + 1 ? next + 1 : count;
+            scanned[i] = statements();
+            states[i] = scan_state();
+            scan_chunk(starts[i], starts[next], scanned[i], states[i]);
+        }
+        const statements &chunk = scanned[i];
+        const scan_state &state = states[i];
+        next_placement.chunk = i;
+        placements.push_back(next_placement);
+
+        // imports are few, and expanded where they are in the statements of the whole buffer
+        const statement_counts &base = next_placement.base;
+        for (import_statement import : chunk.imports)
+        {
+            import.position.components += base.components;
+            import.position.connections += base.connections;
+            import.position.priorities += base.priorities;
+            import.position.protocols += base.protocols;
+            import.position.defines += base.defines;
+            import.position.exports += base.exports;
+            import.position.timings += base.timings;
+            import.position.dispatches += base.dispatches;
+            import.location.line += next_placement.lines;
+            stmts.imports.push_back(import);
+        }
+
+        // the blocks the chunk closed go and those it opened come, extra closing braces at the top level are ignored
+        vector<string_view> &open = next_placement.open;
+        vector<string_view> opened;
+        for (const open_block &block : state.blocks)
+        {
+            opened.push_back(block.inherited == OWN_SCOPE ? block.scope : inherited_scope(open, block.inherited));
+        }
+        open.resize(open.size() - min<size_t>(open.size(), state.closed));
+        open.insert(open.end(), opened.begin(), opened.end());
+        statement_counts counts = chunk.counts();
+        next_placement.base = {base.components + counts.components, base.connections + counts.connections, base.priorities + counts.priorities,
+                               base.protocols + counts.protocols, base.defines + counts.defines, base.exports + counts.exports,
+                               base.timings + counts.timings, base.dispatches + counts.dispatches};
+        next_placement.ports += chunk.ports.size();
+        next_placement.lines += state.lines;
+        i = next;
+    }
+
+    // then copy the chunks into place concurrently
+    const statement_counts &total = next_placement.base;
+    stmts.components.resize(total.components);
+    stmts.connections.resize(total.connections);
+    stmts.ports.resize(next_placement.ports);
+    stmts.priorities.resize(total.priorities);
+    stmts.protocols.resize(total.protocols);
+    stmts.defines.resize(total.defines);
+    stmts.exports.resize(total.exports);
+    stmts.timings.resize(total.timings);
+    stmts.dispatches.resize(total.dispatches);
+    pool.parallel_for(placements.size(), [&](size_t i)
+    {
+        const chunk_placement &placement = placements[i];
+        place_chunk(scanned[placement.chunk], states[placement.chunk], placement, stmts);
+    });
+#ifdef PARSER_STATS
+    count_scanned(stmts, before, ports_before, imports_before, next_placement.lines + 1);
+#endif
+}
+
+// append the statements [first, last) of one kind, locating them in file
+template <typename statement_t>
+static void append_located(const vector<statement_t> &from, size_t first, size_t last, vector<statement_t> &to, uint32_t file)
+{
+    size_t start = to.size();
+    to.insert(to.end(), from.begin() + first, from.begin() + last);
+    for (size_t i = start; i < to.size(); i++)
+    {
+        to[i].location.file = file;
+    }
+}
+
+void append_statements(const statements &from, const statement_counts &first, const statement_counts &last, statements &to, uint32_t file)
+{
+    append_located(from.components, first.components, last.components, to.components, file);
+    for (size_t i = first.connections; i < last.connections; i++)
+    {
+        connection_statement conn = from.connections[i];
+        auto ports = from.ports.begin() + conn.first_port;
+        conn.first_port = to.ports.size();
+        conn.location.file = file;
+        to.ports.insert(to.ports.end(), ports, ports + conn.port_count);
+        to.connections.push_back(conn);
+    }
+    append_located(from.priorities, first.priorities, last.priorities, to.priorities, file);
+    append_located(from.protocols, first.protocols, last.protocols, to.protocols, file);
+    append_located(from.defines, first.defines, last.defines, to.defines, file);
+    append_located(from.exports, first.exports, last.exports, to.exports, file);
+    append_located(from.timings, first.timings, last.timings, to.timings, file);
+    append_located(from.dispatches, first.dispatches, last.dispatches, to.dispatches, file);
+}
+
+// evaluate the argument of rpc([Threads]), UNKNOWN_THREADS if it is empty or not a constant
+static size_t evaluate_threads(string_view threads, macro_table &macros)
+{
+    int64_t value;
+    if (threads.empty() || !macros.evaluate(threads, value) || value < 0)
+    {
+        return UNKNOWN_THREADS;
+    }
+    return value;
+}
+
+// evaluate a symbolic priority, report it and return false if it is not a constant
+static bool evaluate_priority(string_view expression, string_view name, source_location location, macro_table &macros, graph &g, size_t &priority)
+{
+    int64_t value;
+    if (!macros.evaluate(expression, value) || value < 0)
+    {
+        g.diags->report(severity_t::error, "invalid-priority", name, g.get_file(location), location.line, "priority ", expression, " of component ", name, " is not a non-negative constant.");
+        return false;
+    }
+    priority = value;
+    return true;
+}
+
+// evaluate a time, report it and return false if it is not a constant the response time analysis can compute with
+static bool evaluate_time(string_view expression, string_view name, source_location location, macro_table &macros, graph &g, size_t &time)
+{
+    int64_t value;
+    if (!macros.evaluate(expression, value) || value < 0 || size_t(value) >= MAX_TIME)
+    {
+        g.diags->report(severity_t::error, "invalid-time", name, g.get_file(location), location.line, "time ", expression, " of ", name, " is not a non-negative constant below 2^52.");
+        return false;
+    }
+    time = value;
+    return true;
+}
+
+// every macro holds for the whole configuration with its last definition, including the uses before it
+static void report_redefined_macro(string_view name, string_view value, source_location location, graph &g)
+{
+    g.diags->report(severity_t::warning, "macro-redefined", name, g.get_file(location), location.line, "macro ", name, " redefined as ", value, ", which applies to every use, including earlier ones.");
+}
+
+// report a directive that is not followed, once per line
+static void report_ignored_directive(string_view keyword, string_view reason, source_location location, graph &g)
+{
+    string subject = string(g.get_file(location)) + ':' + to_string(location.line);
+    g.diags->report(severity_t::warning, "ignored-directive", subject, g.get_file(location), location.line, "directive #", keyword, " is ignored, ", reason, ".");
+}
+
+// One #if, #ifdef or #ifndef group open in a file, up to its #endif.
+struct conditional_group
+{
+    // whether the group is within branches taken
+    bool enclosing;
+    // whether a branch of the group was taken, and whether the current one is
+    bool taken;
+    bool active;
+    // whether a condition of the group is not a constant, every branch is then parsed
+    bool unknown;
+    source_location location;
+};
+
+// The conditional directives of the files of a configuration, followed in file order as the preprocessor does,
+// each condition evaluated with the macros defined before it.
+// The lines of the branches not taken are collected per file, and the statements on them are left out.
+class conditional_directives
+{
+private:
+    // groups open in each file, innermost last
+    vector<vector<conditional_group>> open;
+    // ranges of lines [first, last) left out in each file, in line order, the last one open while its branch is not taken
+    vector<vector<pair<uint32_t, uint32_t>>> skipped;
+
+    vector<conditional_group> &groups(uint32_t file)
+    {
+        if (file >= open.size())
+        {
+            open.resize(file + 1);
+            skipped.resize(file + 1);
+        }
+        return open[file];
+    }
+
+    // leave out the lines after a directive that closes the branches taken, take them again after one that opens them
+    void switch_lines(uint32_t file, bool was_active, source_location location)
+    {
+        bool now_active = active(file);
+        if (was_active && !now_active)
+        {
+            skipped[file].emplace_back(location.line + 1, UINT32_MAX);
+        }
+        else if (!was_active && now_active)
+        {
+            skipped[file].back().second = location.line;
+        }
+    }
+
+public:
+    // whether the lines of a file at the directive followed last are in branches taken
+    bool active(uint32_t file) const
+    {
+        return file >= open.size() || open[file].empty() || open[file].back().active;
+    }
+
+    // whether any line is left out
+    bool skips_lines() const
+    {
+        return any_of(skipped.begin(), skipped.end(), [](const vector<pair<uint32_t, uint32_t>> &ranges) { return !ranges.empty(); });
+    }
+
+    // whether a statement is on a line left out
+    bool skips(source_location location) const
+    {
+        if (location.file >= skipped.size())
+        {
+            return false;
+        }
+        const vector<pair<uint32_t, uint32_t>> &ranges = skipped[location.file];
+        auto it = upper_bound(ranges.begin(), ranges.end(), location.line, [](uint32_t line, const pair<uint32_t, uint32_t> &range) { return line < range.first; });
+        return it != ranges.begin() && location.line < prev(it)->second;
+    }
+
+    // follow a conditional directive, reporting those that cannot be followed
+    void follow(string_view keyword, string_view argument, source_location location, macro_table &macros, graph &g)
+    {
+        vector<conditional_group> &file_groups = groups(location.file);
+        bool was_active = active(location.file);
+        if (keyword == "if" || keyword == "ifdef" || keyword == "ifndef")
+        {
+            conditional_group group{was_active, false, false, false, location};
+            if (was_active)
+            {
+                int64_t value = 0;
+                bool is_name = !argument.empty() && all_of(argument.begin(), argument.end(), [](char c) { return isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+                if (keyword == "if" ? !macros.evaluate_condition(argument, value) : !is_name)
+                {
+                    report_ignored_directive(keyword, "its condition is not a constant, the statements of every branch are parsed", location, g);
+                    group.unknown = true;
+                }
+                else if (keyword != "if")
+                {
+                    value = macros.is_defined(argument) == (keyword == "ifdef");
+                }
+                group.active = group.unknown || value != 0;
+                group.taken = group.active;
+            }
+            file_groups.push_back(group);
+        }
+        else if (file_groups.empty())
+        {
+            report_ignored_directive(keyword, "no #if is open", location, g);
+            return;
+        }
+        else if (keyword == "elif" || keyword == "else")
+        {
+            conditional_group &group = file_groups.back();
+            if (!group.enclosing || group.unknown)
+            {
+                return;
+            }
+            int64_t value = 1;
+            if (group.taken || (keyword == "elif" && !macros.evaluate_condition(argument, value)))
+            {
+                if (!group.taken)
+                {
+                    report_ignored_directive(keyword, "its condition is not a constant, the statements of the branches from it on are parsed", location, g);
+                    group.unknown = true;
+                }
+                group.active = group.unknown;
+            }
+            else
+            {
+                group.active = value != 0;
+                group.taken = group.active;
+            }
+        }
+        else
+        {
+            file_groups.pop_back();
+        }
+        switch_lines(location.file, was_active, location);
+    }
+
+    // report the groups left open at the end of their files, whose branches run to the end of the file
+    void finish(graph &g)
+    {
+        for (const vector<conditional_group> &file_groups : open)
+        {
+            for (const conditional_group &group : file_groups)
+            {
+                string subject = string(g.get_file(group.location)) + ':' + to_string(group.location.line);
+                g.diags->report(severity_t::warning, "unterminated-conditional", subject, g.get_file(group.location), group.location.line, "conditional directive is not closed by an #endif.");
+            }
+        }
+    }
+};
+
+// follow a directive other than #define: conditional directives choose the lines parsed, #undef is reported
+static void follow_directive(string_view keyword, string_view argument, source_location location, conditional_directives &conditionals, macro_table &macros, graph &g)
+{
+    if (keyword != "undef")
+    {
+        conditionals.follow(keyword, argument, location, macros, g);
+    }
+    else if (conditionals.active(location.file))
+    {
+        report_ignored_directive(keyword, "macros keep their last definition", location, g);
+    }
+}
+
+// the statements not left out by the conditional directives
+template <typename statement_t>
+static void leave_out(vector<statement_t> &stmts, const conditional_directives &conditionals)
+{
+    stmts.erase(remove_if(stmts.begin(), stmts.end(), [&conditionals](const statement_t &stmt) { return conditionals.skips(stmt.location); }), stmts.end());
+}
+
+void build_graph(const statements &parsed, graph &g, logger &log)
+{
+    g.files = parsed.files;
+
+    // the macros of the whole translation unit, each evaluated once however many statements refer to it
+    // the conditional directives are followed in file order, with the macros defined before them
+    macro_table macros;
+    macros.reserve(parsed.defines.size());
+    conditional_directives conditionals;
+    for (const define_statement &stmt : parsed.defines)
+    {
+        if (stmt.directive)
+        {
+            follow_directive(stmt.name, stmt.value, stmt.location, conditionals, macros, g);
+        }
+        else if (conditionals.active(stmt.location.file) && !macros.define(stmt.name, stmt.value))
+        {
+            report_redefined_macro(stmt.name, stmt.value, stmt.location, g);
+        }
+    }
+    conditionals.finish(g);
+
+    // the statements in branches not taken are left out, the statements are only copied if there are any
+    statements kept;
+    if (conditionals.skips_lines())
+    {
+        kept = parsed;
+        leave_out(kept.components, conditionals);
+        leave_out(kept.connections, conditionals);
+        leave_out(kept.priorities, conditionals);
+        leave_out(kept.protocols, conditionals);
+        leave_out(kept.exports, conditionals);
+        leave_out(kept.timings, conditionals);
+        leave_out(kept.dispatches, conditionals);
+    }
+    const statements &stmts = conditionals.skips_lines() ? kept : parsed;
+
+    // every statement is added once for each instance of the composition it is declared in, with its names qualified
+    composition_tree tree(stmts, *g.diags);
+    string name_buffer;
+    string port_buffer;
+
+    // Phase 1: add a component node for each component, a composite component is its composition's components instead.
+    LOG_INFO(log, "Phase 1: Parsing components...");
+    STATS_START(components);
+    for (const component_statement &stmt : stmts.components)
+    {
+        if (tree.is_composite(stmt.type))
+        {
+            continue;
+        }
+        for (uint32_t instance : tree.get_instances(stmt.scope))
+        {
+            string_view name = tree.qualify(instance, stmt.name, name_buffer);
+            g.add_component(name, stmt.location);
+            LOG_DEBUG(log, "Added component node ", name);
+        }
+    }
+
+    STATS_STOP(components);
+
+    // Phase 2: add a connection node for each "to" port, and edges from each "from" component to each connection node.
+    // Ports of composite components are resolved through their exports to the ports of the components within.
+    STATS_START(connections);
+    LOG_INFO(log, "Phase 2: Parsing connections...");
+    for (const connection_statement &stmt : stmts.connections)
+    {
+        size_t declared = evaluate_threads(stmt.threads, macros);
+        for (uint32_t instance : tree.get_instances(stmt.scope))
+        {
+            string_view name = tree.qualify(instance, stmt.name, name_buffer);
+            // the qualified names of the ports, which the lists view
+            list<string> qualified;
+            list<string_view> from_nodes;
+            list<string_view> conn_nodes;
+            for (size_t i = stmt.first_port; i < stmt.first_port + stmt.port_count; i++)
+            {
+                const port_reference &port = stmts.ports[i];
+                string_view component_name = port.component_name;
+                string_view port_name = port.port_name;
+                if (!tree.resolve(instance, component_name, port_name, port_buffer))
+                {
+                    string subject = string(tree.qualify(instance, port.component_name, port_buffer)) + "." + string(port.port_name);
+                    g.diags->report(severity_t::error, "unexported-port", subject, g.get_file(stmt.location), stmt.location.line, "port ", subject, " is not exported by the composition of the component.");
+                    continue;
+                }
+                if (component_name.data() == port_buffer.data())
+                {
+                    qualified.push_back(port_buffer);
+                    component_name = qualified.back();
+                }
+                if (port.from)
+                {
+                    from_nodes.push_back(component_name);
+                    LOG_DEBUG(log, "Parsed from node ", component_name);
+                }
+                else
+                {
+                    string_view identifier = g.get_identifier(g.add_connection(name, component_name, port_name, stmt.threads, declared, stmt.location));
+                    conn_nodes.push_back(identifier);
+                    LOG_DEBUG(log, "Added connection ", name, " (", identifier, ")");
+                    g.add_edge(identifier, component_name);
+                    LOG_DEBUG(log, "Added edge ", identifier, " -> ", component_name);
+                }
+            }
+            for (string_view from_node : from_nodes)
+            {
+                for (string_view conn_node : conn_nodes)
+                {
+                    g.add_edge(from_node, conn_node);
+                    LOG_DEBUG(log, "Added edge ", from_node, " -> ", conn_node);
+                }
+            }
+        }
+    }
+
+    STATS_STOP(connections);
+
+    // Phase 3: set the priority of each component.
+    STATS_START(priorities);
+    LOG_INFO(log, "Phase 3: Parsing priorities...");
+    for (const priority_statement &stmt : stmts.priorities)
+    {
+        for (uint32_t instance : tree.get_instances(stmt.scope))
+        {
+            string_view name = tree.qualify(instance, stmt.name, name_buffer);
+            uint32_t id = g.find(name);
+            if (id == NO_NODE)
+            {
+                g.diags->report(severity_t::error, "unknown-component", name, g.get_file(stmt.location), stmt.location.line, "component ", name, " not found.");
+                continue;
+            }
+            if (g.get_kind(id) != type_t::component)
+            {
+                g.diags->report(severity_t::error, "not-a-component", name, g.get_file(stmt.location), stmt.location.line, "node ", name, " is not a component.");
+                continue;
+            }
+            size_t priority = stmt.priority;
+            if (!stmt.expression.empty() && !evaluate_priority(stmt.expression, name, stmt.location, macros, g, priority))
+            {
+                continue;
+            }
+            g.set_priority(id, priority);
+            LOG_DEBUG(log, "Set priority of ", name, " to ", priority);
+        }
+    }
+
+    STATS_STOP(priorities);
+
+    // Phase 4: set the propagation protocol of each connection.
+    STATS_START(protocols);
+    LOG_INFO(log, "Phase 4: Parsing protocols...");
+    for (const protocol_statement &stmt : stmts.protocols)
+    {
+        for (uint32_t instance : tree.get_instances(stmt.scope))
+        {
+            // the protocol of an exported port is the protocol of the port it exports
+            string_view name = stmt.name;
+            string_view port = stmt.port;
+            if (!tree.resolve(instance, name, port, port_buffer))
+            {
+                string subject = string(tree.qualify(instance, stmt.name, port_buffer)) + "." + string(stmt.port);
+                g.diags->report(severity_t::error, "unexported-port", subject, g.get_file(stmt.location), stmt.location.line, "port ", subject, " is not exported by the composition of the component.");
+                continue;
+            }
+            uint32_t id = g.find(name, port);
+            if (id == NO_NODE)
+            {
+                g.diags->report(severity_t::error, "unknown-connection", string(name) + "." + string(port), g.get_file(stmt.location), stmt.location.line, "connection ", name, " not found.");
+                continue;
+            }
+            if (g.get_kind(id) != type_t::connection)
+            {
+                g.diags->report(severity_t::error, "not-a-connection", string(name) + "." + string(port), g.get_file(stmt.location), stmt.location.line, "node ", name, " is not a connection.");
+                continue;
+            }
+            g.set_protocol(id, stmt.protocol, stmt.location);
+            LOG_DEBUG(log, "Set protocol of ", name, ".", port, " to ", stmt.protocol);
+        }
+    }
+    STATS_STOP(protocols);
+
+    // Phase 4b: set the timing of each task and of the server behind each connection, and release the dispatched tasks.
+    STATS_START(timings);
+    LOG_INFO(log, "Phase 4b: Parsing timings...");
+    for (const timing_statement &stmt : stmts.timings)
+    {
+        for (uint32_t instance : tree.get_instances(stmt.scope))
+        {
+            uint32_t id;
+            string subject;
+            if (stmt.port.empty())
+            {
+                string_view name = tree.qualify(instance, stmt.name, name_buffer);
+                id = g.find(name);
+                if (id == NO_NODE)
+                {
+                    g.diags->report(severity_t::error, "unknown-component", name, g.get_file(stmt.location), stmt.location.line, "component ", name, " not found.");
+                    continue;
+                }
+                if (g.get_kind(id) != type_t::component)
+                {
+                    g.diags->report(severity_t::error, "not-a-component", name, g.get_file(stmt.location), stmt.location.line, "node ", name, " is not a component.");
+                    continue;
+                }
+                subject = name;
+            }
+            else
+            {
+                // the timing of an exported port is the timing of the port it exports
+                string_view name = stmt.name;
+                string_view port = stmt.port;
+                if (!tree.resolve(instance, name, port, port_buffer))
+                {
+                    subject = string(tree.qualify(instance, stmt.name, port_buffer)) + "." + string(stmt.port);
+                    g.diags->report(severity_t::error, "unexported-port", subject, g.get_file(stmt.location), stmt.location.line, "port ", subject, " is not exported by the composition of the component.");
+                    continue;
+                }
+                subject = string(name) + "." + string(port);
+                id = g.find(name, port);
+                if (id == NO_NODE)
+                {
+                    g.diags->report(severity_t::error, "unknown-connection", subject, g.get_file(stmt.location), stmt.location.line, "connection ", name, " not found.");
+                    continue;
+                }
+                if (g.get_kind(id) != type_t::connection)
+                {
+                    g.diags->report(severity_t::error, "not-a-connection", subject, g.get_file(stmt.location), stmt.location.line, "node ", name, " is not a connection.");
+                    continue;
+                }
+            }
+            size_t time;
+            if (!evaluate_time(stmt.value, subject, stmt.location, macros, g, time))
+            {
+                continue;
+            }
+            g.set_timing(id, stmt.kind, time);
+            LOG_DEBUG(log, "Set timing of ", subject, " to ", time);
+        }
+    }
+
+    // tasks without a period of their own are released by the components calling them, as dispatchers do
+    // seL4RPCCall connections are no rpc connections, so a dispatcher that is not found is left alone
+    for (const dispatch_statement &stmt : stmts.dispatches)
+    {
+        for (uint32_t instance : tree.get_instances(stmt.scope))
+        {
+            string_view dispatcher = stmt.dispatcher;
+            string_view dispatcher_port = stmt.dispatcher_port;
+            string_view task = stmt.task;
+            string_view task_port = stmt.task_port;
+            if (!tree.resolve(instance, dispatcher, dispatcher_port, name_buffer) || !tree.resolve(instance, task, task_port, port_buffer))
+            {
+                continue;
+            }
+            uint32_t dispatcher_id = g.find(dispatcher);
+            uint32_t task_id = g.find(task);
+            if (dispatcher_id == NO_NODE || task_id == NO_NODE || g.get_kind(dispatcher_id) != type_t::component || g.get_kind(task_id) != type_t::component)
+            {
+                continue;
+            }
+            g.dispatch(dispatcher_id, task_id);
+            LOG_DEBUG(log, "Released ", task, " by ", dispatcher);
+        }
+    }
+    STATS_STOP(timings);
+}
+
+void parse_regex(istream &input_file, graph &g, logger &log)
+{
+    // parsing helper variables.
+    string line;
+    smatch match;
+    // line of the current pass, statements are located in the input file, the graph's first file
+    uint32_t line_number = 0;
+    // the #define lines, which the macros view
+    list<string> define_lines;
+    macro_table macros;
+    // the lines of the conditional branches not taken are skipped in every pass
+    conditional_directives conditionals;
+
+    /*
+        Phase 1: Parse the components through simple regex.
+        For each
+            component [ComponentType] [Component];
+                        ^- ignored      ^- name
+        in the input file, create a component object and add it to the graph.
+        The macros are collected in the same pass.
+     */
+    STATS_START(components);
+    regex component_regex("component (\\w+) (\\w+);");
+
+    LOG_INFO(log, "Phase 1: Parsing components...");
+
+    // parse the input file line by line
+    while (getline(input_file, line))
+    {
+        STATS_ADD(lines_scanned, 1);
+        line_number++;
+        // #define [Macro] [Value]
+        size_t directive = line.find_first_not_of(" \t");
+        string_view name;
+        string_view value;
+        if (directive != string::npos && line[directive] == '#')
+        {
+            define_lines.push_back(line.substr(directive));
+            if (parse_define(define_lines.back(), name, value))
+            {
+                if (conditionals.active(0) && !macros.define(name, value))
+                {
+                    report_redefined_macro(name, value, {0, line_number}, g);
+                }
+            }
+            else if (parse_directive(define_lines.back(), name, value))
+            {
+                follow_directive(name, value, {0, line_number}, conditionals, macros, g);
+            }
+            continue;
+        }
+        if (!conditionals.active(0))
+        {
+            continue;
+        }
+        // try matching the line with the component regex
+        if (regex_search(line, match, component_regex))
+        {
+            STATS_ADD(component_matches, 1);
+            // create a component object and add it to the graph
+            string name = match[2];
+            g.add_component(name, {0, line_number});
+            LOG_DEBUG(log, "Added component node ", name);
+        }
+    }
+    conditionals.finish(g);
+
+    /*
+        Phase 2: Parse the connections through double regex.
+        For each
+            connection rpc([Threads]) [Connection]([Unparsed]);
+                            ^- threads      ^- name
+        Split unparsed by comma, and for each
+            from/to [Component].[Port]
+                        ^- name     ^- port
+        in the input file, create a connection object and add it to the graph.
+        Then add an edge between each pair of source and destination component to the connection.
+     */
+    STATS_STOP(components);
+    STATS_START(connections);
+    regex connection_regex("connection rpc([^ ]+) (\\w+)\\(([^)]+)\\);");
+    regex port_regex("(from|to) (\\w+).(\\w+)");
+
+    LOG_INFO(log, "Phase 2: Parsing connections...");
+
+    // reset the input file
+    input_file.clear();
+    input_file.seekg(0, ios::beg);
+    line_number = 0;
+
+    // parse the input file line by line
+    while (getline(input_file, line))
+    {
+        STATS_ADD(lines_scanned, 1);
+        line_number++;
+        if (conditionals.skips({0, line_number}))
+        {
+            continue;
+        }
+        // try matching the line with the connection regex
+        if (regex_search(line, match, connection_regex))
+        {
+            STATS_ADD(connection_matches, 1);
+            // create a connection object and add it to the graph
+            string name = match[2];
+            // the thread count argument, without its parentheses
+            string threads = match[1];
+            if (threads.size() >= 2 && threads.front() == '(' && threads.back() == ')')
+            {
+                threads = threads.substr(1, threads.size() - 2);
+            }
+            size_t declared = evaluate_threads(threads, macros);
+            // parse the unparsed part of the connection
+            string unparsed = match[3];
+            // split the unparsed part by comma
+            istringstream unparsed_stream(unparsed);
+            // store the parsed nodes in a list
+            list<string> from_nodes;
+            list<string> conn_nodes;
+            // parse each port
+            while (getline(unparsed_stream, line, ','))
+            {
+                // try matching the unparsed port with the port regex
+                if (regex_search(line, match, port_regex))
+                {
+                    STATS_ADD(port_matches, 1);
+                    // get the name and port of the component
+                    string direction = match[1];
+                    string component_name = match[2];
+                    string port_name = match[3];
+
+                    if (direction == "from")
+                    {
+                        // push the component's name to the from_nodes list
+                        from_nodes.push_back(component_name);
+                        LOG_DEBUG(log, "Parsed from node ", component_name);
+                    }
+                    else if (direction == "to")
+                    {
+                        // create a connection node and add it to the graph
+                        string identifier(g.get_identifier(g.add_connection(name, component_name, port_name, threads, declared, {0, line_number})));
+                        // push the connection node's name to the conn_nodes list
+                        conn_nodes.push_back(identifier);
+                        LOG_DEBUG(log, "Added connection ", name, " (", identifier, ")");
+                        // add an edge from the connection to the component
+                        g.add_edge(identifier, component_name);
+                        LOG_DEBUG(log, "Added edge ", identifier, " -> ", component_name);
+                    }
+                }
+            }
+            // add edges from each from node to each connection node
+            for (string from_node : from_nodes)
+            {
+                for (string conn_node : conn_nodes)
+                {
+                    g.add_edge(from_node, conn_node);
+                    LOG_DEBUG(log, "Added edge ", from_node, " -> ", conn_node);
+                }
+            }
+        }
+    }
+
+    /*
+        Phase 3: Parse the priority.
+        For each
+            [Component]._priority = [Priority];
+            ^- name                     ^- priority, a number or a constant expression of the macros
+        in the input file, set the priority of the component.
+     */
+    STATS_STOP(connections);
+    STATS_START(priorities);
+    regex priority_regex("(\\w+)\\._priority = ([^;]+);");
+
+    LOG_INFO(log, "Phase 3: Parsing priorities...");
+
+    // reset the input file
+    input_file.clear();
+    input_file.seekg(0, ios::beg);
+    line_number = 0;
+
+    // parse the input file line by line
+    while (getline(input_file, line))
+    {
+        STATS_ADD(lines_scanned, 1);
+        line_number++;
+        if (conditionals.skips({0, line_number}))
+        {
+            continue;
+        }
+        // try matching the line with the priority regex
+        if (regex_search(line, match, priority_regex))
+        {
+            STATS_ADD(priority_matches, 1);
+            // get the name and priority of the component
+            string name = match[1];
+            string expression = match[2];
+            size_t priority;
+
+            // set the priority of the component
+            uint32_t id = g.find(name);
+            if (id == NO_NODE)
+            {
+                g.diags->report(severity_t::error, "unknown-component", name, g.get_file({0, line_number}), line_number, "component ", name, " not found.");
+            }
+            else
+            {
+                if (g.get_kind(id) != type_t::component)
+                {
+                    g.diags->report(severity_t::error, "not-a-component", name, g.get_file({0, line_number}), line_number, "node ", name, " is not a component.");
+                }
+                else if (evaluate_priority(expression, name, {0, line_number}, macros, g, priority))
+                {
+                    g.set_priority(id, priority);
+                    LOG_DEBUG(log, "Set priority of ", name, " to ", priority);
+                }
+            }
+        }
+    }
+
+    /*
+        Phase 4: Parse the propagation protocol.
+        For each
+            [Component].[Port]_priority_protocol = "[Protocol]";
+            ^- name     ^- port                     ^- protocol
+        in the input file, set the propagation protocol of the connection.
+     */
+    STATS_STOP(priorities);
+    STATS_START(protocols);
+    regex protocol_regex("(\\w+)\\.(\\w+)_priority_protocol = \"([^\"]+)\";");
+
+    LOG_INFO(log, "Phase 4: Parsing protocols...");
+
+    // reset the input file
+    input_file.clear();
+    input_file.seekg(0, ios::beg);
+    line_number = 0;
+
+    // parse the input file line by line
+    while (getline(input_file, line))
+    {
+        STATS_ADD(lines_scanned, 1);
+        line_number++;
+        if (conditionals.skips({0, line_number}))
+        {
+            continue;
+        }
+        // try matching the line with the protocol regex
+        if (regex_search(line, match, protocol_regex))
+        {
+            STATS_ADD(protocol_matches, 1);
+            // get the name, port and protocol of the connection
+            string name = match[1];
+            string port = match[2];
+            string protocol = match[3];
+
+            // set the propagation protocol of the connection
+            uint32_t id = g.find(name + "." + port);
+            if (id == NO_NODE)
+            {
+                g.diags->report(severity_t::error, "unknown-connection", name + "." + port, g.get_file({0, line_number}), line_number, "connection ", name, " not found.");
+            }
+            else
+            {
+                if (g.get_kind(id) != type_t::connection)
+                {
+                    g.diags->report(severity_t::error, "not-a-connection", name + "." + port, g.get_file({0, line_number}), line_number, "node ", name, " is not a connection.");
+                }
+                else
+                {
+                    g.set_protocol(id, protocol, {0, line_number});
+                    LOG_DEBUG(log, "Set protocol of ", name, ".", port, " to ", protocol);
+                }
+            }
+        }
+    }
+    STATS_STOP(protocols);
+}
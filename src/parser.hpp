@@ -0,0 +1,190 @@
+/*
+ *  parser.hpp
+ *  header file for the statement parser
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "graph.hpp"
+#include "logger.hpp"
+#include "thread_pool.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <istream>
+
+// Statement fields are views into the input buffer, which must outlive them until the graph is built.
+// Each statement keeps the line it starts on, and the file it came from once expanded into statements::files,
+// and the scope it is declared in: the component type whose definition it is in, as in component [ComponentType] { ... },
+// or empty for an assembly and outside of any definition.
+
+// component [ComponentType] [Component];
+struct component_statement
+{
+    std::string_view type;
+    std::string_view name;
+    std::string_view scope;
+    source_location location;
+};
+
+// from/to [Component].[Port]
+struct port_reference
+{
+    bool from;
+    std::string_view component_name;
+    std::string_view port_name;
+};
+
+// connection rpc([Threads]) [Connection]([Ports]);
+struct connection_statement
+{
+    std::string_view name;
+    // the raw argument of rpc(...), may be empty
+    std::string_view threads;
+    // range of the connection's ports in statements::ports
+    size_t first_port;
+    size_t port_count;
+    std::string_view scope;
+    source_location location;
+};
+
+// [Component]._priority = [Priority];
+struct priority_statement
+{
+    std::string_view name;
+    size_t priority;
+    // the raw priority if it is not a literal, such as a macro or an expression, evaluated once the macros are known
+    std::string_view expression;
+    std::string_view scope;
+    source_location location;
+};
+
+// [Component].[Port]_priority_protocol = "[Protocol]";
+struct protocol_statement
+{
+    std::string_view name;
+    std::string_view port;
+    std::string_view protocol;
+    std::string_view scope;
+    source_location location;
+};
+
+// export [Component].[Port] -> [Exported];
+struct export_statement
+{
+    std::string_view component_name;
+    std::string_view port_name;
+    // the port of the defined component type the inner port is exported as
+    std::string_view exported;
+    std::string_view scope;
+    source_location location;
+};
+
+// [Task].execution_time_pre, execution_time_post, period or release_time = [Time];
+// or: [Component].[Port]_execution_time or [Port]_execution_time_post = [Time];
+struct timing_statement
+{
+    std::string_view name;
+    // empty for the timing of a task
+    std::string_view port;
+    timing_t kind;
+    // the raw time, evaluated once the macros are known
+    std::string_view value;
+    std::string_view scope;
+    source_location location;
+};
+
+// connection seL4RPCCall [Connection](from [Dispatcher].[Port], to [Task].[Port]);
+// the task is released by the dispatcher, with the dispatcher's period and release time unless it has its own
+struct dispatch_statement
+{
+    std::string_view dispatcher;
+    std::string_view dispatcher_port;
+    std::string_view task;
+    std::string_view task_port;
+    std::string_view scope;
+    source_location location;
+};
+
+// number of statements of each kind, a position in the statements of a file
+struct statement_counts
+{
+    size_t components = 0;
+    size_t connections = 0;
+    size_t priorities = 0;
+    size_t protocols = 0;
+    size_t defines = 0;
+    size_t exports = 0;
+    size_t timings = 0;
+    size_t dispatches = 0;
+};
+
+// import "[File]"; or import <[File]>; or #include "[File]"
+struct import_statement
+{
+    std::string_view path;
+    // whether the path is in angle brackets, searched only in the include paths
+    bool system;
+    // where the imported statements are expanded
+    statement_counts position;
+    source_location location;
+};
+
+// #define [Macro] [Value], or another directive the macros depend on, #undef [Macro] or a conditional directive
+struct define_statement
+{
+    std::string_view name;
+    std::string_view value;
+    source_location location;
+    // true for #undef or a conditional directive, whose keyword is in name and argument in value
+    bool directive;
+};
+
+// statements recognized in a configuration, grouped by kind in file order
+struct statements
+{
+    std::vector<component_statement> components;
+    std::vector<connection_statement> connections;
+    std::vector<port_reference> ports;
+    std::vector<priority_statement> priorities;
+    std::vector<protocol_statement> protocols;
+    std::vector<import_statement> imports;
+    std::vector<define_statement> defines;
+    std::vector<export_statement> exports;
+    std::vector<timing_statement> timings;
+    std::vector<dispatch_statement> dispatches;
+    // files the statements were expanded from, indexed by their locations
+    std::vector<std::string> files;
+
+    // get the current position
+    statement_counts counts() const { return {components.size(), connections.size(), priorities.size(), protocols.size(), defines.size(), exports.size(), timings.size(), dispatches.size()}; }
+};
+
+// Split a #define directive into the macro name and its value, return false for other directives and function-like macros.
+bool parse_define(std::string_view directive, std::string_view &name, std::string_view &value);
+// Split an #undef or conditional directive into its keyword and argument, return false for other directives.
+// Conditional directives are followed with the macros defined before them, #undef is only reported,
+// as macros hold for the whole configuration.
+bool parse_directive(std::string_view directive, std::string_view &keyword, std::string_view &argument);
+
+// Classify every statement of the buffer in a single pass, tracking the assembly and component blocks they are in.
+void scan_statements(const char *begin, const char *end, statements &stmts);
+
+// Scan the buffer in up to chunks pieces on the pool, one per pool thread for 0, with the same statements as scanning it in one pass.
+// Chunks start after lines ending on a semicolon and are scanned into statements of their own, then merged in order,
+// resolving the scopes of the blocks open where each starts. A chunk that does not end on a statement is scanned again with the rest.
+// The calling thread scans chunks too and runs no unrelated task meanwhile, so files waiting on the statements cannot run above it.
+void scan_statements(const char *begin, const char *end, statements &stmts, thread_pool &pool, size_t chunks);
+
+// Append the statements of each kind between two positions of a file, rebasing the connection ports and locating them in file.
+void append_statements(const statements &from, const statement_counts &first, const statement_counts &last, statements &to, uint32_t file);
+
+// Build the graph from the recognized statements, in the same order as the regex phases.
+// Symbolic priorities and thread counts are evaluated with the macros defined by the statements.
+// Statements on the lines of conditional branches not taken are left out, imports are expanded whatever branch they are in.
+// The compositions of composite components are expanded into their instances, with qualified names, see composition_tree.
+void build_graph(const statements &stmts, graph &g, logger &log);
+
+// Parse the input file through the original four regex passes, kept for comparison.
+void parse_regex(std::istream &input_file, graph &g, logger &log);
@@ -0,0 +1,112 @@
+/*
+ *  perfect_hash.cpp
+ *  source file for the perfect_hash class
+ *  author: jordan sun
+ */
+
+#include "perfect_hash.hpp"
+#include "hash.hpp"
+#include <algorithm>
+
+using namespace std;
+
+// average number of keys per bucket
+const size_t KEYS_PER_BUCKET = 4;
+// give up on a bucket after this many seeds and retry with more slots
+const uint32_t MAX_SEED = 1 << 16;
+// give up on the keys after doubling the slots this many times, distinct keys fit long before
+const size_t MAX_GROWTH = 8;
+
+uint64_t perfect_hash::hash(string_view key, uint64_t seed)
+{
+    return hash_bytes(key, seed);
+}
+
+bool perfect_hash::build(const vector<string_view> &keys)
+{
+    size_t num_buckets = keys.size() / KEYS_PER_BUCKET + 1;
+    size_t num_slots = keys.size() + keys.size() / 4 + 1;
+
+    // group the keys into buckets
+    vector<vector<uint32_t>> buckets(num_buckets);
+    for (uint32_t i = 0; i < keys.size(); i++)
+    {
+        buckets[hash(keys[i], 0) % num_buckets].push_back(i);
+    }
+    // place the largest buckets first, while most slots are free
+    vector<uint32_t> order(num_buckets);
+    for (uint32_t b = 0; b < num_buckets; b++)
+    {
+        order[b] = b;
+    }
+    stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs)
+    {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    // equal keys hash to the same slot whatever the seed, so they are never placed
+    for (size_t growth = 0; growth <= MAX_GROWTH; growth++)
+    {
+        seeds.assign(num_buckets, 0);
+        slots.assign(num_slots, NOT_FOUND);
+        bool placed_all = true;
+        vector<size_t> candidates;
+
+        for (uint32_t b : order)
+        {
+            if (buckets[b].empty())
+            {
+                break;
+            }
+            // find a seed that sends every key of the bucket to a distinct free slot
+            bool placed = false;
+            for (uint32_t seed = 1; seed < MAX_SEED && !placed; seed++)
+            {
+                candidates.clear();
+                placed = true;
+                for (uint32_t key : buckets[b])
+                {
+                    size_t slot = hash(keys[key], seed) % num_slots;
+                    if (slots[slot] != NOT_FOUND || find(candidates.begin(), candidates.end(), slot) != candidates.end())
+                    {
+                        placed = false;
+                        break;
+                    }
+                    candidates.push_back(slot);
+                }
+                if (placed)
+                {
+                    seeds[b] = seed;
+                    for (size_t i = 0; i < candidates.size(); i++)
+                    {
+                        slots[candidates[i]] = buckets[b][i];
+                    }
+                }
+            }
+            if (!placed)
+            {
+                placed_all = false;
+                break;
+            }
+        }
+
+        if (placed_all)
+        {
+            return true;
+        }
+        num_slots *= 2;
+    }
+    seeds.clear();
+    slots.clear();
+    return false;
+}
+
+uint32_t perfect_hash::lookup(string_view key) const
+{
+    if (slots.empty())
+    {
+        return NOT_FOUND;
+    }
+    uint32_t seed = seeds[hash(key, 0) % seeds.size()];
+    return slots[hash(key, seed) % slots.size()];
+}
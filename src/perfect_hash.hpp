@@ -0,0 +1,34 @@
+/*
+ *  perfect_hash.hpp
+ *  header file for the perfect_hash class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+// Read-only minimal-probe index over a fixed set of keys, built with hash and displace.
+// Every key is found with two hashes and one slot read, without collisions.
+class perfect_hash
+{
+private:
+    // displacement seed of each bucket
+    std::vector<uint32_t> seeds;
+    // value stored in each slot, or NOT_FOUND for empty slots
+    std::vector<uint32_t> slots;
+
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    // seeded hash of a key
+    static uint64_t hash(std::string_view key, uint64_t seed);
+
+    // build the index over the keys, the value of keys[i] is i
+    // return false and leave the index empty if it cannot be built, as when the keys are not distinct
+    bool build(const std::vector<std::string_view> &keys);
+    // get the value the key would have, the caller must check the key actually matches
+    uint32_t lookup(std::string_view key) const;
+};
@@ -0,0 +1,317 @@
+/*
+ *  protocol_explorer.cpp
+ *  source file for the protocol_explorer class
+ *  author: jordan sun
+ */
+
+#include "protocol_explorer.hpp"
+#include "diagnostics.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+using namespace std;
+
+// protocols in enumeration order
+static const protocol_t CHOICES[] = {protocol_t::ipcp, protocol_t::pip, protocol_t::propagation};
+// partial assignments visited by a job before they are added to the shared count and the limit is checked
+static const size_t VISIT_BATCH = 1024;
+
+// What one job searches with, reused by the jobs that follow it.
+struct protocol_explorer::search_state
+{
+    // a copy of the graph, whose protocols and summaries are overwritten as connections are assigned
+    frozen_graph graph;
+    diagnostics diags;
+    // ranks of the priorities that can block each task by task index
+    vector<thread_set> blockers;
+    // blockers to put back when backtracking, with the task they belong to
+    vector<pair<uint32_t, thread_set>> undo;
+    vector<protocol_t> assignment;
+    // tasks of a fixed thread set, sorted by rank
+    vector<uint32_t> members;
+    // copy of the shared front to prune with, and the version it was copied at
+    vector<explored_assignment> front;
+    uint64_t front_version = UINT64_MAX;
+    size_t visited = 0;
+};
+
+// Assignments found by all jobs.
+struct protocol_explorer::shared_front
+{
+    mutex front_mutex;
+    vector<explored_assignment> points;
+    // bumped whenever the points change, so jobs only copy them when needed
+    atomic<uint64_t> version{0};
+    atomic<size_t> visited{0};
+    atomic<bool> stopped{false};
+    mutex states_mutex;
+    vector<unique_ptr<search_state>> idle_states;
+};
+
+// check if the point wins over a (partial) assignment scoring at least threads and blocking, whose first protocols are given
+// a point scoring the same wins if its protocols come first
+static bool wins(const explored_assignment &point, size_t threads, size_t blocking, const vector<protocol_t> &assignment, size_t assigned)
+{
+    if (point.threads > threads || point.blocking_levels > blocking)
+    {
+        return false;
+    }
+    if (point.threads < threads || point.blocking_levels < blocking)
+    {
+        return true;
+    }
+    return lexicographical_compare(point.protocols.begin(), point.protocols.begin() + assigned, assignment.begin(), assignment.begin() + assigned);
+}
+
+protocol_explorer::protocol_explorer(const frozen_graph &graph, thread_pool &pool) : graph(graph), pool(pool)
+{
+    // the other nodes are summarized just before the first connection that comes after them
+    vector<bool> reached(graph.size(), false);
+    vector<uint32_t> pending;
+    for (uint32_t id : graph.topological_order())
+    {
+        reached[id] = graph.types[id] == type_t::task;
+        for (uint32_t i = graph.requestor_offsets[id]; i < graph.requestor_offsets[id + 1]; i++)
+        {
+            reached[id] = reached[id] || reached[graph.requestor_ids[i]];
+        }
+        if (graph.types[id] == type_t::connection)
+        {
+            connections.push_back(id);
+            preceding.push_back(move(pending));
+            pending.clear();
+        }
+        else
+        {
+            pending.push_back(id);
+        }
+    }
+
+    // every protocol gives a connection a thread once a task reaches it
+    remaining_threads.assign(connections.size() + 1, 0);
+    for (size_t k = connections.size(); k-- > 0;)
+    {
+        remaining_threads[k] = remaining_threads[k + 1] + reached[connections[k]];
+    }
+
+    // tasks have no requestors, so their priority is their own
+    vector<size_t> levels;
+    for (uint32_t id = 0; id < graph.size(); id++)
+    {
+        if (graph.types[id] == type_t::task)
+        {
+            levels.push_back(graph.assigned_priorities[id]);
+        }
+    }
+    sort(levels.begin(), levels.end());
+    levels.erase(unique(levels.begin(), levels.end()), levels.end());
+    rank_count = levels.size();
+    for (uint32_t id = 0; id < graph.size(); id++)
+    {
+        if (graph.types[id] == type_t::task)
+        {
+            priority_ranks.push_back(lower_bound(levels.begin(), levels.end(), graph.assigned_priorities[id]) - levels.begin());
+        }
+    }
+}
+
+void protocol_explorer::search(search_state &state, shared_front &front, size_t k, const vector<protocol_t> &prefix, size_t threads, size_t blocking) const
+{
+    if (front.stopped.load(memory_order_relaxed))
+    {
+        return;
+    }
+    if (k == connections.size())
+    {
+        // a complete assignment, keep it unless a point wins over it
+        lock_guard<mutex> lock(front.front_mutex);
+        for (const explored_assignment &point : front.points)
+        {
+            if (wins(point, threads, blocking, state.assignment, k))
+            {
+                return;
+            }
+        }
+        front.points.erase(remove_if(front.points.begin(), front.points.end(), [&](const explored_assignment &point)
+        {
+            return point.threads >= threads && point.blocking_levels >= blocking;
+        }), front.points.end());
+        front.points.push_back({threads, blocking, state.assignment});
+        front.version.fetch_add(1, memory_order_release);
+        return;
+    }
+
+    frozen_graph &g = state.graph;
+    for (uint32_t id : preceding[k])
+    {
+        g.summarize(id);
+    }
+    uint32_t id = connections[k];
+    size_t first = 0;
+    size_t last = 3;
+    if (k < prefix.size())
+    {
+        // the job's prefix is fixed
+        first = find(begin(CHOICES), end(CHOICES), prefix[k]) - begin(CHOICES);
+        last = first + 1;
+    }
+    for (size_t choice = first; choice < last; choice++)
+    {
+        if (++state.visited == VISIT_BATCH)
+        {
+            size_t visited = front.visited.fetch_add(state.visited, memory_order_relaxed) + state.visited;
+            state.visited = 0;
+            if (max_visits != 0 && visited >= max_visits)
+            {
+                front.stopped.store(true, memory_order_relaxed);
+                return;
+            }
+        }
+        protocol_t protocol = CHOICES[choice];
+        g.protocols[id] = protocol;
+        state.assignment[k] = protocol;
+        g.summarize(id);
+        size_t count = g.thread_counts[id];
+
+        // the tasks sharing the fixed thread of an ipcp or pip connection can block each other, the lower ones block the higher ones
+        size_t undo_size = state.undo.size();
+        size_t assigned_blocking = blocking;
+        if (protocol != protocol_t::propagation)
+        {
+            const thread_summary &provided = g.summaries[g.provided_summary[id]];
+            state.members.clear();
+            g.fixed_sets[provided.fixed_threads_pool[0]].for_each([&](size_t index)
+            {
+                state.members.push_back(index);
+            });
+            sort(state.members.begin(), state.members.end(), [&](uint32_t lhs, uint32_t rhs)
+            {
+                return priority_ranks[lhs] < priority_ranks[rhs];
+            });
+            thread_set lower(rank_count);
+            for (size_t i = 0; i < state.members.size();)
+            {
+                // tasks of the same rank do not block each other
+                size_t j = i;
+                for (; j < state.members.size() && priority_ranks[state.members[j]] == priority_ranks[state.members[i]]; j++)
+                {
+                    thread_set &blocked = state.blockers[state.members[j]];
+                    if (!lower.is_subset_of(blocked))
+                    {
+                        state.undo.emplace_back(state.members[j], blocked);
+                        blocked |= lower;
+                        assigned_blocking = max(assigned_blocking, blocked.size());
+                    }
+                }
+                lower.insert(priority_ranks[state.members[i]]);
+                i = j;
+            }
+        }
+
+        // the assigned connections are final, the others get at least their lower bound
+        size_t bound = threads + count + remaining_threads[k + 1];
+        if (state.front_version != front.version.load(memory_order_acquire))
+        {
+            lock_guard<mutex> lock(front.front_mutex);
+            state.front = front.points;
+            state.front_version = front.version.load(memory_order_relaxed);
+        }
+        bool pruned = false;
+        for (const explored_assignment &point : state.front)
+        {
+            if (wins(point, bound, assigned_blocking, state.assignment, k + 1))
+            {
+                pruned = true;
+                break;
+            }
+        }
+        if (!pruned)
+        {
+            search(state, front, k + 1, prefix, threads + count, assigned_blocking);
+        }
+
+        while (state.undo.size() > undo_size)
+        {
+            state.blockers[state.undo.back().first] = move(state.undo.back().second);
+            state.undo.pop_back();
+        }
+    }
+}
+
+exploration_result protocol_explorer::explore() const
+{
+    shared_front front;
+
+    // enumerate the first connections into enough jobs to keep the pool busy while some are pruned early
+    size_t split = 0;
+    size_t jobs = 1;
+    while (split < connections.size() && jobs < pool.size() * 8)
+    {
+        split++;
+        jobs *= 3;
+    }
+    vector<task_future<void>> runs;
+    for (size_t job = 0; job < jobs; job++)
+    {
+        vector<protocol_t> prefix(split);
+        size_t code = job;
+        for (size_t i = split; i-- > 0;)
+        {
+            prefix[i] = CHOICES[code % 3];
+            code /= 3;
+        }
+        runs.push_back(pool.submit([this, &front, prefix]()
+        {
+            unique_ptr<search_state> state;
+            {
+                lock_guard<mutex> lock(front.states_mutex);
+                if (!front.idle_states.empty())
+                {
+                    state = move(front.idle_states.back());
+                    front.idle_states.pop_back();
+                }
+            }
+            if (state == nullptr)
+            {
+                state = make_unique<search_state>();
+                state->graph = graph;
+                state->graph.diags = &state->diags;
+                if (!state->graph.threads_valid)
+                {
+                    state->graph.count_threads();
+                }
+                state->blockers.assign(state->graph.tasks.size(), thread_set(rank_count));
+                state->assignment.assign(connections.size(), protocol_t::none);
+            }
+            search(*state, front, 0, prefix, 0, 0);
+            front.visited.fetch_add(state->visited, memory_order_relaxed);
+            state->visited = 0;
+            lock_guard<mutex> lock(front.states_mutex);
+            front.idle_states.push_back(move(state));
+        }));
+    }
+    for (task_future<void> &run : runs)
+    {
+        pool.wait(run);
+    }
+
+    exploration_result result;
+    result.storage = graph.storage;
+    for (uint32_t id : connections)
+    {
+        result.connections.push_back(graph.identifiers[id]);
+    }
+    result.front = move(front.points);
+    sort(result.front.begin(), result.front.end(), [](const explored_assignment &lhs, const explored_assignment &rhs)
+    {
+        return lhs.threads < rhs.threads;
+    });
+    result.visited = front.visited;
+    result.exhaustive = !front.stopped;
+    STATS_ADD(explore_visits, result.visited);
+    return result;
+}
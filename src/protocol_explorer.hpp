@@ -0,0 +1,49 @@
+/*
+ *  protocol_explorer.hpp
+ *  header file for the protocol_explorer class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "frozen_graph.hpp"
+#include "analysis_result.hpp"
+#include "thread_pool.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Searches the fixed, inherited and propagated assignments of every connection for the fewest threads and blocking levels.
+// Connections are assigned in topological order, so the thread count of an assigned connection and the blocking it causes
+// are final once it is assigned, and a partial assignment is pruned as soon as its bounds are beaten by an assignment found.
+// The first connections are enumerated into jobs which run on the pool, each job searching the rest depth first.
+class protocol_explorer
+{
+private:
+    struct search_state;
+    struct shared_front;
+
+    const frozen_graph &graph;
+    thread_pool &pool;
+    // connections in topological order, and the other nodes before each of them, which are summarized before it
+    std::vector<uint32_t> connections;
+    std::vector<std::vector<uint32_t>> preceding;
+    // lower bound on the threads of connections k onwards, 1 for every connection some task reaches
+    std::vector<size_t> remaining_threads;
+    // rank of each task by task index among the distinct task priorities, lowest first
+    std::vector<uint32_t> priority_ranks;
+    size_t rank_count = 0;
+
+    // assign connection k onwards and record the complete assignments, with connection k fixed by the prefix if it is long enough
+    void search(search_state &state, shared_front &front, size_t k, const std::vector<protocol_t> &prefix, size_t threads, size_t blocking) const;
+
+public:
+    // stop after visiting this many partial assignments, 0 for no limit
+    size_t max_visits = 0;
+
+    // the graph must be analysed, and outlive the explorer
+    protocol_explorer(const frozen_graph &graph, thread_pool &pool);
+
+    // search all assignments, or until max_visits
+    exploration_result explore() const;
+};
@@ -0,0 +1,268 @@
+/*
+ *  response_time_analysis.cpp
+ *  source file for the response_time_analysis class
+ *  author: jordan sun
+ */
+
+#include "response_time_analysis.hpp"
+#include <algorithm>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+// 2^52, adding and subtracting it rounds a non-negative double below it to the nearest integer
+static const double ROUND = 4503599627370496.0;
+
+// add the interference of a task, ceil(responses[i] / period) * cost, to next[i] for i in [first, last)
+// the ceiling is exact without calling ceil, so the loop vectorizes: the quotient is rounded to the nearest integer and
+// corrected by one, products of integers below 2^53 being exact, this relies on IEEE arithmetic and breaks with -ffast-math
+// responses past MAX_TIME give wrong ceilings, they belong to tasks that stopped and are ignored
+static void add_interference(const double *responses, double *next, size_t first, size_t last, double period, double cost)
+{
+    for (size_t i = first; i < last; i++)
+    {
+        double jobs = responses[i] / period;
+        jobs = (jobs + ROUND) - ROUND;
+        jobs += jobs * period < responses[i] ? 1.0 : 0.0;
+        jobs -= (jobs - 1.0) * period >= responses[i] ? 1.0 : 0.0;
+        next[i] += jobs * cost;
+    }
+}
+
+vector<double> solve_response_times(const task_set &tasks)
+{
+    size_t n = tasks.periods.size();
+    vector<double> responses(n);
+    // the tasks still iterating, in order, and their response times packed, so the sweeps only go over them
+    // a task is done once its response time is past its period, or the same after a sweep: the next response time of a task
+    // depends on its own and the periods of the others only, so it stays
+    vector<uint32_t> active;
+    vector<double> current;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        responses[i] = tasks.execution_times[i] + tasks.blocking[i];
+        if (responses[i] <= tasks.periods[i])
+        {
+            active.push_back(i);
+            current.push_back(responses[i]);
+        }
+    }
+    // response times only grow from one sweep to the next, and stop at the periods, so the sweeps end
+    vector<double> next;
+    while (!active.empty())
+    {
+        next.resize(active.size());
+        for (size_t k = 0; k < active.size(); k++)
+        {
+            next[k] = tasks.execution_times[active[k]] + tasks.blocking[active[k]];
+        }
+        for (uint32_t j = 0; j < n && tasks.group_starts[j] <= active.back(); j++)
+        {
+            // a task interferes with the tasks of at most its priority, but not with itself
+            size_t first = lower_bound(active.begin(), active.end(), tasks.group_starts[j]) - active.begin();
+            size_t own = lower_bound(active.begin() + first, active.end(), j) - active.begin();
+            add_interference(current.data(), next.data(), first, own, tasks.periods[j], tasks.execution_times[j]);
+            add_interference(current.data(), next.data(), own + (own < active.size() && active[own] == j), active.size(), tasks.periods[j], tasks.execution_times[j]);
+        }
+        size_t kept = 0;
+        for (size_t k = 0; k < active.size(); k++)
+        {
+            uint32_t i = active[k];
+            bool done = next[k] == current[k] || next[k] > tasks.periods[i];
+            responses[i] = next[k];
+            if (!done)
+            {
+                active[kept] = i;
+                current[kept] = next[k];
+                kept++;
+            }
+        }
+        active.resize(kept);
+        current.resize(kept);
+    }
+    return responses;
+}
+
+// the levels a server at its ceiling blocks, and for how long
+struct blocking_range
+{
+    size_t cost;
+    size_t first;
+    size_t last;
+};
+
+// add times, saturating at MAX_TIME so the sums stay exact in doubles
+static size_t add_time(size_t lhs, size_t rhs)
+{
+    return min(lhs + rhs, MAX_TIME);
+}
+
+// a time the configuration may not set, 0 if it does not
+static size_t known_time(size_t time)
+{
+    return time == UNKNOWN_TIME ? 0 : time;
+}
+
+schedulability_result response_time_analysis::analyse(diagnostics &diags) const
+{
+    vector<uint32_t> order = graph.topological_order();
+
+    // the lowest priority of the tasks reaching each node, requestors first
+    vector<size_t> floors(graph.size(), DEFAULT_PRIORITY);
+    for (uint32_t id : order)
+    {
+        if (graph.types[id] == type_t::task)
+        {
+            floors[id] = graph.assigned_priorities[id];
+        }
+        for (uint32_t i = graph.requestor_offsets[id]; i < graph.requestor_offsets[id + 1]; i++)
+        {
+            floors[id] = min(floors[id], floors[graph.requestor_ids[i]]);
+        }
+    }
+
+    // the execution time of each node with the nodes it requests, which come after it
+    vector<size_t> costs(graph.size(), 0);
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+    {
+        uint32_t id = *it;
+        const node_timing &timing = graph.timings[id];
+        size_t cost = add_time(known_time(timing.execution_time), known_time(timing.execution_time_post));
+        for (uint32_t i = graph.dependent_offsets[id]; i < graph.dependent_offsets[id + 1]; i++)
+        {
+            cost = add_time(cost, costs[graph.dependent_ids[i]]);
+        }
+        costs[id] = cost;
+    }
+
+    // the tasks with a period and a priority, by decreasing priority then identifier
+    vector<uint32_t> tasks;
+    for (uint32_t id = 0; id < graph.size(); id++)
+    {
+        if (graph.types[id] != type_t::task)
+        {
+            continue;
+        }
+        const node_timing &timing = graph.timings[id];
+        bool has_period = timing.period != UNKNOWN_TIME && timing.period != 0;
+        if (has_period && graph.assigned_priorities[id] != DEFAULT_PRIORITY)
+        {
+            tasks.push_back(id);
+        }
+        else if (timing.execution_time != UNKNOWN_TIME || timing.execution_time_post != UNKNOWN_TIME)
+        {
+            // dispatchers set a period but no execution time, and are no tasks to analyse
+            diags.report(severity_t::warning, "incomplete-timing", graph.identifiers[id], graph.get_file(id), graph.locations[id].line, "task ", graph.identifiers[id], " has no ", (has_period ? "priority" : "positive period"), ", its response time is not analysed.");
+        }
+    }
+    sort(tasks.begin(), tasks.end(), [&](uint32_t a, uint32_t b)
+    {
+        size_t priority_a = graph.assigned_priorities[a];
+        size_t priority_b = graph.assigned_priorities[b];
+        return priority_a != priority_b ? priority_a > priority_b : graph.identifiers[a] < graph.identifiers[b];
+    });
+
+    // the distinct priorities of the analysed tasks, increasing, which the blocking is computed by
+    vector<size_t> levels;
+    for (uint32_t id : tasks)
+    {
+        levels.push_back(graph.assigned_priorities[id]);
+    }
+    reverse(levels.begin(), levels.end());
+    levels.erase(unique(levels.begin(), levels.end()), levels.end());
+
+    // a task of lower priority in a server whose ceiling is at least the priority of a task can block it, so a server blocks
+    // the levels in [first, last), those above its floor and at most its ceiling
+    // inherited servers add up, as differences between consecutive levels, which wrap around and sum up exactly
+    vector<size_t> inherited(levels.size() + 1, 0);
+    vector<blocking_range> ceiling_servers;
+    for (uint32_t id = 0; id < graph.size(); id++)
+    {
+        if (graph.types[id] != type_t::connection || floors[id] == DEFAULT_PRIORITY)
+        {
+            continue;
+        }
+        size_t first = upper_bound(levels.begin(), levels.end(), floors[id]) - levels.begin();
+        size_t last = upper_bound(levels.begin(), levels.end(), graph.get_priority(id)) - levels.begin();
+        if (first >= last)
+        {
+            continue;
+        }
+        if (graph.protocols[id] == protocol_t::ipcp || graph.protocols[id] == protocol_t::propagation)
+        {
+            ceiling_servers.push_back({costs[id], first, last});
+        }
+        else if (graph.protocols[id] == protocol_t::pip)
+        {
+            inherited[first] += costs[id];
+            inherited[last] -= costs[id];
+        }
+    }
+    for (size_t level = 1; level < levels.size(); level++)
+    {
+        inherited[level] += inherited[level - 1];
+    }
+
+    // servers at their ceiling block for their longest call only, so the longest are laid over the levels first,
+    // each level skipping to the next one not laid over yet
+    vector<size_t> longest(levels.size(), 0);
+    vector<size_t> next_level(levels.size() + 1);
+    for (size_t level = 0; level <= levels.size(); level++)
+    {
+        next_level[level] = level;
+    }
+    auto find_next = [&](size_t level)
+    {
+        size_t root = level;
+        while (next_level[root] != root)
+        {
+            root = next_level[root];
+        }
+        while (next_level[level] != root)
+        {
+            level = exchange(next_level[level], root);
+        }
+        return root;
+    };
+    sort(ceiling_servers.begin(), ceiling_servers.end(), [](const blocking_range &a, const blocking_range &b) { return a.cost > b.cost; });
+    for (const blocking_range &server : ceiling_servers)
+    {
+        for (size_t level = find_next(server.first); level < server.last; level = find_next(level))
+        {
+            longest[level] = server.cost;
+            next_level[level] = level + 1;
+        }
+    }
+
+    task_set set;
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        uint32_t id = tasks[i];
+        size_t priority = graph.assigned_priorities[id];
+        size_t level = lower_bound(levels.begin(), levels.end(), priority) - levels.begin();
+        set.execution_times.push_back(costs[id]);
+        set.blocking.push_back(add_time(longest[level], min(inherited[level], MAX_TIME)));
+        set.periods.push_back(graph.timings[id].period);
+        set.group_starts.push_back(i > 0 && graph.assigned_priorities[tasks[i - 1]] == priority ? set.group_starts[i - 1] : i);
+    }
+    vector<double> responses = solve_response_times(set);
+
+    schedulability_result result;
+    result.storage = graph.storage;
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        uint32_t id = tasks[i];
+        const node_timing &timing = graph.timings[id];
+        // a response time that stopped past the period may be too large for a size_t, it is only known to miss the deadline
+        size_t response = responses[i] < double(MAX_TIME) ? size_t(responses[i]) : MAX_TIME;
+        bool schedulable = responses[i] <= set.periods[i];
+        result.tasks.push_back({graph.identifiers[id], graph.assigned_priorities[id], timing.period, timing.release_time, costs[id], size_t(set.blocking[i]), response, schedulable});
+        if (!schedulable)
+        {
+            result.schedulable = false;
+            diags.report(severity_t::error, "deadline-miss", graph.identifiers[id], graph.get_file(id), graph.locations[id].line, "task ", graph.identifiers[id], " responds in ", (response < MAX_TIME ? to_string(response) : "over 2^52"), ", past its period ", timing.period, ".");
+        }
+    }
+    return result;
+}
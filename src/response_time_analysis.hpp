@@ -0,0 +1,52 @@
+/*
+ *  response_time_analysis.hpp
+ *  header file for the response_time_analysis class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "frozen_graph.hpp"
+#include "analysis_result.hpp"
+#include "diagnostics.hpp"
+#include <vector>
+#include <cstdint>
+
+// Tasks in decreasing priority order, as the response time solver takes them, with their times in doubles.
+struct task_set
+{
+    // worst case execution time of each task, with the servers it calls
+    std::vector<double> execution_times;
+    std::vector<double> blocking;
+    // periods, which are also the deadlines
+    std::vector<double> periods;
+    // index of the first task with the same priority as each task, every task from there on is interfered with by it
+    std::vector<uint32_t> group_starts;
+};
+
+// solve R = C + B + sum of ceil(R / T) * C over the other tasks of at least the same priority, for all tasks at once
+// every sweep reads the response times of the previous one and goes over the tasks whose response time is neither settled nor
+// past their period yet
+// periods must be positive and below MAX_TIME, return the response times, past the period where a task stopped
+std::vector<double> solve_response_times(const task_set &tasks);
+
+// Fixed priority response time analysis of the tasks, with the servers they call run at the priorities propagated to them.
+// The execution time of a task is its own execution_time_pre and execution_time_post, and those of every connection it
+// reaches, each call of a server assumed to make every call the server makes, unset times counting as 0.
+// A task is blocked by the tasks of lower priority through the servers whose ceiling, their propagated priority, is at least
+// its own: for as long as the longest call to a fixed or propagated server, which runs at its ceiling, and for every call to an
+// inherited server, whose threads a task of lower priority can hold until it inherits the priority of the task.
+// Tasks are released together, the critical instant, which bounds the response times whatever their release times are.
+class response_time_analysis
+{
+private:
+    const frozen_graph &graph;
+
+public:
+    // the graph must outlive the analysis
+    response_time_analysis(const frozen_graph &graph) : graph(graph) {}
+
+    // analyse the tasks with a period and a priority, warning about tasks that have an execution time but not both
+    // report every task that can miss its deadline as an error
+    schedulability_result analyse(diagnostics &diags) const;
+};
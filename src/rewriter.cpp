@@ -0,0 +1,178 @@
+/*
+ *  rewriter.cpp
+ *  source file for the configuration rewriter
+ *  author: jordan sun
+ */
+
+#include "rewriter.hpp"
+#include "parser.hpp"
+#include "composition_tree.hpp"
+#include "lexer.hpp"
+#include "mapped_file.hpp"
+#include <unordered_map>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <unistd.h>
+
+using namespace std;
+
+const string_view PRIORITY_SUFFIX = "_priority";
+
+size_t rewrite_configuration(const char *begin, const char *end, const frozen_graph &frozen, string &output)
+{
+    // a macro may be shared by several connections, it has to cover the largest of them
+    unordered_map<string_view, size_t> macro_threads;
+    for (uint32_t id = 0; id < frozen.size(); id++)
+    {
+        if (!frozen.thread_macros[id].empty())
+        {
+            size_t &threads = macro_threads[frozen.thread_macros[id]];
+            threads = max(threads, frozen.get_thread_count(id));
+        }
+    }
+
+    output.clear();
+    output.reserve(end - begin);
+    size_t replaced = 0;
+    // everything before copied has been written to the output
+    const char *copied = begin;
+    auto splice = [&](string_view range, size_t value)
+    {
+        output.append(copied, range.data() - copied);
+        output += to_string(value);
+        copied = range.data() + range.size();
+        replaced++;
+    };
+
+    // the priorities are set in the scopes of the compositions the configuration declares, as the graph was built
+    statements stmts;
+    scan_statements(begin, end, stmts);
+    diagnostics reported;
+    composition_tree tree(stmts, reported);
+    // the scopes of the blocks open, component [ComponentType] { opens a definition as when scanning
+    vector<string_view> scopes;
+    string name_buffer;
+    string identifier;
+
+    lexer lex(begin, end);
+    vector<token> stmt;
+    while (true)
+    {
+        token tok = lex.next();
+        if (tok.type == token_t::end)
+        {
+            break;
+        }
+        if (tok.type == token_t::directive)
+        {
+            // #define [Macro] [Threads]
+            string_view name;
+            string_view value;
+            if (parse_define(tok.text, name, value) && !value.empty())
+            {
+                auto it = macro_threads.find(name);
+                if (it != macro_threads.end())
+                {
+                    splice(value, it->second);
+                }
+            }
+            continue;
+        }
+        stmt.push_back(tok);
+        if (tok.type != token_t::punctuation || (tok.text[0] != ';' && tok.text[0] != '{' && tok.text[0] != '}'))
+        {
+            continue;
+        }
+
+        string_view scope = scopes.empty() ? string_view() : scopes.back();
+        if (tok.text[0] == '{')
+        {
+            if (stmt.size() == 3 && stmt[0].type == token_t::identifier && stmt[0].text == "component" && stmt[1].type == token_t::identifier)
+            {
+                scope = stmt[1].text;
+            }
+            else if (stmt.size() == 2 && stmt[0].type == token_t::identifier && stmt[0].text == "assembly")
+            {
+                scope = string_view();
+            }
+            scopes.push_back(scope);
+        }
+        else if (tok.text[0] == '}')
+        {
+            if (!scopes.empty())
+            {
+                scopes.pop_back();
+            }
+        }
+        // [Component].[Port]_priority = [Priority];
+        else if (stmt.size() == 6 && stmt[0].type == token_t::identifier && stmt[1].type == token_t::punctuation && stmt[1].text[0] == '.' && stmt[2].type == token_t::identifier && stmt[3].type == token_t::punctuation && stmt[3].text[0] == '=' && stmt[4].type == token_t::number)
+        {
+            string_view attribute = stmt[2].text;
+            if (attribute.size() > PRIORITY_SUFFIX.size() && attribute.substr(attribute.size() - PRIORITY_SUFFIX.size()) == PRIORITY_SUFFIX)
+            {
+                // the port is that of every instance of the scope, resolved through the exports, so it has to cover the largest of them
+                bool found = false;
+                size_t priority = 0;
+                for (uint32_t instance : tree.get_instances(scope))
+                {
+                    string_view component = stmt[0].text;
+                    string_view port = attribute.substr(0, attribute.size() - PRIORITY_SUFFIX.size());
+                    if (!tree.resolve(instance, component, port, name_buffer))
+                    {
+                        continue;
+                    }
+                    identifier.assign(component);
+                    identifier += '.';
+                    identifier.append(port);
+                    uint32_t id = frozen.find(identifier);
+                    if (id != NO_NODE && frozen.types[id] == type_t::connection)
+                    {
+                        priority = max(priority, frozen.get_priority(id));
+                        found = true;
+                    }
+                }
+                if (found)
+                {
+                    splice(stmt[4].text, priority + frozen.ladder_flag);
+                }
+            }
+        }
+        stmt.clear();
+    }
+    output.append(copied, end - copied);
+    return replaced;
+}
+
+bool write_if_changed(const string &path, string_view contents, bool &written)
+{
+    written = false;
+    mapped_file existing;
+    if (existing.open(path) && string_view(existing.data(), existing.size()) == contents)
+    {
+        return true;
+    }
+    existing.close();
+
+    // replace the file in one step, the output may also be the input
+    string temporary_path = path + ".tmp" + to_string(getpid());
+    {
+        ofstream output_file(temporary_path, ios::binary | ios::trunc);
+        if (!output_file.is_open() || !output_file.write(contents.data(), contents.size()))
+        {
+            error_code error;
+            filesystem::remove(temporary_path, error);
+            return false;
+        }
+    }
+    error_code error;
+    filesystem::rename(temporary_path, path, error);
+    if (error)
+    {
+        filesystem::remove(temporary_path, error);
+        return false;
+    }
+    written = true;
+    return true;
+}
@@ -0,0 +1,23 @@
+/*
+ *  rewriter.hpp
+ *  header file for the configuration rewriter
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "frozen_graph.hpp"
+#include <string>
+#include <string_view>
+
+// Copy the configuration into output, replacing the values computed by the analyses, return the number of values replaced.
+//     #define [Macro] [Threads]              where [Macro] is passed to rpc(...), the largest thread count of its connections
+//     [Component].[Port]_priority = [Priority];  the propagated priority of the connection, with the ladder flag applied
+// A port is resolved through the compositions the configuration declares, as the graph was built; set within a composite
+// component type, it is the largest priority of the instances of the type.
+// Everything else, including comments and formatting, is copied through unchanged.
+size_t rewrite_configuration(const char *begin, const char *end, const frozen_graph &frozen, std::string &output);
+
+// Write the contents to the file unless it already has exactly these contents, return false if it cannot be written.
+// written is set to whether the file was replaced.
+bool write_if_changed(const std::string &path, std::string_view contents, bool &written);
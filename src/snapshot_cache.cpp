@@ -0,0 +1,494 @@
+/*
+ *  snapshot_cache.cpp
+ *  source file for the snapshot_cache class
+ *  author: jordan sun
+ */
+
+#include "snapshot_cache.hpp"
+#include "mapped_file.hpp"
+#include "hash.hpp"
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+
+using namespace std;
+
+const char SNAPSHOT_MAGIC[8] = {'C', 'A', 'M', 'K', 'S', 'N', 'A', 'P'};
+// bump whenever the layout or the meaning of the snapshot changes
+const uint32_t SNAPSHOT_VERSION = 10;
+const string SNAPSHOT_EXTENSION = ".snapshot";
+// read back in another byte order, the mark no longer matches
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// The host layout of the values written in bulk, recorded after the version so a snapshot is only read by a matching host.
+// Structs are written field by field in fixed widths, only integer and enum arrays are written as they are in memory.
+struct snapshot_layout
+{
+    uint32_t byte_order = BYTE_ORDER_MARK;
+    uint8_t size_width = sizeof(size_t);
+    uint8_t type_width = sizeof(type_t);
+    uint8_t protocol_width = sizeof(protocol_t);
+    uint8_t severity_width = sizeof(severity_t);
+
+    bool operator==(const snapshot_layout &other) const
+    {
+        return byte_order == other.byte_order && size_width == other.size_width && type_width == other.type_width && protocol_width == other.protocol_width && severity_width == other.severity_width;
+    }
+};
+
+// Appends fixed width values, strings and arrays to a snapshot, in host byte order.
+class snapshot_writer
+{
+public:
+    string buffer;
+
+    template <typename T>
+    void put(T value)
+    {
+        buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    void put_string(string_view text)
+    {
+        put<uint32_t>(text.size());
+        buffer.append(text.data(), text.size());
+    }
+
+    template <typename T>
+    void put_array(const vector<T> &array)
+    {
+        put<uint64_t>(array.size());
+        buffer.append(reinterpret_cast<const char *>(array.data()), array.size() * sizeof(T));
+    }
+};
+
+// Reads a snapshot back, every read is bounds checked so a truncated or corrupt snapshot is a miss.
+class snapshot_reader
+{
+private:
+    const char *cursor;
+    const char *end;
+
+public:
+    snapshot_reader(const char *begin, const char *end) : cursor(begin), end(end) {}
+
+    template <typename T>
+    bool get(T &value)
+    {
+        if (size_t(end - cursor) < sizeof(T))
+        {
+            return false;
+        }
+        memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return true;
+    }
+
+    // the string views the snapshot
+    bool get_string(string_view &text)
+    {
+        uint32_t size;
+        if (!get(size) || size_t(end - cursor) < size)
+        {
+            return false;
+        }
+        text = string_view(cursor, size);
+        cursor += size;
+        return true;
+    }
+
+    template <typename T>
+    bool get_array(vector<T> &array)
+    {
+        uint64_t size;
+        if (!get(size) || size_t(end - cursor) / sizeof(T) < size)
+        {
+            return false;
+        }
+        array.resize(size);
+        memcpy(array.data(), cursor, size * sizeof(T));
+        cursor += size * sizeof(T);
+        return true;
+    }
+};
+
+// Everything in a snapshot before the graph.
+struct snapshot_header
+{
+    string_view input_path;
+    vector<string_view> include_paths;
+    string_view output;
+    vector<diagnostic> messages;
+    vector<file_dependency> dependencies;
+    uint64_t node_count;
+};
+
+static bool read_header(snapshot_reader &reader, snapshot_header &header)
+{
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    uint32_t version;
+    if (!reader.get(magic) || memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 || !reader.get(version) || version != SNAPSHOT_VERSION)
+    {
+        return false;
+    }
+    snapshot_layout layout;
+    if (!reader.get(layout.byte_order) || !reader.get(layout.size_width) || !reader.get(layout.type_width) || !reader.get(layout.protocol_width) || !reader.get(layout.severity_width) || !(layout == snapshot_layout()))
+    {
+        return false;
+    }
+    uint32_t include_count;
+    if (!reader.get_string(header.input_path) || !reader.get(include_count))
+    {
+        return false;
+    }
+    header.include_paths.resize(include_count);
+    for (string_view &include_path : header.include_paths)
+    {
+        if (!reader.get_string(include_path))
+        {
+            return false;
+        }
+    }
+    uint32_t message_count;
+    if (!reader.get_string(header.output) || !reader.get(message_count))
+    {
+        return false;
+    }
+    header.messages.resize(message_count);
+    for (diagnostic &message : header.messages)
+    {
+        string_view code, subject, file, text;
+        if (!reader.get(message.severity) || !reader.get_string(code) || !reader.get_string(subject) || !reader.get_string(file) || !reader.get(message.line) || !reader.get_string(text) || message.severity > severity_t::error)
+        {
+            return false;
+        }
+        message.code = code;
+        message.subject = subject;
+        message.file = file;
+        message.message = text;
+    }
+    uint32_t dependency_count;
+    if (!reader.get(dependency_count))
+    {
+        return false;
+    }
+    header.dependencies.resize(dependency_count);
+    for (file_dependency &dependency : header.dependencies)
+    {
+        string_view path;
+        uint8_t exists;
+        if (!reader.get_string(path) || !reader.get(exists) || !reader.get(dependency.hash))
+        {
+            return false;
+        }
+        dependency.path = path;
+        dependency.exists = exists;
+    }
+    return reader.get(header.node_count);
+}
+
+// get the snapshot without its trailing checksum, or nothing if the checksum does not match, as for a corrupt file
+static string_view checked_contents(const mapped_file &mapping)
+{
+    uint64_t checksum;
+    if (mapping.size() < sizeof(checksum))
+    {
+        return string_view();
+    }
+    string_view contents(mapping.data(), mapping.size() - sizeof(checksum));
+    memcpy(&checksum, contents.data() + contents.size(), sizeof(checksum));
+    return hash_bytes(contents) == checksum ? contents : string_view();
+}
+
+// check that a file still has the same contents, or that a missing path is still missing
+static bool is_unchanged(const file_dependency &dependency)
+{
+    error_code error;
+    if (!dependency.exists)
+    {
+        return !filesystem::is_regular_file(dependency.path, error);
+    }
+    mapped_file file;
+    if (!file.open(dependency.path))
+    {
+        return false;
+    }
+    return hash_bytes(string_view(file.data(), file.size())) == dependency.hash;
+}
+
+static string to_hex(uint64_t value)
+{
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(value));
+    return hex;
+}
+
+// get the canonical input path and absolute include paths, so the key does not depend on the working directory
+static string normalize_input(const string &input_path)
+{
+    error_code error;
+    return filesystem::weakly_canonical(input_path, error).string();
+}
+
+static vector<string> normalize_includes(const vector<string> &include_paths)
+{
+    vector<string> normalized;
+    for (const string &include_path : include_paths)
+    {
+        error_code error;
+        normalized.push_back(filesystem::absolute(include_path, error).lexically_normal().string());
+    }
+    return normalized;
+}
+
+snapshot_cache::snapshot_cache(string cache_dir) : cache_dir(move(cache_dir))
+{
+}
+
+string snapshot_cache::entry_path(const string &input_path, const vector<string> &include_paths) const
+{
+    string key = input_path;
+    for (const string &include_path : include_paths)
+    {
+        key += '\0';
+        key += include_path;
+    }
+    return (filesystem::path(cache_dir) / (to_hex(hash_bytes(key)) + SNAPSHOT_EXTENSION)).string();
+}
+
+bool snapshot_cache::load(const string &input_path, const vector<string> &include_paths, frozen_graph &frozen, string &output, vector<diagnostic> &messages) const
+{
+    string input = normalize_input(input_path);
+    vector<string> includes = normalize_includes(include_paths);
+
+    shared_ptr<mapped_file> mapping = make_shared<mapped_file>();
+    if (!mapping->open(entry_path(input, includes)))
+    {
+        return false;
+    }
+    string_view contents = checked_contents(*mapping);
+    snapshot_reader reader(contents.data(), contents.data() + contents.size());
+    snapshot_header header;
+    if (!read_header(reader, header) || header.input_path != input || !equal(header.include_paths.begin(), header.include_paths.end(), includes.begin(), includes.end()))
+    {
+        return false;
+    }
+    for (const file_dependency &dependency : header.dependencies)
+    {
+        if (!is_unchanged(dependency))
+        {
+            return false;
+        }
+    }
+
+    // the graph, in the same layout as frozen_graph
+    uint64_t num_nodes = header.node_count;
+    frozen.identifiers.resize(num_nodes);
+    frozen.names.resize(num_nodes);
+    frozen.thread_macros.resize(num_nodes);
+    for (uint64_t id = 0; id < num_nodes; id++)
+    {
+        if (!reader.get_string(frozen.identifiers[id]) || !reader.get_string(frozen.names[id]) || !reader.get_string(frozen.thread_macros[id]))
+        {
+            return false;
+        }
+    }
+    uint32_t file_count;
+    if (!reader.get(file_count))
+    {
+        return false;
+    }
+    frozen.files.resize(file_count);
+    for (string &file : frozen.files)
+    {
+        string_view path;
+        if (!reader.get_string(path))
+        {
+            return false;
+        }
+        file = path;
+    }
+    if (!reader.get_array(frozen.types) || !reader.get_array(frozen.protocols) || !reader.get_array(frozen.assigned_priorities) || !reader.get_array(frozen.declared_threads))
+    {
+        return false;
+    }
+    frozen.timings.resize(num_nodes);
+    frozen.locations.resize(num_nodes);
+    for (uint64_t id = 0; id < num_nodes; id++)
+    {
+        node_timing &timing = frozen.timings[id];
+        uint64_t execution_time, execution_time_post, period, release_time;
+        if (!reader.get(execution_time) || !reader.get(execution_time_post) || !reader.get(period) || !reader.get(release_time) || !reader.get(frozen.locations[id].file) || !reader.get(frozen.locations[id].line))
+        {
+            return false;
+        }
+        timing.execution_time = execution_time;
+        timing.execution_time_post = execution_time_post;
+        timing.period = period;
+        timing.release_time = release_time;
+    }
+    if (!reader.get_array(frozen.requestor_offsets) || !reader.get_array(frozen.requestor_ids) || !reader.get_array(frozen.dependent_offsets) || !reader.get_array(frozen.dependent_ids))
+    {
+        return false;
+    }
+    // reject adjacency that does not fit the nodes, rather than read out of bounds later
+    if (frozen.types.size() != num_nodes || frozen.protocols.size() != num_nodes || frozen.assigned_priorities.size() != num_nodes || frozen.declared_threads.size() != num_nodes || frozen.requestor_offsets.size() != num_nodes + 1 || frozen.dependent_offsets.size() != num_nodes + 1 || frozen.requestor_offsets.back() != frozen.requestor_ids.size() || frozen.dependent_offsets.back() != frozen.dependent_ids.size() || !is_sorted(frozen.requestor_offsets.begin(), frozen.requestor_offsets.end()) || !is_sorted(frozen.dependent_offsets.begin(), frozen.dependent_offsets.end()) || any_of(frozen.requestor_ids.begin(), frozen.requestor_ids.end(), [&](uint32_t id) { return id >= num_nodes; }) || any_of(frozen.dependent_ids.begin(), frozen.dependent_ids.end(), [&](uint32_t id) { return id >= num_nodes; }))
+    {
+        return false;
+    }
+
+    frozen.storage = mapping;
+    if (!frozen.build_index())
+    {
+        return false;
+    }
+    output = header.output;
+    messages = move(header.messages);
+    return true;
+}
+
+bool snapshot_cache::save(const string &input_path, const vector<string> &include_paths, const frozen_graph &frozen, const vector<file_dependency> &dependencies, string_view output, const vector<diagnostic> &messages) const
+{
+    string input = normalize_input(input_path);
+    vector<string> includes = normalize_includes(include_paths);
+
+    snapshot_writer writer;
+    writer.buffer.append(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writer.put(SNAPSHOT_VERSION);
+    snapshot_layout layout;
+    writer.put(layout.byte_order);
+    writer.put(layout.size_width);
+    writer.put(layout.type_width);
+    writer.put(layout.protocol_width);
+    writer.put(layout.severity_width);
+    writer.put_string(input);
+    writer.put<uint32_t>(includes.size());
+    for (const string &include_path : includes)
+    {
+        writer.put_string(include_path);
+    }
+    writer.put_string(output);
+    writer.put<uint32_t>(messages.size());
+    for (const diagnostic &message : messages)
+    {
+        writer.put(message.severity);
+        writer.put_string(message.code);
+        writer.put_string(message.subject);
+        writer.put_string(message.file);
+        writer.put(message.line);
+        writer.put_string(message.message);
+    }
+    writer.put<uint32_t>(dependencies.size());
+    for (const file_dependency &dependency : dependencies)
+    {
+        writer.put_string(dependency.path);
+        writer.put<uint8_t>(dependency.exists);
+        writer.put(dependency.hash);
+    }
+    writer.put<uint64_t>(frozen.size());
+    for (uint32_t id = 0; id < frozen.size(); id++)
+    {
+        writer.put_string(frozen.identifiers[id]);
+        writer.put_string(frozen.names[id]);
+        writer.put_string(frozen.thread_macros[id]);
+    }
+    writer.put<uint32_t>(frozen.files.size());
+    for (const string &file : frozen.files)
+    {
+        writer.put_string(file);
+    }
+    writer.put_array(frozen.types);
+    writer.put_array(frozen.protocols);
+    writer.put_array(frozen.assigned_priorities);
+    writer.put_array(frozen.declared_threads);
+    for (uint32_t id = 0; id < frozen.size(); id++)
+    {
+        const node_timing &timing = frozen.timings[id];
+        writer.put<uint64_t>(timing.execution_time);
+        writer.put<uint64_t>(timing.execution_time_post);
+        writer.put<uint64_t>(timing.period);
+        writer.put<uint64_t>(timing.release_time);
+        writer.put(frozen.locations[id].file);
+        writer.put(frozen.locations[id].line);
+    }
+    writer.put_array(frozen.requestor_offsets);
+    writer.put_array(frozen.requestor_ids);
+    writer.put_array(frozen.dependent_offsets);
+    writer.put_array(frozen.dependent_ids);
+    // the checksum of everything before it, last
+    writer.put(hash_bytes(writer.buffer));
+
+    // write a temporary file and rename it, so concurrent runs never see a partial snapshot
+    error_code error;
+    filesystem::create_directories(cache_dir, error);
+    string path = entry_path(input, includes);
+    string temporary_path = path + ".tmp" + to_string(getpid());
+    {
+        ofstream snapshot_file(temporary_path, ios::binary | ios::trunc);
+        if (!snapshot_file.is_open() || !snapshot_file.write(writer.buffer.data(), writer.buffer.size()))
+        {
+            filesystem::remove(temporary_path, error);
+            return false;
+        }
+    }
+    filesystem::rename(temporary_path, path, error);
+    if (error)
+    {
+        filesystem::remove(temporary_path, error);
+        return false;
+    }
+    return true;
+}
+
+void snapshot_cache::inspect(ostream &os) const
+{
+    error_code error;
+    vector<filesystem::path> entries;
+    for (const filesystem::directory_entry &entry : filesystem::directory_iterator(cache_dir, error))
+    {
+        if (entry.path().extension() == SNAPSHOT_EXTENSION)
+        {
+            entries.push_back(entry.path());
+        }
+    }
+    sort(entries.begin(), entries.end());
+    os << "cache " << cache_dir << ": " << entries.size() << " snapshots" << endl;
+
+    for (const filesystem::path &entry : entries)
+    {
+        os << "snapshot " << entry.filename().string() << endl;
+        mapped_file mapping;
+        snapshot_header header;
+        if (!mapping.open(entry.string()))
+        {
+            os << "\tstatus: unreadable" << endl;
+            continue;
+        }
+        string_view contents = checked_contents(mapping);
+        snapshot_reader reader(contents.data(), contents.data() + contents.size());
+        if (!read_header(reader, header))
+        {
+            os << "\tstatus: corrupt, or from another version or host layout" << endl;
+            continue;
+        }
+        os << "\tinput: " << header.input_path << endl;
+        for (string_view include_path : header.include_paths)
+        {
+            os << "\tinclude path: " << include_path << endl;
+        }
+        os << "\tsize: " << mapping.size() << " bytes" << endl;
+        os << "\tnodes: " << header.node_count << endl;
+        os << "\tdependencies: " << endl;
+        bool valid = true;
+        for (const file_dependency &dependency : header.dependencies)
+        {
+            bool unchanged = is_unchanged(dependency);
+            valid = valid && unchanged;
+            os << "\t\t" << dependency.path << " " << (dependency.exists ? to_hex(dependency.hash) : "missing") << (unchanged ? "" : " (changed)") << endl;
+        }
+        os << "\tstatus: " << (valid ? "valid" : "stale") << endl;
+    }
+}
@@ -0,0 +1,40 @@
+/*
+ *  snapshot_cache.hpp
+ *  header file for the snapshot_cache class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "frozen_graph.hpp"
+#include "import_resolver.hpp"
+#include "diagnostics.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+
+// On-disk cache of frozen graphs, one binary snapshot per input file and include paths.
+// A snapshot records the files it was built from with their content hashes, and the paths that were searched and missing,
+// it is only used while all of them are unchanged, its checksum matches, and by hosts with the byte order and widths it records.
+// Loaded snapshots stay mapped, the identifiers and names of the graph view the mapping.
+class snapshot_cache
+{
+private:
+    std::string cache_dir;
+
+    // get the snapshot file of an input
+    std::string entry_path(const std::string &input_path, const std::vector<std::string> &include_paths) const;
+
+public:
+    explicit snapshot_cache(std::string cache_dir);
+    ~snapshot_cache() = default;
+
+    // load the snapshot of the input into frozen if it exists and no dependency changed, return false otherwise
+    // output is set to what was printed alongside the graph while the snapshot was built, and messages to what was diagnosed
+    bool load(const std::string &input_path, const std::vector<std::string> &include_paths, frozen_graph &frozen, std::string &output, std::vector<diagnostic> &messages) const;
+    // save the snapshot of the input, replacing the previous one, return false if it cannot be written
+    bool save(const std::string &input_path, const std::vector<std::string> &include_paths, const frozen_graph &frozen, const std::vector<file_dependency> &dependencies, std::string_view output, const std::vector<diagnostic> &messages) const;
+    // print every snapshot in the cache with its dependencies and whether it is still valid
+    void inspect(std::ostream &os) const;
+};
@@ -0,0 +1,55 @@
+/*
+ *  stats.cpp
+ *  source file for the run statistics
+ *  author: jordan sun
+ */
+
+#include "stats.hpp"
+
+#ifdef PARSER_STATS
+
+#include <sys/resource.h>
+
+using namespace std;
+
+const char *const PHASE_NAMES[] = {"expand", "components", "connections", "priorities", "protocols", "timings", "cycles", "freeze", "cache", "propagate", "count_threads", "print", "explore", "rewrite", "response"};
+const char *const COUNTER_NAMES[] = {"lines_scanned", "component_matches", "connection_matches", "port_matches", "priority_matches", "protocol_matches", "import_matches", "export_matches", "timing_matches", "dispatch_matches", "files_scanned", "edges_added", "dfs_searches", "dfs_visits", "get_priority_calls", "get_thread_count_calls", "update_visits", "explore_visits"};
+const char *const PEAK_NAMES[] = {"dfs_visits", "thread_set_size", "fixed_threads_pool"};
+
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == size_t(stat_phase::count), "a phase has no name");
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == size_t(stat_counter::count), "a counter has no name");
+static_assert(sizeof(PEAK_NAMES) / sizeof(PEAK_NAMES[0]) == size_t(stat_peak::count), "a peak has no name");
+
+atomic<uint64_t> stats::phase_nanoseconds[size_t(stat_phase::count)];
+atomic<uint64_t> stats::counters[size_t(stat_counter::count)];
+atomic<uint64_t> stats::peaks[size_t(stat_peak::count)];
+
+void stats::print_json(ostream &os)
+{
+    os << "{" << endl;
+    os << "  \"phases_ms\": {";
+    for (size_t i = 0; i < size_t(stat_phase::count); i++)
+    {
+        os << (i == 0 ? "" : ",") << endl << "    \"" << PHASE_NAMES[i] << "\": " << phase_nanoseconds[i].load() / 1e6;
+    }
+    os << endl << "  }," << endl;
+    os << "  \"counters\": {";
+    for (size_t i = 0; i < size_t(stat_counter::count); i++)
+    {
+        os << (i == 0 ? "" : ",") << endl << "    \"" << COUNTER_NAMES[i] << "\": " << counters[i].load();
+    }
+    os << endl << "  }," << endl;
+    os << "  \"peaks\": {";
+    for (size_t i = 0; i < size_t(stat_peak::count); i++)
+    {
+        os << (i == 0 ? "" : ",") << endl << "    \"" << PEAK_NAMES[i] << "\": " << peaks[i].load();
+    }
+    // ru_maxrss is in kilobytes on linux
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    os << "," << endl << "    \"rss_kb\": " << usage.ru_maxrss;
+    os << endl << "  }" << endl;
+    os << "}" << endl;
+}
+
+#endif
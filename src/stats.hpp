@@ -0,0 +1,135 @@
+/*
+ *  stats.hpp
+ *  header file for the run statistics
+ *  author: jordan sun
+ */
+
+#pragma once
+
+// Statistics are collected only when built with PARSER_STATS, otherwise every macro below compiles to nothing.
+//     STATS_ADD(counter, n)   add n to a counter
+//     STATS_PEAK(peak, n)     raise a peak to n
+//     STATS_START(phase)      start timing a phase in the current scope
+//     STATS_STOP(phase)       add the time since STATS_START to the phase
+//     STATS_SCOPE(phase)      add the time until the end of the current scope to the phase, however the scope is left
+// Counters are process wide relaxed atomics, so parallel runs add up.
+
+#ifdef PARSER_STATS
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <cstdint>
+
+enum class stat_phase
+{
+    expand,
+    components,
+    connections,
+    priorities,
+    protocols,
+    timings,
+    cycles,
+    freeze,
+    cache,
+    propagate,
+    count_threads,
+    print,
+    explore,
+    rewrite,
+    response,
+    count
+};
+
+enum class stat_counter
+{
+    lines_scanned,
+    component_matches,
+    connection_matches,
+    port_matches,
+    priority_matches,
+    protocol_matches,
+    import_matches,
+    export_matches,
+    timing_matches,
+    dispatch_matches,
+    files_scanned,
+    edges_added,
+    dfs_searches,
+    dfs_visits,
+    get_priority_calls,
+    get_thread_count_calls,
+    update_visits,
+    explore_visits,
+    count
+};
+
+enum class stat_peak
+{
+    dfs_visits,
+    thread_set_size,
+    fixed_threads_pool,
+    count
+};
+
+class stats
+{
+private:
+    static std::atomic<uint64_t> phase_nanoseconds[size_t(stat_phase::count)];
+    static std::atomic<uint64_t> counters[size_t(stat_counter::count)];
+    static std::atomic<uint64_t> peaks[size_t(stat_peak::count)];
+
+public:
+    static void add(stat_counter counter, uint64_t n)
+    {
+        counters[size_t(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    static void peak(stat_peak peak, uint64_t n)
+    {
+        uint64_t current = peaks[size_t(peak)].load(std::memory_order_relaxed);
+        while (n > current && !peaks[size_t(peak)].compare_exchange_weak(current, n, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    static void add_time(stat_phase phase, std::chrono::steady_clock::time_point start)
+    {
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+        phase_nanoseconds[size_t(phase)].fetch_add(elapsed.count(), std::memory_order_relaxed);
+    }
+
+    // print everything collected so far as a json object, with the peak resident set size of the process
+    static void print_json(std::ostream &os);
+};
+
+#define STATS_ADD(name, n) stats::add(stat_counter::name, (n))
+#define STATS_PEAK(name, n) stats::peak(stat_peak::name, (n))
+#define STATS_START(name) std::chrono::steady_clock::time_point stats_start_##name = std::chrono::steady_clock::now()
+#define STATS_STOP(name) stats::add_time(stat_phase::name, stats_start_##name)
+
+// Adds the time from its construction to its destruction to a phase, for phases with several ways out.
+class stats_scope
+{
+private:
+    stat_phase phase;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+public:
+    explicit stats_scope(stat_phase phase) : phase(phase) {}
+    ~stats_scope() { stats::add_time(phase, start); }
+    stats_scope(const stats_scope &) = delete;
+    stats_scope &operator=(const stats_scope &) = delete;
+};
+
+#define STATS_SCOPE(name) stats_scope stats_scope_##name(stat_phase::name)
+
+#else
+
+#define STATS_ADD(name, n) ((void)0)
+#define STATS_PEAK(name, n) ((void)0)
+#define STATS_START(name) ((void)0)
+#define STATS_STOP(name) ((void)0)
+#define STATS_SCOPE(name) ((void)0)
+
+#endif
@@ -0,0 +1,50 @@
+/*
+ *  symbol_table.cpp
+ *  source file for the symbol_table class
+ *  author: jordan sun
+ */
+
+#include "symbol_table.hpp"
+
+using namespace std;
+
+uint32_t symbol_table::intern(string_view text)
+{
+    auto it = symbols.find(text);
+    if (it != symbols.end())
+    {
+        return it->second;
+    }
+    // the key views the arena copy, not the caller's buffer
+    string_view stored = storage.copy(text);
+    uint32_t symbol = strings.size();
+    strings.push_back(stored);
+    symbols.emplace(stored, symbol);
+    return symbol;
+}
+
+uint32_t symbol_table::intern(string_view component_name, string_view port_name)
+{
+    scratch.assign(component_name);
+    scratch += '.';
+    scratch += port_name;
+    return intern(string_view(scratch));
+}
+
+uint32_t symbol_table::find(string_view text) const
+{
+    auto it = symbols.find(text);
+    if (it == symbols.end())
+    {
+        return NOT_FOUND;
+    }
+    return it->second;
+}
+
+uint32_t symbol_table::find(string_view component_name, string_view port_name) const
+{
+    scratch.assign(component_name);
+    scratch += '.';
+    scratch += port_name;
+    return find(string_view(scratch));
+}
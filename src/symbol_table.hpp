@@ -0,0 +1,47 @@
+/*
+ *  symbol_table.hpp
+ *  header file for the symbol_table class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "arena.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Interned node names and "component.port" identifiers.
+// Each distinct string is stored once in an arena and named by a dense symbol, views stay valid for the table's lifetime.
+class symbol_table
+{
+private:
+    arena storage;
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, uint32_t> symbols;
+    // reused to join "component.port" identifiers without allocating
+    mutable std::string scratch;
+
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    symbol_table() = default;
+    symbol_table(const symbol_table &) = delete;
+    symbol_table &operator=(const symbol_table &) = delete;
+
+    // intern a string, return its symbol
+    uint32_t intern(std::string_view text);
+    // intern the identifier "component.port", return its symbol
+    uint32_t intern(std::string_view component_name, std::string_view port_name);
+    // find the symbol of a string, return NOT_FOUND if it was never interned
+    uint32_t find(std::string_view text) const;
+    // find the symbol of the identifier "component.port", return NOT_FOUND if it was never interned
+    uint32_t find(std::string_view component_name, std::string_view port_name) const;
+
+    // get the interned string of a symbol
+    std::string_view str(uint32_t symbol) const { return strings[symbol]; }
+    // get the number of symbols
+    uint32_t size() const { return strings.size(); }
+};
@@ -0,0 +1,112 @@
+/*
+ *  thread_pool.cpp
+ *  source file for the thread_pool class
+ *  author: jordan sun
+ */
+
+#include "thread_pool.hpp"
+
+using namespace std;
+
+thread_local thread_pool *thread_pool::current_pool = nullptr;
+thread_local size_t thread_pool::current_index = 0;
+
+thread_pool::thread_pool(size_t num_threads)
+{
+    if (num_threads == 0)
+    {
+        num_threads = max(1u, thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        queues.push_back(make_unique<worker_queue>());
+    }
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        workers.emplace_back(&thread_pool::work, this, i);
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        lock_guard<mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void thread_pool::push(shared_ptr<queued_task> task)
+{
+    size_t index = current_pool == this ? current_index : next_queue++ % queues.size();
+    {
+        lock_guard<mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(move(task));
+    }
+    pending++;
+    // taking the lock orders the notification after a sleeping worker checked pending
+    {
+        lock_guard<mutex> lock(sleep_mutex);
+    }
+    ready.notify_one();
+}
+
+bool thread_pool::run_pending_task()
+{
+    bool own = current_pool == this;
+    size_t start = own ? current_index : 0;
+    for (size_t i = 0; i < queues.size(); i++)
+    {
+        worker_queue &queue = *queues[(start + i) % queues.size()];
+        shared_ptr<queued_task> task;
+        {
+            lock_guard<mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+            {
+                continue;
+            }
+            if (own && i == 0)
+            {
+                // newest first from the own queue, its data is still warm
+                task = move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                // oldest first when stealing, usually the largest piece of work left
+                task = move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+        pending--;
+        task->run();
+        return true;
+    }
+    return false;
+}
+
+void thread_pool::work(size_t index)
+{
+    current_pool = this;
+    current_index = index;
+    while (true)
+    {
+        if (run_pending_task())
+        {
+            continue;
+        }
+        unique_lock<mutex> lock(sleep_mutex);
+        ready.wait(lock, [this]()
+        {
+            return stopping || pending > 0;
+        });
+        if (stopping && pending == 0)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,165 @@
+/*
+ *  thread_pool.hpp
+ *  header file for the thread_pool class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <atomic>
+
+// A queued function, run once by whichever thread takes it first, a worker or a thread waiting on it.
+struct queued_task
+{
+    std::atomic<bool> started{false};
+    std::function<void()> function;
+
+    explicit queued_task(std::function<void()> function) : function(std::move(function)) {}
+
+    // run the function unless another thread started it, return false if one did
+    bool run()
+    {
+        if (started.exchange(true))
+        {
+            return false;
+        }
+        function();
+        // release what the function holds, the queue may keep the task a while longer
+        function = nullptr;
+        return true;
+    }
+};
+
+// The result of a task submitted to a thread_pool, waited on through thread_pool::wait.
+template <typename result_t>
+class task_future
+{
+private:
+    std::shared_ptr<queued_task> task;
+    std::shared_future<result_t> result;
+
+    friend class thread_pool;
+
+public:
+    task_future() = default;
+
+    // get the result once the task has run, rethrowing what it threw
+    decltype(auto) get() const { return result.get(); }
+};
+
+// Work-stealing pool of worker threads.
+// Each worker has its own queue, tasks submitted by a worker go to its own queue and run newest first,
+// idle workers steal the oldest task of another queue. Tasks may wait on the tasks they submitted through wait,
+// which runs the awaited task on the waiting thread if no worker has started it, so nested submissions cannot starve the pool.
+class thread_pool
+{
+private:
+    struct worker_queue
+    {
+        std::mutex mutex;
+        // tasks already started by a thread waiting on them are skipped when taken
+        std::deque<std::shared_ptr<queued_task>> tasks;
+    };
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> workers;
+    // number of queued tasks, idle workers sleep while it is 0
+    std::atomic<size_t> pending{0};
+    // queue of the next task submitted from outside the pool
+    std::atomic<size_t> next_queue{0};
+    std::mutex sleep_mutex;
+    std::condition_variable ready;
+    bool stopping = false;
+
+    // the pool and queue of the worker running on this thread, if any
+    static thread_local thread_pool *current_pool;
+    static thread_local size_t current_index;
+
+    // queue a task on the current worker's queue, or round robin from outside the pool
+    void push(std::shared_ptr<queued_task> task);
+    // take one queued task, own queue first, and run it unless it was started already, return false if there was none
+    bool run_pending_task();
+    // run tasks until the pool is stopped
+    void work(size_t index);
+
+public:
+    // start the workers, 0 uses one per hardware thread
+    explicit thread_pool(size_t num_threads = 0);
+    // finish the queued tasks and join the workers
+    ~thread_pool();
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    // get the number of workers
+    size_t size() const { return workers.size(); }
+
+    // queue a task, return a future for its result
+    template <typename function_t>
+    auto submit(function_t function) -> task_future<decltype(function())>
+    {
+        typedef decltype(function()) result_t;
+        auto packaged = std::make_shared<std::packaged_task<result_t()>>(std::move(function));
+        task_future<result_t> future;
+        future.result = packaged->get_future().share();
+        future.task = std::make_shared<queued_task>([packaged]() { (*packaged)(); });
+        push(future.task);
+        return future;
+    }
+
+    // wait until a task has run, running it on the calling thread if no worker has started it yet
+    // no other task runs on the calling thread meanwhile, a task running elsewhere is waited for until it finishes
+    template <typename result_t>
+    void wait(const task_future<result_t> &future)
+    {
+        future.task->run();
+        future.result.wait();
+    }
+
+    // run function(i) for every i in [0, count), on the calling thread and on idle workers
+    // like wait, the calling thread runs no other queued task meanwhile, so it may hold results other tasks wait for,
+    // it only blocks on calls already running on workers, and function must not wait on other tasks
+    template <typename function_t>
+    void parallel_for(size_t count, const function_t &function)
+    {
+        struct loop_state
+        {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> done{0};
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        // helpers that start after every index is claimed return without touching function, which may be gone by then
+        auto state = std::make_shared<loop_state>();
+        auto run = [state, count, &function]()
+        {
+            for (size_t i = state->next++; i < count; i = state->next++)
+            {
+                function(i);
+                if (++state->done == count)
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->finished.notify_all();
+                }
+            }
+        };
+        for (size_t i = 1; i < count && i <= workers.size(); i++)
+        {
+            push(std::make_shared<queued_task>(run));
+        }
+        run();
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&]()
+        {
+            return state->done == count;
+        });
+    }
+};
@@ -0,0 +1,124 @@
+/*
+ *  thread_set.hpp
+ *  header file for the thread_set class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Dense bitset of task indices.
+// All sets of one graph have the same width, so unions and subset checks are plain word loops.
+class thread_set
+{
+private:
+    std::vector<uint64_t> words;
+
+public:
+    thread_set() = default;
+    explicit thread_set(size_t width) : words((width + 63) / 64, 0) {}
+
+    // empty the set and give it a new width, keeping its storage
+    void reset(size_t width)
+    {
+        words.assign((width + 63) / 64, 0);
+    }
+
+    // add the task to the set
+    void insert(size_t index)
+    {
+        words[index >> 6] |= uint64_t(1) << (index & 63);
+    }
+
+    // check if the task is in the set
+    bool contains(size_t index) const
+    {
+        return (words[index >> 6] >> (index & 63)) & 1;
+    }
+
+    // add all tasks of the other set to this set
+    thread_set &operator|=(const thread_set &other)
+    {
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+
+    // check if every task of this set is in the other set
+    bool is_subset_of(const thread_set &other) const
+    {
+        uint64_t missing = 0;
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            missing |= words[i] & ~other.words[i];
+        }
+        return missing == 0;
+    }
+
+    // get the number of tasks in the set
+    size_t size() const
+    {
+        size_t count = 0;
+        for (uint64_t word : words)
+        {
+            count += __builtin_popcountll(word);
+        }
+        return count;
+    }
+
+    bool empty() const
+    {
+        for (uint64_t word : words)
+        {
+            if (word != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // call the function with each task index in ascending order
+    template <typename function_t>
+    void for_each(function_t function) const
+    {
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            uint64_t word = words[i];
+            while (word != 0)
+            {
+                function(i * 64 + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    bool operator==(const thread_set &other) const
+    {
+        return words == other.words;
+    }
+
+    size_t hash() const
+    {
+        // fnv-1a over the words
+        uint64_t hash = 14695981039346656037ull;
+        for (uint64_t word : words)
+        {
+            hash = (hash ^ word) * 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+struct thread_set_hash
+{
+    size_t operator()(const thread_set &set) const
+    {
+        return set.hash();
+    }
+};
@@ -0,0 +1,83 @@
+/*
+ *  what_if_engine.cpp
+ *  source file for the what_if_engine class
+ *  author: jordan sun
+ */
+
+#include "what_if_engine.hpp"
+#include <utility>
+#include <algorithm>
+
+using namespace std;
+
+what_if_engine::what_if_engine(const frozen_graph &analysed, bool trace) : graph(analysed), trace(trace)
+{
+    graph.diags = &diags;
+    // computes everything if the graph was not analysed yet
+    graph.update({});
+}
+
+analysis_result what_if_engine::apply(const vector<what_if_edit> &edits)
+{
+    vector<uint32_t> edited;
+    // protocols of the edited connections before the batch, a connection edited back to its protocol is unchanged
+    vector<pair<uint32_t, protocol_t>> original_protocols;
+    for (const what_if_edit &edit : edits)
+    {
+        uint32_t id = graph.find(edit.identifier);
+        if (edit.kind == edit_kind::priority)
+        {
+            if (id == NO_NODE)
+            {
+                diags.report(severity_t::error, "unknown-component", edit.identifier, "", 0, "component ", edit.identifier, " not found.");
+                continue;
+            }
+            if (graph.types[id] == type_t::connection)
+            {
+                diags.report(severity_t::error, "not-a-component", edit.identifier, "", 0, "node ", edit.identifier, " is not a component.");
+                continue;
+            }
+            graph.assigned_priorities[id] = edit.priority;
+        }
+        else
+        {
+            if (id == NO_NODE)
+            {
+                diags.report(severity_t::error, "unknown-connection", edit.identifier, "", 0, "connection ", edit.identifier, " not found.");
+                continue;
+            }
+            if (graph.types[id] != type_t::connection)
+            {
+                diags.report(severity_t::error, "not-a-connection", edit.identifier, "", 0, "node ", edit.identifier, " is not a connection.");
+                continue;
+            }
+            protocol_t protocol;
+            if (!parse_protocol(edit.protocol, protocol))
+            {
+                diags.report(severity_t::error, "unknown-protocol", edit.identifier, "", 0, "unknown protocol ", edit.protocol, " for ", edit.identifier, ".");
+                continue;
+            }
+            original_protocols.emplace_back(id, graph.protocols[id]);
+            graph.protocols[id] = protocol;
+        }
+        edited.push_back(id);
+    }
+
+    // recompute what is downstream of the edits, once for the whole batch
+    vector<uint32_t> changed = graph.update(edited);
+    // connections whose protocol changed are reported even if their counts did not
+    // the first protocol recorded for a connection is the one it had before the batch
+    stable_sort(original_protocols.begin(), original_protocols.end(), [](const pair<uint32_t, protocol_t> &lhs, const pair<uint32_t, protocol_t> &rhs) { return lhs.first < rhs.first; });
+    for (size_t i = 0; i < original_protocols.size(); i++)
+    {
+        uint32_t id = original_protocols[i].first;
+        bool first = i == 0 || original_protocols[i - 1].first != id;
+        if (first && graph.protocols[id] != original_protocols[i].second)
+        {
+            changed.push_back(id);
+        }
+    }
+    sort(changed.begin(), changed.end());
+    changed.erase(unique(changed.begin(), changed.end()), changed.end());
+    return graph.analyse(move(changed), trace);
+}
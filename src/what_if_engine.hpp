@@ -0,0 +1,66 @@
+/*
+ *  what_if_engine.hpp
+ *  header file for the what_if_engine class
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include "frozen_graph.hpp"
+#include "analysis_result.hpp"
+#include "diagnostics.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+enum class edit_kind
+{
+    priority,
+    protocol
+};
+
+// One change to a configuration, as it would be written in it.
+//     [Component]._priority = [Priority];
+//     [Component].[Port]_priority_protocol = "[Protocol]";
+struct what_if_edit
+{
+    edit_kind kind;
+    // the component for a priority, "component.port" for a protocol
+    std::string identifier;
+    size_t priority = 0;
+    // fixed, inherited or propagated
+    std::string protocol;
+
+    static what_if_edit set_priority(std::string_view component, size_t priority) { return {edit_kind::priority, std::string(component), priority, ""}; }
+    static what_if_edit set_protocol(std::string_view connection, std::string_view protocol) { return {edit_kind::protocol, std::string(connection), 0, std::string(protocol)}; }
+};
+
+// Tries out priority and protocol changes on an analysed graph without parsing it again.
+// Each batch of edits marks the edited nodes dirty, and only the nodes downstream of them are recomputed.
+class what_if_engine
+{
+private:
+    // a copy of the analysed graph, the edits accumulate in it
+    frozen_graph graph;
+    // fill in the threads behind each thread count
+    bool trace;
+
+public:
+    // edits that cannot be applied, and anything the analyses find after an edit, such as a component reached through several ports
+    diagnostics diags;
+
+    explicit what_if_engine(const frozen_graph &analysed, bool trace = false);
+    ~what_if_engine() = default;
+    what_if_engine(const what_if_engine &) = delete;
+    what_if_engine &operator=(const what_if_engine &) = delete;
+
+    // apply the edits in order, then recompute once
+    // return the results of the nodes whose priority, thread count or protocol changed, sorted by identifier
+    // edits to unknown nodes, to nodes of the wrong kind, or to unknown protocols are reported and skipped
+    analysis_result apply(const std::vector<what_if_edit> &edits);
+    // get the results of every node with the edits applied so far
+    analysis_result results() const { return graph.analyse(trace); }
+    // get the graph with the edits applied so far, to rewrite the configuration with
+    const frozen_graph &get_graph() const { return graph; }
+};
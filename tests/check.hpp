@@ -0,0 +1,24 @@
+/*
+ *  check.hpp
+ *  header file for the checks of the behaviour tests
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <iostream>
+
+// number of checks that failed, a test exits with 1 if any did
+inline int failures = 0;
+
+// report a failed check with where it is and what it checked
+inline void check(bool passed, const char *condition, const char *file, int line)
+{
+    if (!passed)
+    {
+        std::cerr << file << ":" << line << ": check failed: " << condition << std::endl;
+        failures++;
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
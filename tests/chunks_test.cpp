@@ -0,0 +1,109 @@
+/*
+ *  chunks_test.cpp
+ *  behaviour tests of scanning files in chunks
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include "emitter.hpp"
+#include "workload.hpp"
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+
+using namespace std;
+
+// the graph with the threads behind each count, the diagnostics and the rejected edges, as the command line prints them
+static string printed(const parse_result &result)
+{
+    ostringstream output;
+    CHECK(result.parsed);
+    if (result.parsed)
+    {
+        emit(result.analysis, output_format::text, true, output);
+        result.diags.print(output);
+        output << result.cycles;
+    }
+    return output.str();
+}
+
+// parse a configuration scanned in the given number of chunks
+static string parse_in_chunks(const camkes_parser &parser, const string &contents, size_t chunks)
+{
+    parse_options options;
+    options.chunks = chunks;
+    options.trace = true;
+    return printed(parser.parse_buffer(contents, "chunks_test.camkes", options));
+}
+
+// the configuration scanned in chunks prints the same as scanned in one pass, whichever statements the chunks start on
+static void check_chunks(const camkes_parser &parser, const string &contents, const string &name)
+{
+    string whole = parse_in_chunks(parser, contents, 1);
+    for (size_t chunks : {2, 3, 4, 7, 16, 0})
+    {
+        string chunked = parse_in_chunks(parser, contents, chunks);
+        if (chunked != whole)
+        {
+            cerr << name << ": scanning in " << chunks << " chunks changes the output" << endl;
+        }
+        CHECK(chunked == whole);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        cerr << "Usage: " << argv[0] << " <test files directory>" << endl;
+        return 1;
+    }
+    camkes_parser parser(4);
+
+    // a generated workload of about 150 KiB, which is split into chunks
+    string workload = generate_workload(workload_shape());
+    CHECK(workload.size() > 64 * 1024);
+    check_chunks(parser, workload, "workload");
+
+    // statements commented out before the configuration, over many chunk boundaries, are skipped as in one pass
+    string commented = workload;
+    string hidden = "/*\n";
+    for (size_t i = 0; i < 2000; i++)
+    {
+        hidden += "\t\tcomponent Task hidden_" + to_string(i) + ";\n";
+        hidden += "// \t\thidden_" + to_string(i) + "._priority = 1;\n";
+    }
+    hidden += "*/\n";
+    size_t configuration = commented.find("\tconfiguration {");
+    CHECK(configuration != string::npos);
+    commented.insert(configuration, hidden);
+    check_chunks(parser, commented, "commented workload");
+    CHECK(printed(parser.parse_buffer(commented, "chunks_test.camkes", parse_options())).find("hidden_") == string::npos);
+
+    // many large imports scanned in chunks on a small pool at once, the files waiting on each other's chunks must not stall
+    string directory = "chunks_test_imports";
+    filesystem::remove_all(directory);
+    filesystem::create_directory(directory);
+    string main_file;
+    for (size_t i = 0; i < 24; i++)
+    {
+        string import = "import_" + to_string(i) + ".camkes";
+        ofstream(filesystem::path(directory) / import) << workload;
+        main_file += "import \"" + import + "\";\n";
+    }
+    ofstream(filesystem::path(directory) / "main.camkes") << main_file;
+    camkes_parser small_parser(3);
+    parse_options options;
+    options.trace = true;
+    string whole = printed(small_parser.parse_file((filesystem::path(directory) / "main.camkes").string(), options));
+    options.chunks = 0;
+    for (size_t run = 0; run < 10; run++)
+    {
+        CHECK(printed(small_parser.parse_file((filesystem::path(directory) / "main.camkes").string(), options)) == whole);
+    }
+    filesystem::remove_all(directory);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/*
+ *  composition_test.cpp
+ *  behaviour tests of expanding composite components into their compositions
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include <string>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+// the analysed node of an identifier, null if there is none
+static const node_result *find_node(const parse_result &result, string_view identifier)
+{
+    for (const node_result &node : result.analysis.nodes)
+    {
+        if (node.identifier == identifier)
+        {
+            return &node;
+        }
+    }
+    return nullptr;
+}
+
+static vector<string> identifiers(const parse_result &result)
+{
+    vector<string> found;
+    for (const node_result &node : result.analysis.nodes)
+    {
+        found.push_back(string(node.identifier));
+    }
+    return found;
+}
+
+// the codes and subjects of the diagnostics, in the order they were reported
+static vector<pair<string, string>> reported(const parse_result &result)
+{
+    vector<pair<string, string>> found;
+    for (const diagnostic &entry : result.diags.get_entries())
+    {
+        found.push_back({entry.code, entry.subject});
+    }
+    return found;
+}
+
+const char *const NESTED = R"(component Inner {
+    composition {
+        component Task worker;
+        component Server store;
+        connection rpc() inner_c(from worker.r, to store.p);
+        export store.p -> p;
+    }
+    configuration {
+        worker._priority = 5;
+        store.p_priority_protocol = "propagated";
+    }
+}
+component Outer {
+    composition {
+        component Inner front;
+        component Inner back;
+        export front.p -> front_p;
+    }
+}
+assembly {
+    composition {
+        component Task t;
+        component Outer o;
+        connection rpc() c(from t.r, to o.front_p);
+    }
+    configuration {
+        t._priority = 9;
+    }
+}
+)";
+
+const char *const FAULTY = R"(component Inner {
+    composition {
+        component Server store;
+    }
+}
+component Loop {
+    composition {
+        component Loop inner;
+        component Task x;
+    }
+}
+component Ping {
+    composition {
+        component Pong pong;
+    }
+}
+component Pong {
+    composition {
+        component Ping ping;
+        component Server y;
+    }
+}
+assembly {
+    composition {
+        component Task t;
+        component Inner i;
+        component Loop l;
+        component Ping p;
+        connection rpc() missing(from t.r, to i.p);
+    }
+}
+)";
+
+int main()
+{
+    camkes_parser parser(2);
+
+    // composite components are expanded into their compositions, nested ones recursively, under qualified names
+    parse_result nested = parser.parse_buffer(NESTED, "composition_test.camkes", parse_options());
+    CHECK(nested.ok() && nested.diags.get_entries().empty());
+    CHECK((identifiers(nested) == vector<string>{"o.back.store", "o.back.store.p", "o.back.worker", "o.front.store", "o.front.store.p", "o.front.worker", "t"}));
+    // the configuration of a definition applies to each of its instances
+    const node_result *front = find_node(nested, "o.front.store.p");
+    const node_result *back = find_node(nested, "o.back.store.p");
+    CHECK(front != nullptr && front->type == type_t::connection && front->protocol == protocol_t::propagation);
+    CHECK(back != nullptr && back->type == type_t::connection && back->protocol == protocol_t::propagation);
+    CHECK(find_node(nested, "o.front.worker") != nullptr && find_node(nested, "o.front.worker")->priority == 5);
+    CHECK(find_node(nested, "o.back.worker") != nullptr && find_node(nested, "o.back.worker")->priority == 5);
+    // a connection to an exported port follows the exports down to the port within
+    CHECK(front != nullptr && front->priority == 9 && front->requestors == (vector<string_view>{"o.front.worker", "t"}));
+    CHECK(back != nullptr && back->priority == 5 && back->requestors == vector<string_view>{"o.back.worker"});
+
+    // a port that is not exported and compositions nested within themselves are errors, the rest is still expanded
+    parse_result faulty = parser.parse_buffer(FAULTY, "composition_test.camkes", parse_options());
+    CHECK(faulty.parsed && !faulty.ok());
+    CHECK((reported(faulty) == vector<pair<string, string>>{{"recursive-composition", "Loop"}, {"recursive-composition", "Ping"}, {"unexported-port", "i.p"}}));
+    CHECK((identifiers(faulty) == vector<string>{"i.store", "l.x", "p.pong.y", "t"}));
+    for (const diagnostic &entry : faulty.diags.get_entries())
+    {
+        CHECK(entry.severity == severity_t::error && entry.file == "composition_test.camkes");
+        CHECK(entry.line == (entry.code == "unexported-port" ? 29u : entry.subject == "Loop" ? 8u : 19u));
+    }
+
+    return failures == 0 ? 0 : 1;
+}
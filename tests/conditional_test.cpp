@@ -0,0 +1,168 @@
+/*
+ *  conditional_test.cpp
+ *  behaviour tests of following the conditional directives of a configuration
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include "emitter.hpp"
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+
+using namespace std;
+
+// the graph, the diagnostics and the rejected edges, as the command line prints them
+static string printed(const parse_result &result)
+{
+    ostringstream output;
+    CHECK(result.parsed);
+    if (result.parsed)
+    {
+        emit(result.analysis, output_format::text, true, output);
+        result.diags.print(output);
+        output << result.cycles;
+    }
+    return output.str();
+}
+
+// whether a node is in the results
+static bool has_node(const parse_result &result, string_view identifier)
+{
+    for (const node_result &node : result.analysis.nodes)
+    {
+        if (node.identifier == identifier)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the codes of the diagnostics, in the order they were reported
+static vector<string> codes(const parse_result &result)
+{
+    vector<string> reported;
+    for (const diagnostic &entry : result.diags.get_entries())
+    {
+        reported.push_back(entry.code);
+    }
+    return reported;
+}
+
+// parse a configuration through the scanner and through the regex passes, which follow the directives alike
+static parse_result parse_both(const camkes_parser &parser, const string &contents)
+{
+    parse_options options;
+    parse_result scanned = parser.parse_buffer(contents, "conditional_test.camkes", options);
+    options.regex = true;
+    CHECK(printed(parser.parse_buffer(contents, "conditional_test.camkes", options)) == printed(scanned));
+    return scanned;
+}
+
+const char *const GUARDED = R"(#ifndef SYSTEM_H
+#define SYSTEM_H
+assembly {
+    composition {
+        component Task t;
+        component Server s;
+        connection rpc() c(from t.r, to s.p);
+    }
+    configuration {
+        t._priority = 4;
+        s.p_priority_protocol = "fixed";
+    }
+}
+#endif /* SYSTEM_H */
+)";
+
+const char *const BRANCHES = R"(#define FAST 1
+assembly {
+    composition {
+        component Task t;
+        component Server s;
+#if FAST && VERSION > 2
+        component Task chosen_if;
+#elif defined(FAST) && !defined MISSING
+        component Task chosen_elif;
+#elif 1
+        component Task after_taken;
+#else
+        component Task chosen_else;
+#endif
+#ifdef MISSING
+        component Task missing;
+#if 1 / 0
+        component Task nested;
+#endif
+#define THREADS 5
+#undef FAST
+#else
+#if 0
+#elif !defined(THREADS)
+        component Task nested_elif;
+#endif
+#endif
+        connection rpc(THREADS) c(from t.r, to s.p);
+    }
+    configuration {
+        t._priority = 4;
+#ifndef FAST
+        t._priority = 9;
+#endif
+        s.p_priority_protocol = "fixed";
+    }
+}
+#define THREADS 1
+)";
+
+int main()
+{
+    camkes_parser parser(2);
+
+    // an include guard is followed without a warning
+    parse_result guarded = parse_both(parser, GUARDED);
+    CHECK(guarded.ok() && guarded.diags.get_entries().empty() && has_node(guarded, "s.p"));
+    parse_options strict;
+    strict.warnings_as_errors = true;
+    CHECK(parser.parse_buffer(GUARDED, "conditional_test.camkes", strict).ok());
+
+    // only the statements and definitions of the branches taken count, and branches not taken are not evaluated
+    parse_result branches = parse_both(parser, BRANCHES);
+    CHECK(branches.ok() && branches.diags.get_entries().empty());
+    CHECK(has_node(branches, "chosen_elif") && has_node(branches, "nested_elif"));
+    for (string_view skipped : {"chosen_if", "after_taken", "chosen_else", "missing", "nested"})
+    {
+        CHECK(!has_node(branches, skipped));
+    }
+    for (const node_result &node : branches.analysis.nodes)
+    {
+        CHECK(node.identifier != "s.p" || node.priority == 4);
+    }
+
+    // a condition that is not a constant parses every branch, with a warning, and so does a group never closed
+    const string UNKNOWN = "#if f(1)\ncomponent Task a;\n#else\ncomponent Task b;\n#endif\n#endif\n#undef X\n#if 0\ncomponent Task c;\n";
+    parse_result unknown = parse_both(parser, "assembly {\ncomposition {\n" + UNKNOWN + "}\n}\n");
+    CHECK(has_node(unknown, "a") && has_node(unknown, "b") && !has_node(unknown, "c"));
+    CHECK((codes(unknown) == vector<string>{"ignored-directive", "ignored-directive", "ignored-directive", "unterminated-conditional"}));
+    string unknown_printed = printed(unknown);
+    CHECK(unknown_printed.find("directive #if is ignored, its condition is not a constant") != string::npos);
+    CHECK(unknown_printed.find("directive #endif is ignored, no #if is open") != string::npos);
+    CHECK(unknown_printed.find("directive #undef is ignored, macros keep their last definition") != string::npos);
+    CHECK(!parser.parse_buffer(UNKNOWN, "conditional_test.camkes", strict).ok());
+
+    // each file follows its own directives, a guarded import is expanded with its statements
+    string directory = "conditional_test_files";
+    filesystem::remove_all(directory);
+    filesystem::create_directory(directory);
+    ofstream(filesystem::path(directory) / "system.camkes") << GUARDED;
+    ofstream(filesystem::path(directory) / "main.camkes") << "#if 0\n#endif\nimport \"system.camkes\";\n#ifndef SYSTEM_H\ncomponent Task unguarded;\n#endif\n";
+    parse_result imported = parser.parse_file((filesystem::path(directory) / "main.camkes").string(), parse_options());
+    CHECK(imported.ok() && imported.diags.get_entries().empty() && has_node(imported, "s.p") && !has_node(imported, "unguarded"));
+    filesystem::remove_all(directory);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/*
+ *  cycle_test.cpp
+ *  behaviour tests of the cycle check
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include "emitter.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sstream>
+#include <random>
+
+using namespace std;
+
+// the graph with the threads behind each count, the diagnostics and the rejected edges, as the command line prints them
+static string printed(const parse_result &result)
+{
+    ostringstream output;
+    CHECK(result.parsed);
+    if (result.parsed)
+    {
+        emit(result.analysis, output_format::text, true, output);
+        result.diags.print(output);
+        output << result.cycles;
+    }
+    return output.str();
+}
+
+// parse a configuration with the cycles checked on every edge or once all edges are in
+static parse_result parse(const camkes_parser &parser, const string &contents, bool batch_edges)
+{
+    parse_options options;
+    options.batch_edges = batch_edges;
+    options.trace = true;
+    return parser.parse_buffer(contents, "cycle_test.camkes", options);
+}
+
+// the requestors of a node, empty if there is no such node
+static vector<string_view> requestors_of(const parse_result &result, string_view identifier)
+{
+    for (const node_result &node : result.analysis.nodes)
+    {
+        if (node.identifier == identifier)
+        {
+            return node.requestors;
+        }
+    }
+    return vector<string_view>();
+}
+
+// Servers s0, s1, ... whose ports are requested by tasks and by any servers, including later ones and themselves,
+// so the graph has cycles of all lengths, strongly connected components sharing edges and several separate ones.
+static string random_cyclic_configuration(size_t tasks, size_t servers, uint64_t seed)
+{
+    static const char *const PROTOCOLS[] = {"fixed", "inherited", "propagated"};
+    mt19937_64 random(seed);
+    string composition;
+    string configuration;
+    for (size_t i = 0; i < tasks; i++)
+    {
+        composition += "\t\tcomponent Task t" + to_string(i) + ";\n";
+        configuration += "\t\tt" + to_string(i) + "._priority = " + to_string(1 + random() % 254) + ";\n";
+    }
+    for (size_t j = 0; j < servers; j++)
+    {
+        composition += "\t\tcomponent Server s" + to_string(j) + ";\n";
+    }
+    for (size_t j = 0; j < servers; j++)
+    {
+        string server = "s" + to_string(j);
+        composition += "\t\tconnection rpc() c" + to_string(j) + "(";
+        size_t count = 1 + random() % 3;
+        for (size_t k = 0; k < count; k++)
+        {
+            size_t pick = random() % (tasks + servers);
+            string requestor = pick < tasks ? "t" + to_string(pick) : "s" + to_string(pick - tasks);
+            composition += "from " + requestor + ".r_" + server + "_" + to_string(k) + ", ";
+        }
+        composition += "to " + server + ".p);\n";
+        configuration += "\t\t" + server + ".p_priority_protocol = \"" + PROTOCOLS[random() % 3] + "\";\n";
+    }
+    return "assembly {\n\tcomposition {\n" + composition + "\t}\n\tconfiguration {\n" + configuration + "\t}\n}\n";
+}
+
+// two separate cycles, one of three components, and a component calling itself
+const char *const SEPARATE_CYCLES = R"(
+assembly {
+    composition {
+        component Task t;
+        component Server a;
+        component Server b;
+        component Server c;
+        component Server d;
+        component Server e;
+        connection rpc() c1(from t.r, to a.p);
+        connection rpc() c2(from a.r, to b.p);
+        connection rpc() c3(from b.r, to a.q);
+        connection rpc() c4(from t.s, to c.p);
+        connection rpc() c5(from c.r, to d.p);
+        connection rpc() c6(from d.r, to e.p);
+        connection rpc() c7(from e.r, to c.q);
+        connection rpc() c8(from e.s, to e.p2);
+    }
+    configuration {
+        t._priority = 5;
+    }
+}
+)";
+
+int main()
+{
+    camkes_parser parser(2);
+
+    // each cycle is reported once, by the edge closing it, whichever way the cycles are checked
+    const string expected_cycles =
+        "Error: cycle b -> c2 -> a -> c3 -> b detected\n"
+        "Error: cycle e -> c6 -> d -> c5 -> c -> c7 -> e detected\n"
+        "Error: cycle e -> c8 -> e detected\n";
+    for (bool batch_edges : {false, true})
+    {
+        parse_result result = parse(parser, SEPARATE_CYCLES, batch_edges);
+        CHECK(result.cycles == expected_cycles);
+        // the rejected edges are left out, the others kept
+        CHECK(requestors_of(result, "a.q").empty());
+        CHECK(requestors_of(result, "c.q").empty());
+        CHECK(requestors_of(result, "e.p2").empty());
+        CHECK(requestors_of(result, "b.p") == vector<string_view>{"a"});
+        CHECK(requestors_of(result, "e.p") == vector<string_view>{"d"});
+    }
+
+    // random graphs with many cycles print the same graph, diagnostics and rejected edges either way
+    size_t cyclic = 0;
+    for (uint64_t seed = 1; seed <= 100; seed++)
+    {
+        string contents = random_cyclic_configuration(4, 5 + seed % 40, seed);
+        parse_result incremental = parse(parser, contents, false);
+        parse_result batch = parse(parser, contents, true);
+        if (printed(batch) != printed(incremental))
+        {
+            cerr << "seed " << seed << ": checking the cycles once all edges are in changes the output" << endl;
+        }
+        CHECK(printed(batch) == printed(incremental));
+        cyclic += !incremental.cycles.empty();
+    }
+    CHECK(cyclic > 90);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+/*
+ *  diagnostics_test.cpp
+ *  behaviour tests of the diagnostics
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+
+using namespace std;
+
+// the number of times text occurs in printed
+static size_t occurrences(const string &printed, const string &text)
+{
+    size_t count = 0;
+    for (size_t position = printed.find(text); position != string::npos; position = printed.find(text, position + 1))
+    {
+        count++;
+    }
+    return count;
+}
+
+int main()
+{
+    // each code is reported once per subject, and codes and subjects are never mixed up, whatever bytes they hold
+    diagnostics diags;
+    CHECK(diags.report(severity_t::error, "code", "subject", "a.camkes", 1, "first"));
+    CHECK(!diags.report(severity_t::error, "code", "subject", "b.camkes", 2, "again"));
+    CHECK(diags.report(severity_t::error, "code", "other", "a.camkes", 3, "other subject"));
+    CHECK(diags.report(severity_t::warning, "other-code", "subject", "a.camkes", 4, "other code"));
+    CHECK(diags.report(severity_t::warning, string("x\0", 2), "y", "", 0, "joined"));
+    CHECK(diags.report(severity_t::warning, "x", string("\0y", 2), "", 0, "joined differently"));
+    CHECK(!diags.add({severity_t::error, "code", "other", "c.camkes", 5, "replayed"}));
+    CHECK(diags.get_entries().size() == 5 && diags.error_count() == 2);
+
+    // past --max-errors the later errors are left out of the print, but still counted, with warnings as errors too
+    diagnostics limited;
+    limited.max_errors = 2;
+    for (size_t i = 0; i < 5; i++)
+    {
+        limited.report(severity_t::error, "error", to_string(i), "a.camkes", uint32_t(10 - i), "error ", i, ".");
+    }
+    limited.report(severity_t::warning, "warning", "w", "a.camkes", 1, "warning.");
+    ostringstream printed;
+    limited.print(printed);
+    CHECK(limited.error_count() == 5 && limited.get_entries().size() == 6);
+    CHECK(occurrences(printed.str(), "Error: error") == 2 && printed.str().find("error 0.") != string::npos && printed.str().find("error 1.") != string::npos);
+    CHECK(printed.str().find("Warning: warning.") != string::npos);
+    CHECK(printed.str().find("3 more not shown (--max-errors 2)") != string::npos);
+    CHECK(printed.str().find("1 warning and 5 errors generated.") != string::npos);
+    limited.warnings_as_errors = true;
+    printed.str("");
+    limited.print(printed);
+    CHECK(printed.str().find("4 more not shown") != string::npos && printed.str().find("0 warnings and 6 errors generated.") != string::npos);
+
+    // an import that cannot be resolved is reported once per import statement, in each file and on each line
+    string directory = "diagnostics_test_files";
+    filesystem::remove_all(directory);
+    filesystem::create_directory(directory);
+    ofstream(filesystem::path(directory) / "main.camkes") << "import \"a.camkes\";\nimport \"missing.camkes\";\nimport \"missing.camkes\";\n";
+    ofstream(filesystem::path(directory) / "a.camkes") << "import \"missing.camkes\";\n";
+    camkes_parser parser(2);
+    parse_result result = parser.parse_file((filesystem::path(directory) / "main.camkes").string(), parse_options());
+    ostringstream reported;
+    result.diags.print(reported);
+    CHECK(occurrences(reported.str(), "cannot resolve import missing.camkes") == 3);
+    CHECK(occurrences(reported.str(), "main.camkes:2:") == 1 && occurrences(reported.str(), "main.camkes:3:") == 1 && occurrences(reported.str(), "a.camkes:1:") == 1);
+    filesystem::remove_all(directory);
+
+    return failures == 0 ? 0 : 1;
+}
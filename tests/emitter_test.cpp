@@ -0,0 +1,563 @@
+/*
+ *  emitter_test.cpp
+ *  behaviour tests of the json and csv emitters
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include "emitter.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+
+using namespace std;
+
+// A parsed json value, numbers are kept as written.
+struct json_value
+{
+    enum class kind_t
+    {
+        null,
+        boolean,
+        number,
+        string,
+        array,
+        object
+    };
+
+    kind_t kind = kind_t::null;
+    // the decoded string, the number as written, or true or false
+    string text;
+    vector<json_value> items;
+    map<string, json_value> members;
+
+    const json_value &operator[](const string &name) const
+    {
+        static const json_value missing;
+        auto it = members.find(name);
+        return it == members.end() ? missing : it->second;
+    }
+};
+
+// Strict recursive descent parser of json text, as RFC 8259 defines it.
+class json_parser
+{
+private:
+    string_view text;
+    size_t cursor = 0;
+
+    void skip_whitespace()
+    {
+        while (cursor < text.size() && (text[cursor] == ' ' || text[cursor] == '\t' || text[cursor] == '\n' || text[cursor] == '\r'))
+        {
+            cursor++;
+        }
+    }
+
+    bool literal(string_view word)
+    {
+        if (text.substr(cursor, word.size()) != word)
+        {
+            return false;
+        }
+        cursor += word.size();
+        return true;
+    }
+
+    bool hex_digit(char c, unsigned &digit)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            digit = c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            digit = c - 'A' + 10;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    bool parse_string(string &decoded)
+    {
+        if (!literal("\""))
+        {
+            return false;
+        }
+        while (cursor < text.size())
+        {
+            char c = text[cursor++];
+            if (c == '"')
+            {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                // control characters must be escaped
+                return false;
+            }
+            if (c != '\\')
+            {
+                decoded.push_back(c);
+                continue;
+            }
+            if (cursor >= text.size())
+            {
+                return false;
+            }
+            char escape = text[cursor++];
+            static const string_view SIMPLE = "\"\\/bfnrt";
+            static const string_view DECODED = "\"\\/\b\f\n\r\t";
+            size_t simple = SIMPLE.find(escape);
+            if (simple != string_view::npos)
+            {
+                decoded.push_back(DECODED[simple]);
+                continue;
+            }
+            if (escape != 'u' || cursor + 4 > text.size())
+            {
+                return false;
+            }
+            unsigned code = 0;
+            for (size_t i = 0; i < 4; i++)
+            {
+                unsigned digit;
+                if (!hex_digit(text[cursor++], digit))
+                {
+                    return false;
+                }
+                code = code * 16 + digit;
+            }
+            // the emitters only escape control characters this way
+            if (code >= 0x80)
+            {
+                return false;
+            }
+            decoded.push_back(char(code));
+        }
+        return false;
+    }
+
+    bool parse_number(string &number)
+    {
+        size_t start = cursor;
+        literal("-");
+        if (cursor < text.size() && text[cursor] == '0')
+        {
+            cursor++;
+        }
+        else if (cursor < text.size() && text[cursor] >= '1' && text[cursor] <= '9')
+        {
+            while (cursor < text.size() && isdigit(static_cast<unsigned char>(text[cursor])))
+            {
+                cursor++;
+            }
+        }
+        else
+        {
+            return false;
+        }
+        number = text.substr(start, cursor - start);
+        return true;
+    }
+
+    bool parse_value(json_value &value)
+    {
+        skip_whitespace();
+        if (cursor >= text.size())
+        {
+            return false;
+        }
+        char c = text[cursor];
+        if (c == '{')
+        {
+            value.kind = json_value::kind_t::object;
+            cursor++;
+            skip_whitespace();
+            if (literal("}"))
+            {
+                return true;
+            }
+            while (true)
+            {
+                skip_whitespace();
+                string name;
+                if (!parse_string(name) || value.members.count(name) > 0)
+                {
+                    return false;
+                }
+                skip_whitespace();
+                if (!literal(":") || !parse_value(value.members[name]))
+                {
+                    return false;
+                }
+                skip_whitespace();
+                if (literal("}"))
+                {
+                    return true;
+                }
+                if (!literal(","))
+                {
+                    return false;
+                }
+            }
+        }
+        if (c == '[')
+        {
+            value.kind = json_value::kind_t::array;
+            cursor++;
+            skip_whitespace();
+            if (literal("]"))
+            {
+                return true;
+            }
+            while (true)
+            {
+                value.items.emplace_back();
+                if (!parse_value(value.items.back()))
+                {
+                    return false;
+                }
+                skip_whitespace();
+                if (literal("]"))
+                {
+                    return true;
+                }
+                if (!literal(","))
+                {
+                    return false;
+                }
+            }
+        }
+        if (c == '"')
+        {
+            value.kind = json_value::kind_t::string;
+            return parse_string(value.text);
+        }
+        for (string_view word : {"true", "false"})
+        {
+            if (literal(word))
+            {
+                value.kind = json_value::kind_t::boolean;
+                value.text = word;
+                return true;
+            }
+        }
+        if (literal("null"))
+        {
+            value.kind = json_value::kind_t::null;
+            return true;
+        }
+        value.kind = json_value::kind_t::number;
+        return parse_number(value.text);
+    }
+
+public:
+    explicit json_parser(string_view text) : text(text) {}
+
+    // parse the whole text as one value, return false if it is not valid json
+    bool parse(json_value &value)
+    {
+        if (!parse_value(value))
+        {
+            return false;
+        }
+        skip_whitespace();
+        return cursor == text.size();
+    }
+};
+
+// parse csv text as RFC 4180 defines it, return false if a quoted field is malformed
+static bool parse_csv(string_view text, vector<vector<string>> &rows)
+{
+    size_t cursor = 0;
+    while (cursor < text.size())
+    {
+        vector<string> row;
+        while (true)
+        {
+            string field;
+            if (cursor < text.size() && text[cursor] == '"')
+            {
+                cursor++;
+                while (true)
+                {
+                    if (cursor >= text.size())
+                    {
+                        return false;
+                    }
+                    char c = text[cursor++];
+                    if (c == '"')
+                    {
+                        if (cursor < text.size() && text[cursor] == '"')
+                        {
+                            field.push_back('"');
+                            cursor++;
+                            continue;
+                        }
+                        break;
+                    }
+                    field.push_back(c);
+                }
+                if (cursor < text.size() && text[cursor] != ',' && text[cursor] != '\n')
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                while (cursor < text.size() && text[cursor] != ',' && text[cursor] != '\n')
+                {
+                    if (text[cursor] == '"')
+                    {
+                        // quotes only appear in quoted fields
+                        return false;
+                    }
+                    field.push_back(text[cursor++]);
+                }
+            }
+            row.push_back(field);
+            if (cursor < text.size() && text[cursor] == ',')
+            {
+                cursor++;
+                continue;
+            }
+            break;
+        }
+        if (cursor >= text.size() || text[cursor] != '\n')
+        {
+            // every row ends with a line break
+            return false;
+        }
+        cursor++;
+        rows.push_back(row);
+    }
+    return true;
+}
+
+// emit a result into a string
+template <typename result_t, typename... args_t>
+static string emitted(const result_t &result, output_format format, const args_t &...args)
+{
+    ostringstream out;
+    emit(result, format, args..., out);
+    return out.str();
+}
+
+// check that there is a header and every row has as many fields as it, the rows can be indexed by the header if so
+static bool check_columns(const vector<vector<string>> &rows)
+{
+    CHECK(!rows.empty());
+    bool same = !rows.empty();
+    for (const vector<string> &row : rows)
+    {
+        same = same && row.size() == rows[0].size();
+    }
+    CHECK(same);
+    return same;
+}
+
+// names that need escaping in json or quoting in csv
+static const vector<string> AWKWARD_NAMES = {"plain", "quote\"d", "comma,separated", "line\nbreak", "carriage\rreturn", "back\\slash", "tab\tbed", string("control\x01") + "\x1f", "semi;colon", "\"", ""};
+
+static void test_analysis()
+{
+    analysis_result result;
+    for (size_t i = 0; i < AWKWARD_NAMES.size(); i++)
+    {
+        node_result node;
+        node.identifier = AWKWARD_NAMES[i];
+        node.name = AWKWARD_NAMES[(i + 1) % AWKWARD_NAMES.size()];
+        node.type = i % 2 == 0 ? type_t::connection : type_t::task;
+        node.protocol = protocol_t::pip;
+        node.requestors = {AWKWARD_NAMES[(i + 2) % AWKWARD_NAMES.size()], "plain"};
+        node.priority = i;
+        node.thread_count = 2 * i;
+        node.traced = i % 3 != 0;
+        node.threads = {AWKWARD_NAMES[(i + 3) % AWKWARD_NAMES.size()]};
+        node.fixed_threads = {{"t1", AWKWARD_NAMES[i]}, {}};
+        node.nested_thread = i % 2 == 1;
+        result.nodes.push_back(node);
+    }
+
+    for (bool trace : {false, true})
+    {
+        json_value json;
+        string text = emitted(result, output_format::json, trace);
+        CHECK(json_parser(text).parse(json));
+        const json_value &nodes = json["nodes"];
+        CHECK(nodes.kind == json_value::kind_t::array && nodes.items.size() == result.nodes.size());
+        for (size_t i = 0; i < min(nodes.items.size(), result.nodes.size()); i++)
+        {
+            const json_value &node = nodes.items[i];
+            const node_result &expected = result.nodes[i];
+            CHECK(node["identifier"].text == expected.identifier);
+            CHECK(node["name"].text == expected.name);
+            CHECK(node["requestors"].items.size() == 2 && node["requestors"].items[0].text == expected.requestors[0]);
+            CHECK(node["priority"].text == to_string(expected.priority));
+            CHECK(node["threads"].text == to_string(expected.thread_count));
+            CHECK((node["protocol"].kind == json_value::kind_t::string) == (expected.type == type_t::connection));
+            bool traced = trace && expected.traced;
+            CHECK((node["trace"].kind == json_value::kind_t::object) == traced);
+            if (traced)
+            {
+                CHECK(node["trace"]["threads"].items.size() == 1 && node["trace"]["threads"].items[0].text == expected.threads[0]);
+                CHECK(node["trace"]["fixed_threads"].items.size() == 2 && node["trace"]["fixed_threads"].items[0].items[1].text == expected.fixed_threads[0][1]);
+                CHECK(node["trace"]["nested_thread"].text == (expected.nested_thread ? "true" : "false"));
+            }
+        }
+
+        vector<vector<string>> rows;
+        CHECK(parse_csv(emitted(result, output_format::csv, trace), rows));
+        if (!check_columns(rows))
+        {
+            continue;
+        }
+        CHECK(rows.size() == result.nodes.size() + 1);
+        CHECK(rows[0].size() == (trace ? 10u : 7u));
+        for (size_t i = 1; i < rows.size() && i <= result.nodes.size(); i++)
+        {
+            const node_result &expected = result.nodes[i - 1];
+            CHECK(rows[i][0] == expected.identifier);
+            CHECK(rows[i][1] == expected.name);
+            CHECK(rows[i][4] == string(expected.requestors[0]) + ";plain");
+            CHECK(rows[i][5] == to_string(expected.priority));
+            if (trace && expected.traced)
+            {
+                CHECK(rows[i][7] == expected.threads[0]);
+                CHECK(rows[i][8] == "t1;" + string(expected.fixed_threads[0][1]) + "|");
+            }
+        }
+    }
+
+    // an empty result is still a document and a header
+    json_value json;
+    CHECK(json_parser(emitted(analysis_result(), output_format::json, true)).parse(json) && json["nodes"].items.empty());
+    vector<vector<string>> rows;
+    CHECK(parse_csv(emitted(analysis_result(), output_format::csv, true), rows) && rows.size() == 1);
+}
+
+static void test_exploration()
+{
+    exploration_result result;
+    for (const string &name : AWKWARD_NAMES)
+    {
+        result.connections.push_back(name);
+    }
+    for (size_t i = 0; i < 3; i++)
+    {
+        explored_assignment point;
+        point.threads = 10 - i;
+        point.blocking_levels = i;
+        point.protocols.assign(result.connections.size(), i == 0 ? protocol_t::ipcp : i == 1 ? protocol_t::pip : protocol_t::propagation);
+        result.front.push_back(point);
+    }
+    result.visited = 42;
+
+    json_value json;
+    CHECK(json_parser(emitted(result, output_format::json)).parse(json));
+    CHECK(json["connections"].items.size() == result.connections.size());
+    CHECK(json["front"].items.size() == 3);
+    CHECK(json["visited"].text == "42" && json["exhaustive"].text == "true");
+    for (size_t i = 0; i < result.connections.size(); i++)
+    {
+        CHECK(json["connections"].items[i].text == result.connections[i]);
+        CHECK(json["front"].items[1]["protocols"][string(result.connections[i])].text == "inherited");
+    }
+
+    vector<vector<string>> rows;
+    CHECK(parse_csv(emitted(result, output_format::csv), rows));
+    CHECK(check_columns(rows) && rows.size() == 4 && rows[0].size() == result.connections.size() + 2);
+    for (size_t i = 0; i < result.connections.size() && rows.size() == 4 && rows[0].size() == result.connections.size() + 2; i++)
+    {
+        CHECK(rows[0][i + 2] == result.connections[i]);
+        CHECK(rows[3][i + 2] == "propagated");
+    }
+
+    json_value empty;
+    CHECK(json_parser(emitted(exploration_result(), output_format::json)).parse(empty) && empty["front"].items.empty());
+}
+
+static void test_schedulability()
+{
+    schedulability_result result;
+    for (size_t i = 0; i < AWKWARD_NAMES.size(); i++)
+    {
+        result.tasks.push_back({AWKWARD_NAMES[i], 10 - i, 100, i % 2 == 0 ? UNKNOWN_TIME : i, 5, 1, 6 + i, i != 3});
+    }
+    result.schedulable = false;
+
+    json_value json;
+    CHECK(json_parser(emitted(result, output_format::json)).parse(json));
+    CHECK(json["schedulable"].text == "false");
+    CHECK(json["tasks"].items.size() == result.tasks.size());
+    for (size_t i = 0; i < min(json["tasks"].items.size(), result.tasks.size()); i++)
+    {
+        const json_value &task = json["tasks"].items[i];
+        CHECK(task["identifier"].text == result.tasks[i].identifier);
+        CHECK((task["release_time"].kind == json_value::kind_t::null) == (i % 2 == 0));
+        CHECK(task["response_time"].text == to_string(6 + i));
+        CHECK(task["schedulable"].text == (i != 3 ? "true" : "false"));
+    }
+
+    vector<vector<string>> rows;
+    CHECK(parse_csv(emitted(result, output_format::csv), rows));
+    CHECK(check_columns(rows) && rows[0].size() == 8);
+    CHECK(rows.size() == result.tasks.size() + 1);
+    for (size_t i = 1; i < rows.size() && i <= result.tasks.size() && rows[i].size() == 8; i++)
+    {
+        CHECK(rows[i][0] == result.tasks[i - 1].identifier);
+        CHECK(rows[i][3] == (i % 2 == 1 ? "" : to_string(i - 1)));
+    }
+}
+
+// the results of every test file are valid json and csv too
+static void test_files(const string &directory)
+{
+    camkes_parser parser(2);
+    for (const filesystem::directory_entry &entry : filesystem::directory_iterator(directory))
+    {
+        if (entry.path().extension() != ".camkes")
+        {
+            continue;
+        }
+        parse_options options;
+        options.trace = true;
+        parse_result result = parser.parse_file(entry.path().string(), options);
+        CHECK(result.parsed);
+        json_value json;
+        CHECK(json_parser(emitted(result.analysis, output_format::json, true)).parse(json));
+        CHECK(json["nodes"].items.size() == result.analysis.nodes.size());
+        vector<vector<string>> rows;
+        CHECK(parse_csv(emitted(result.analysis, output_format::csv, true), rows));
+        check_columns(rows);
+        CHECK(rows.size() == result.analysis.nodes.size() + 1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        cerr << "Usage: " << argv[0] << " <test files directory>" << endl;
+        return 1;
+    }
+    test_analysis();
+    test_exploration();
+    test_schedulability();
+    test_files(argv[1]);
+    return failures == 0 ? 0 : 1;
+}
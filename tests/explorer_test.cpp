@@ -0,0 +1,107 @@
+/*
+ *  explorer_test.cpp
+ *  behaviour tests of the protocol assignment explorer
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include "protocol_explorer.hpp"
+#include "workload.hpp"
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+
+using namespace std;
+
+// whether two fronts have the same connections and points
+static bool same_front(const exploration_result &lhs, const exploration_result &rhs)
+{
+    if (lhs.connections != rhs.connections || lhs.front.size() != rhs.front.size() || lhs.exhaustive != rhs.exhaustive)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.front.size(); i++)
+    {
+        const explored_assignment &a = lhs.front[i];
+        const explored_assignment &b = rhs.front[i];
+        if (a.threads != b.threads || a.blocking_levels != b.blocking_levels || a.protocols != b.protocols)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// explore a configuration on pools of 1, 2, 4 and 8 threads, which must all find the same front
+static void check_front(const string &contents, const string &name)
+{
+    parse_result result = camkes_parser(1).parse_buffer(contents, name, parse_options());
+    CHECK(result.parsed);
+    if (!result.parsed)
+    {
+        return;
+    }
+    exploration_result serial;
+    for (size_t jobs : {1, 2, 4, 8})
+    {
+        thread_pool pool(jobs);
+        // explore a few times on each pool, so different interleavings of the jobs are tried
+        for (size_t run = 0; run < 3; run++)
+        {
+            exploration_result front = protocol_explorer(*result.graph, pool).explore();
+            if (jobs == 1 && run == 0)
+            {
+                serial = front;
+                continue;
+            }
+            if (!same_front(serial, front))
+            {
+                cerr << name << ": the front on " << jobs << " threads differs from the one on 1 thread" << endl;
+            }
+            CHECK(same_front(serial, front));
+        }
+    }
+
+    // every point beats the others on one objective, by increasing threads and so decreasing blocking levels
+    CHECK(serial.exhaustive);
+    CHECK(!serial.front.empty());
+    for (size_t i = 1; i < serial.front.size(); i++)
+    {
+        CHECK(serial.front[i - 1].threads < serial.front[i].threads);
+        CHECK(serial.front[i - 1].blocking_levels > serial.front[i].blocking_levels);
+    }
+    for (const explored_assignment &point : serial.front)
+    {
+        CHECK(point.protocols.size() == serial.connections.size());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        cerr << "Usage: " << argv[0] << " <test files directory>" << endl;
+        return 1;
+    }
+    for (const filesystem::directory_entry &entry : filesystem::directory_iterator(argv[1]))
+    {
+        if (entry.path().extension() == ".camkes")
+        {
+            ifstream input_file(entry.path());
+            string contents((istreambuf_iterator<char>(input_file)), istreambuf_iterator<char>());
+            check_front(contents, entry.path().string());
+        }
+    }
+
+    // generated systems with more connections than the test files, so the search is split into many jobs
+    for (uint64_t seed : {1, 2})
+    {
+        workload_shape shape;
+        shape.systems = 1;
+        shape.seed = seed;
+        check_front(generate_workload(shape), "generated-" + to_string(seed) + ".camkes");
+    }
+    return failures == 0 ? 0 : 1;
+}
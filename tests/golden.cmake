@@ -0,0 +1,14 @@
+# Run the parser on one input and compare what it prints with the expected output.
+# cmake -DPARSER=<parser> -DINPUT=<input file> -DARGS=<arguments> -DEXPECTED=<expected output> -P golden.cmake
+# The output is written next to the test as <name>.actual when it differs.
+separate_arguments(args UNIX_COMMAND "${ARGS}")
+execute_process(COMMAND ${PARSER} -i ${INPUT} ${args} OUTPUT_VARIABLE output ERROR_VARIABLE errors RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${PARSER} -i ${INPUT} ${ARGS} exited with ${result}:\n${errors}")
+endif()
+file(READ ${EXPECTED} expected)
+if(NOT output STREQUAL expected)
+    get_filename_component(name ${EXPECTED} NAME_WE)
+    file(WRITE ${name}.actual "${output}")
+    message(FATAL_ERROR "output of ${PARSER} -i ${INPUT} ${ARGS} differs from ${EXPECTED}, see ${name}.actual")
+endif()
@@ -0,0 +1,146 @@
+/*
+ *  graph_test.cpp
+ *  behaviour tests of freezing a graph into its compressed sparse row form
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "graph.hpp"
+#include <string>
+#include <vector>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+
+// the neighbours of a node in a compressed sparse row layout
+static vector<uint32_t> row(const vector<uint32_t> &offsets, const vector<uint32_t> &ids, uint32_t id)
+{
+    return vector<uint32_t>(ids.begin() + offsets[id], ids.begin() + offsets[id + 1]);
+}
+
+// Components c0, c1, ..., each with one port p whose connection is requested by components before it, some twice.
+// The frozen graph has the requestors that were added, their transpose as dependents and a valid topological order.
+static void check_random_graph(size_t components, uint64_t seed)
+{
+    mt19937_64 random(seed);
+    diagnostics diags;
+    graph g;
+    g.diags = &diags;
+    g.files.push_back("graph_test.camkes");
+    ostringstream cycles;
+    g.output = &cycles;
+    size_t rejected = 0;
+    vector<string> names;
+    for (size_t i = 0; i < components; i++)
+    {
+        names.push_back("c" + to_string(i));
+        g.add_component(names.back(), source_location{0, uint32_t(i + 1)});
+    }
+    // the expected edges as (requestor, requested) identifiers
+    set<pair<string, string>> edges;
+    for (size_t i = 0; i < components; i++)
+    {
+        string port = names[i] + ".p";
+        g.add_connection("conn" + to_string(i), names[i], "p", "", UNKNOWN_THREADS, source_location{0, uint32_t(i + 1)});
+        CHECK(g.add_edge(port, names[i]));
+        edges.emplace(port, names[i]);
+        size_t count = i == 0 ? 0 : random() % 4;
+        for (size_t k = 0; k < count; k++)
+        {
+            const string &requestor = names[random() % i];
+            CHECK(g.add_edge(requestor, port));
+            edges.emplace(requestor, port);
+        }
+        // a component calling its own port closes a cycle, the edge is rejected
+        if (random() % 4 == 0)
+        {
+            CHECK(!g.add_edge(names[i], port));
+            rejected++;
+        }
+    }
+    string reported = cycles.str();
+    CHECK(size_t(count(reported.begin(), reported.end(), '\n')) == rejected);
+
+    frozen_graph frozen = g.freeze();
+    uint32_t num_nodes = frozen.size();
+    CHECK(num_nodes == 2 * components);
+    CHECK(frozen.requestor_offsets.size() == num_nodes + 1 && frozen.dependent_offsets.size() == num_nodes + 1);
+    CHECK(frozen.requestor_ids.size() == edges.size() && frozen.dependent_ids.size() == edges.size());
+    set<pair<string, string>> requestor_edges;
+    set<pair<string, string>> dependent_edges;
+    for (uint32_t id = 0; id < num_nodes; id++)
+    {
+        CHECK(frozen.find(frozen.identifiers[id]) == id);
+        vector<uint32_t> requestors = row(frozen.requestor_offsets, frozen.requestor_ids, id);
+        vector<uint32_t> dependents = row(frozen.dependent_offsets, frozen.dependent_ids, id);
+        // both rows are in id order, the order the nodes were added in
+        CHECK(is_sorted(requestors.begin(), requestors.end()) && is_sorted(dependents.begin(), dependents.end()));
+        for (uint32_t requestor : requestors)
+        {
+            requestor_edges.emplace(frozen.identifiers[requestor], frozen.identifiers[id]);
+        }
+        for (uint32_t dependent : dependents)
+        {
+            dependent_edges.emplace(frozen.identifiers[id], frozen.identifiers[dependent]);
+        }
+        // a component is a task only if nothing requests it
+        type_t expected = frozen.identifiers[id].find('.') != string_view::npos ? type_t::connection : requestors.empty() ? type_t::task : type_t::component;
+        CHECK(frozen.types[id] == expected);
+    }
+    CHECK(requestor_edges == edges);
+    CHECK(dependent_edges == edges);
+
+    // every node comes once in the topological order, after all of its requestors
+    vector<uint32_t> order = frozen.topological_order();
+    CHECK(order.size() == num_nodes);
+    vector<uint32_t> position(num_nodes, NO_NODE);
+    for (uint32_t i = 0; i < order.size(); i++)
+    {
+        CHECK(order[i] < num_nodes && position[order[i]] == NO_NODE);
+        position[order[i]] = i;
+    }
+    for (uint32_t id = 0; id < num_nodes && order.size() == num_nodes; id++)
+    {
+        for (uint32_t requestor : row(frozen.requestor_offsets, frozen.requestor_ids, id))
+        {
+            CHECK(position[requestor] < position[id]);
+        }
+    }
+}
+
+int main()
+{
+    // a task and a server, the server added first so ids and insertion order differ from identifier order
+    diagnostics diags;
+    graph g;
+    g.diags = &diags;
+    g.files.push_back("graph_test.camkes");
+    uint32_t server = g.add_component("server", source_location{0, 1});
+    uint32_t task = g.add_component("a_task", source_location{0, 2});
+    uint32_t port = g.add_connection("conn", "server", "p", "", UNKNOWN_THREADS, source_location{0, 3});
+    // adding a node again keeps the first one
+    CHECK(g.add_component("server", source_location{0, 4}) == server);
+    CHECK(g.add_connection("other", "server", "p", "", UNKNOWN_THREADS, source_location{0, 5}) == port);
+    CHECK(g.add_edge("a_task", "server.p") && g.add_edge("server.p", "server"));
+    // edges between unknown nodes are not added
+    CHECK(!g.add_edge("missing", "server"));
+    frozen_graph frozen = g.freeze();
+    CHECK(frozen.size() == 3);
+    CHECK(frozen.types[server] == type_t::component && frozen.types[task] == type_t::task && frozen.types[port] == type_t::connection);
+    CHECK(frozen.names[port] == "conn" && frozen.identifiers[port] == "server.p");
+    CHECK(frozen.locations[server].line == 1 && frozen.get_file(server) == "graph_test.camkes");
+    CHECK(frozen.find("server.p") == port && frozen.find("missing") == NO_NODE);
+    CHECK((frozen.sorted_ids == vector<uint32_t>{task, server, port}));
+    CHECK((frozen.topological_order() == vector<uint32_t>{task, port, server}));
+
+    for (uint64_t seed = 1; seed <= 50; seed++)
+    {
+        check_random_graph(1 + seed * 7, seed);
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+/*
+ *  import_test.cpp
+ *  behaviour tests of expanding imports across parses
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+using namespace std;
+
+const string DIRECTORY = "import_test_files";
+
+// write a file of the test directory
+static void write_file(const string &name, const string &contents)
+{
+    ofstream(filesystem::path(DIRECTORY) / name) << contents;
+}
+
+// a task with the given priority, to be imported
+static string task_file(size_t priority)
+{
+    return "assembly {\n\tcomposition {\n\t\tcomponent Task t;\n\t}\n\tconfiguration {\n\t\tt._priority = " + to_string(priority) + ";\n\t}\n}\n";
+}
+
+// parse the main file, return the priority of the imported task and the number of files scanned, as logged
+static pair<size_t, string> parse(const camkes_parser &parser, const parse_options &options)
+{
+    string log_file = (filesystem::path(DIRECTORY) / "parse.log").string();
+    logger log;
+    CHECK(log.open(log_file));
+    parse_result result = parser.parse_file((filesystem::path(DIRECTORY) / "main.camkes").string(), options, log);
+    log.close();
+    CHECK(result.ok() && result.analysis.nodes.size() == 1);
+    ostringstream logged;
+    logged << ifstream(log_file).rdbuf();
+    size_t scanned = logged.str().find("Scanned ");
+    string count = scanned == string::npos ? "" : logged.str().substr(scanned, logged.str().find('\n', scanned) - scanned);
+    return {result.analysis.nodes.empty() ? 0 : result.analysis.nodes[0].priority, count};
+}
+
+int main()
+{
+    filesystem::remove_all(DIRECTORY);
+    filesystem::create_directory(DIRECTORY);
+    write_file("main.camkes", "import \"task.camkes\";\n");
+    write_file("task.camkes", task_file(5));
+    camkes_parser parser(2);
+    parse_options options;
+
+    // the contents scanned by the first parse are found again by the next ones, which still read the files
+    CHECK(parse(parser, options) == make_pair(size_t(5), string("Scanned 2 files")));
+    CHECK(parse(parser, options) == make_pair(size_t(5), string("Scanned 0 files")));
+    // an edited import is scanned again and its new contents are used
+    write_file("task.camkes", task_file(9));
+    CHECK(parse(parser, options) == make_pair(size_t(9), string("Scanned 1 files")));
+    // contents seen before are found whichever file they are read from
+    write_file("task.camkes", task_file(5));
+    CHECK(parse(parser, options) == make_pair(size_t(5), string("Scanned 0 files")));
+
+    // mapped files are not kept between parses, they may change under the mapping
+    options.mmap = true;
+    CHECK(parse(parser, options) == make_pair(size_t(5), string("Scanned 2 files")));
+    CHECK(parse(parser, options) == make_pair(size_t(5), string("Scanned 2 files")));
+
+    // another parser scans everything again
+    camkes_parser other_parser(2);
+    CHECK(parse(other_parser, parse_options()) == make_pair(size_t(5), string("Scanned 2 files")));
+
+    filesystem::remove_all(DIRECTORY);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+/*
+ *  index_test.cpp
+ *  behaviour tests of the interned identifiers and the perfect-hash index over them
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "perfect_hash.hpp"
+#include "symbol_table.hpp"
+#include "frozen_graph.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// every key is found with its own index, and keys not in the index are not taken for one
+static void check_index(const vector<string> &strings)
+{
+    vector<string_view> keys(strings.begin(), strings.end());
+    perfect_hash index;
+    CHECK(index.build(keys));
+    for (uint32_t i = 0; i < keys.size(); i++)
+    {
+        CHECK(index.lookup(keys[i]) == i);
+    }
+    for (const string &absent : {string("absent"), string(""), string("c.p.q"), string(64, 'x')})
+    {
+        uint32_t value = index.lookup(absent);
+        CHECK(value == perfect_hash::NOT_FOUND || (value < keys.size() && keys[value] != absent));
+    }
+}
+
+int main()
+{
+    // no keys, one key, and identifiers of a large graph, components and their ports
+    check_index({});
+    check_index({"only"});
+    vector<string> identifiers;
+    for (size_t i = 0; i < 100000; i++)
+    {
+        identifiers.push_back("component_" + to_string(i));
+        identifiers.push_back("component_" + to_string(i) + ".port");
+    }
+    check_index(identifiers);
+
+    // equal keys can never be told apart, the index is not built and finds nothing
+    perfect_hash duplicated;
+    CHECK(!duplicated.build({"a", "b", "c", "b", "d"}));
+    CHECK(duplicated.lookup("a") == perfect_hash::NOT_FOUND && duplicated.lookup("b") == perfect_hash::NOT_FOUND);
+
+    // a string is interned once, whether it is joined from a component and a port or not
+    symbol_table symbols;
+    uint32_t port = symbols.intern("server", "p");
+    CHECK(symbols.intern("server.p") == port && symbols.find("server.p") == port && symbols.find("server", "p") == port);
+    CHECK(symbols.str(port) == "server.p");
+    uint32_t server = symbols.intern("server");
+    CHECK(server != port && symbols.intern("server") == server);
+    CHECK(symbols.find("client") == symbol_table::NOT_FOUND && symbols.find("server", "q") == symbol_table::NOT_FOUND);
+    // views of interned strings stay valid as the table grows
+    string_view first = symbols.str(server);
+    for (size_t i = 0; i < 100000; i++)
+    {
+        symbols.intern("component_" + to_string(i));
+    }
+    CHECK(symbols.size() == 100002);
+    CHECK(first == "server" && first.data() == symbols.str(server).data());
+
+    // a frozen graph finds its nodes by identifier, and refuses to index identifiers that are not distinct
+    frozen_graph frozen;
+    frozen.identifiers = {"b", "a.p", "a"};
+    CHECK(frozen.build_index());
+    CHECK(frozen.find("a.p") == 1 && frozen.find("a") == 2 && frozen.find("b") == 0 && frozen.find("c") == NO_NODE);
+    CHECK((frozen.sorted_ids == vector<uint32_t>{2, 1, 0}));
+    frozen.identifiers = {"b", "a.p", "b"};
+    CHECK(!frozen.build_index());
+
+    return failures == 0 ? 0 : 1;
+}
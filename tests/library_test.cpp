@@ -0,0 +1,169 @@
+/*
+ *  library_test.cpp
+ *  behaviour tests of the in-process parse api
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include "emitter.hpp"
+#include <string>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <filesystem>
+
+using namespace std;
+
+// the graph, the diagnostics and the rejected edges, as the command line prints them
+static string printed(const parse_result &result)
+{
+    ostringstream output;
+    if (result.parsed)
+    {
+        emit(result.analysis, output_format::text, true, output);
+        result.diags.print(output);
+        output << result.cycles;
+    }
+    return output.str();
+}
+
+static string read_file(const filesystem::path &path)
+{
+    ifstream file(path, ios::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+// the analysed node of an identifier, null if there is none
+static const node_result *find_node(const parse_result &result, string_view identifier)
+{
+    auto found = find_if(result.analysis.nodes.begin(), result.analysis.nodes.end(), [identifier](const node_result &node) { return node.identifier == identifier; });
+    return found == result.analysis.nodes.end() ? nullptr : &*found;
+}
+
+const char *const MAIN_FILE = R"(
+import "server.camkes";
+assembly {
+    composition {
+        component Task t;
+        connection rpc() c(from t.r, to s.p);
+    }
+    configuration {
+        t._priority = 7;
+        s.p_priority_protocol = "propagated";
+    }
+}
+)";
+
+const char *const SERVER_FILE = R"(
+assembly {
+    composition {
+        component Server s;
+    }
+}
+)";
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        cerr << "Usage: " << argv[0] << " <test files directory>" << endl;
+        return 1;
+    }
+    camkes_parser parser(2);
+    parse_options options;
+    options.trace = true;
+
+    // a buffer parses as the file holding it, through the scanner and through the regex passes
+    // diagnostics are reported from the name given, a file from its canonical path
+    vector<filesystem::path> files;
+    for (const filesystem::directory_entry &entry : filesystem::directory_iterator(argv[1]))
+    {
+        if (entry.path().extension() == ".camkes")
+        {
+            files.push_back(filesystem::canonical(entry.path()));
+        }
+    }
+    sort(files.begin(), files.end());
+    CHECK(!files.empty());
+    vector<string> expected;
+    for (const filesystem::path &path : files)
+    {
+        parse_result from_file = parser.parse_file(path.string(), options);
+        CHECK(from_file.ok() && !from_file.analysis.nodes.empty() && from_file.graph != nullptr);
+        CHECK(is_sorted(from_file.analysis.nodes.begin(), from_file.analysis.nodes.end(), [](const node_result &lhs, const node_result &rhs) { return lhs.identifier < rhs.identifier; }));
+        expected.push_back(printed(from_file));
+        CHECK(printed(parser.parse_buffer(read_file(path), path.string(), options)) == expected.back());
+        parse_options regex = options;
+        regex.regex = true;
+        CHECK(printed(parser.parse_buffer(read_file(path), path.string(), regex)) == printed(parser.parse_file(path.string(), regex)));
+    }
+
+    // one parser is called from many threads at once, thousands of times, and gives every caller its own results
+    vector<thread> callers;
+    vector<size_t> mismatches(8, 0);
+    for (size_t caller = 0; caller < mismatches.size(); caller++)
+    {
+        callers.emplace_back([&, caller]()
+        {
+            for (size_t i = 0; i < 250; i++)
+            {
+                size_t file = (caller + i) % files.size();
+                if (printed(parser.parse_file(files[file].string(), options)) != expected[file])
+                {
+                    mismatches[caller]++;
+                }
+            }
+        });
+    }
+    for (thread &caller : callers)
+    {
+        caller.join();
+    }
+    CHECK(mismatches == vector<size_t>(mismatches.size(), 0));
+
+    // a parser on a pool shared with other work gives the same results, which outlive both
+    parse_result kept;
+    {
+        thread_pool pool(3);
+        camkes_parser shared(pool);
+        kept = shared.parse_file(files[0].string(), options);
+    }
+    CHECK(printed(kept) == expected[0]);
+
+    // quoted imports of a buffer are searched next to its name, and its diagnostics are reported from that name
+    string directory = "library_test_files";
+    filesystem::remove_all(directory);
+    filesystem::create_directory(directory);
+    ofstream(filesystem::path(directory) / "server.camkes") << SERVER_FILE;
+    string name = (filesystem::path(directory) / "main.camkes").string();
+    parse_result imported = parser.parse_buffer(MAIN_FILE, name, options);
+    const node_result *connection = find_node(imported, "s.p");
+    CHECK(imported.ok() && find_node(imported, "s") != nullptr && connection != nullptr);
+    CHECK(connection != nullptr && connection->type == type_t::connection && connection->protocol == protocol_t::propagation);
+    CHECK(connection != nullptr && connection->priority == 7 && connection->thread_count == 1 && connection->requestors == vector<string_view>{"t"});
+    parse_result unresolved = parser.parse_buffer(MAIN_FILE, "elsewhere/main.camkes", options);
+    CHECK(unresolved.parsed && unresolved.ok() && find_node(unresolved, "s") == nullptr);
+    CHECK(unresolved.diags.get_entries().size() == 1 && unresolved.diags.get_entries()[0].file == "elsewhere/main.camkes");
+    filesystem::remove_all(directory);
+
+    // warnings fail the input only with -Werror
+    parse_options strict = options;
+    strict.warnings_as_errors = true;
+    CHECK(!parser.parse_buffer(MAIN_FILE, "elsewhere/main.camkes", strict).ok());
+
+    // a file that cannot be read is not parsed, and the diagnostics say why
+    for (bool regex : {false, true})
+    {
+        parse_options unread = options;
+        unread.regex = regex;
+        parse_result missing = parser.parse_file("library_test_missing.camkes", unread);
+        CHECK(!missing.parsed && !missing.ok() && missing.analysis.nodes.empty() && missing.graph == nullptr);
+        CHECK(missing.diags.get_entries().size() == 1 && missing.diags.get_entries()[0].code == "unreadable-input");
+    }
+
+    return failures == 0 ? 0 : 1;
+}
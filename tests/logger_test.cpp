@@ -0,0 +1,104 @@
+/*
+ *  logger_test.cpp
+ *  behaviour tests of the logger
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "logger.hpp"
+#include <string>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+using namespace std;
+
+// the lines of a log file
+static vector<string> read_lines(const string &file_name)
+{
+    vector<string> lines;
+    ifstream file(file_name);
+    for (string line; getline(file, line);)
+    {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// producers each log numbered messages, many times the capacity of the ring, and every message comes out once,
+// whole, and in the order its producer logged it
+static void check_producers(logger &log, const string &file_name, size_t producers, size_t messages)
+{
+    CHECK(log.open(file_name));
+    vector<thread> threads;
+    for (size_t p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&log, p, messages]()
+        {
+            for (size_t i = 0; i < messages; i++)
+            {
+                LOG_INFO(log, "producer ", p, " message ", i, ' ', string(i % 50, 'x'));
+            }
+        });
+    }
+    for (thread &producer : threads)
+    {
+        producer.join();
+    }
+    log.close();
+
+    vector<size_t> next(producers, 0);
+    bool whole = true;
+    for (const string &line : read_lines(file_name))
+    {
+        size_t p, i;
+        string producer_word, message_word, padding;
+        istringstream fields(line);
+        fields >> producer_word >> p >> message_word >> i;
+        getline(fields, padding);
+        bool valid = fields.eof() && producer_word == "producer" && message_word == "message" && p < producers && padding == " " + string(i % 50, 'x');
+        whole = whole && valid && i == next[p];
+        if (valid)
+        {
+            next[p]++;
+        }
+    }
+    CHECK(whole);
+    CHECK(next == vector<size_t>(producers, messages));
+}
+
+int main()
+{
+    // levels compiled out log nothing, so there is nothing to check
+    if (PARSER_LOG_LEVEL > int(log_level::info))
+    {
+        return 0;
+    }
+    const string file_name = "logger_test.log";
+    const string other_file_name = "logger_test_other.log";
+
+    // a closed logger drops messages, and the arguments are formatted in order
+    logger small(3);
+    LOG_INFO(small, "dropped");
+    CHECK(small.open(file_name));
+    LOG_INFO(small, "value ", 42, ' ', size_t(7), " end");
+    small.close();
+    CHECK(read_lines(file_name) == vector<string>{"value 42 7 end"});
+
+    // the ring of four slots wraps thousands of times, from one producer and from many
+    check_producers(small, file_name, 1, 20000);
+    check_producers(small, file_name, 8, 5000);
+    // a reopened logger keeps its ring and positions and writes to the new file only
+    check_producers(small, other_file_name, 3, 1000);
+    CHECK(read_lines(file_name).size() == 8 * 5000);
+
+    // the default ring, with more producers than hardware threads
+    logger large;
+    check_producers(large, file_name, 32, 2000);
+
+    filesystem::remove(file_name);
+    filesystem::remove(other_file_name);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/*
+ *  macro_table_test.cpp
+ *  behaviour tests of the macro table and its constant expression evaluator
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "macro_table.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+using namespace std;
+
+// whether an expression evaluates to the value
+static bool evaluates(macro_table &macros, string_view expression, int64_t expected)
+{
+    int64_t value = 0;
+    bool evaluated = macros.evaluate(expression, value);
+    if (!evaluated || value != expected)
+    {
+        cerr << expression << " is " << (evaluated ? to_string(value) : "not a constant") << ", expected " << expected << endl;
+    }
+    return evaluated && value == expected;
+}
+
+// whether an expression is not a constant
+static bool fails(macro_table &macros, string_view expression)
+{
+    int64_t value = 0;
+    bool evaluated = macros.evaluate(expression, value);
+    if (evaluated)
+    {
+        cerr << expression << " is " << value << ", expected not a constant" << endl;
+    }
+    return !evaluated;
+}
+
+int main()
+{
+    macro_table macros;
+
+    // the C operators with their precedence and associativity
+    const vector<pair<string_view, int64_t>> EXPRESSIONS = {
+        {"2 + 3 * 4", 14}, {"(2 + 3) * 4", 20}, {"7 - 2 - 1", 4}, {"64 / 4 / 2", 8}, {"-7 / 2", -3}, {"-7 % 3", -1},
+        {"1 << 2 + 1", 8}, {"256 >> 2 >> 1", 32}, {"1 + 2 < 4", 1}, {"3 < 2 == 0", 1}, {"1 | 2 ^ 3 & 4", 3},
+        {"6 & 3 == 3", 0}, {"1 || 0 && 0", 1}, {"(1 || 0) && 0", 0}, {"2 && 3", 1}, {"0 || -5", 1},
+        {"-2 * -3", 6}, {"- - 4", 4}, {"~0", -1}, {"!0 + !5", 1}, {"+3", 3},
+        {"1 ? 2 : 3", 2}, {"0 ? 2 : 1 ? 4 : 5", 4}, {"1 ? 0 ? 6 : 7 : 8", 7}, {"(0 ? 1 : 2) * 3", 6},
+        {"0x1F + 010 + 0b11", 31 + 8 + 3}, {"0", 0}, {"10u + 2UL", 12}, {"9223372036854775807 + 1", INT64_MIN},
+        {" \t( 1 +\\\n 2 ) ", 3}};
+    for (const auto &[expression, expected] : EXPRESSIONS)
+    {
+        CHECK(evaluates(macros, expression, expected));
+    }
+
+    // macros expand to their values, through other macros, defined before or after the macro using them
+    CHECK(macros.define("THREADS", "BASE + 1"));
+    CHECK(macros.define("BASE", "(2 * 3)"));
+    CHECK(macros.define("EMPTY", ""));
+    CHECK(evaluates(macros, "THREADS", 7));
+    CHECK(evaluates(macros, "THREADS * BASE", 42));
+    CHECK(evaluates(macros, "defined THREADS + defined(BASE) + defined MISSING", 2));
+    // a redefinition is reported, and applies to the values derived from the old one
+    CHECK(macros.define("BASE", "(2 * 3)"));
+    CHECK(!macros.define("BASE", "10"));
+    CHECK(evaluates(macros, "THREADS", 11));
+    CHECK(macros.size() == 3 && macros.is_defined("EMPTY") && !macros.is_defined("MISSING"));
+
+    // macros expanding to themselves, directly or through others, are no constants, and neither are the macros using them
+    CHECK(macros.define("SELF", "SELF + 1"));
+    CHECK(macros.define("PING", "PONG * 2"));
+    CHECK(macros.define("PONG", "PING"));
+    CHECK(macros.define("USES_PING", "PING + 1"));
+    for (string_view expression : {"SELF", "PING", "PONG", "USES_PING", "1 + PONG"})
+    {
+        CHECK(fails(macros, expression));
+    }
+    // a recursive macro stays no constant when evaluated again, and other macros keep working
+    CHECK(fails(macros, "SELF"));
+    CHECK(evaluates(macros, "THREADS", 11));
+
+    // expressions that are not constants
+    for (string_view expression : {"", "1 +", "(1", "1)", "()", "1 2", "1 / 0", "5 % 0", "1 << 64", "1 >> -1", "-9223372036854775807 - 1 / -1 * 0 + (-9223372036854775807 - 1) / -1",
+                                   "MISSING", "EMPTY", "defined", "defined(", "defined(BASE", "1 ? 2", "1 ? 2 :", "0x", "12ab", "0b2", "1.5", "18446744073709551616", "f(1)", "1 = 1", "1 ; 2"})
+    {
+        CHECK(fails(macros, expression));
+    }
+
+    // operands of &&, || and ?: that do not decide the result are parsed but not evaluated
+    const vector<pair<string_view, int64_t>> SHORT_CIRCUITS = {
+        {"0 && 1 / 0", 0}, {"1 || 1 / 0", 1}, {"0 && (1 << 64)", 0}, {"1 ? 2 : 1 / 0", 2}, {"0 ? 1 / 0 : 3", 3},
+        {"0 && SELF", 0}, {"1 || PING", 1}, {"0 && 1 / 0 || 4", 1}, {"1 ? 5 : 0 ? 1 / 0 : 1 % 0", 5}, {"(0 && 1 / 0) + 2", 2}};
+    for (const auto &[expression, expected] : SHORT_CIRCUITS)
+    {
+        CHECK(evaluates(macros, expression, expected));
+    }
+    // operands that are evaluated still fail, and operands that are not must still parse and name macros
+    for (string_view expression : {"1 && 1 / 0", "0 || 1 / 0", "0 ? 1 : 1 / 0", "1 ? 1 / 0 : 2", "0 && MISSING", "0 && (1", "1 || 2 3"})
+    {
+        CHECK(fails(macros, expression));
+    }
+    // a recursive macro that is not evaluated is not expanded, and is still no constant afterwards
+    CHECK(evaluates(macros, "0 && PONG", 0) && fails(macros, "PONG"));
+
+    // in a condition, identifiers that are not macros are 0
+    int64_t value = 0;
+    CHECK(macros.evaluate_condition("MISSING", value) && value == 0);
+    CHECK(macros.evaluate_condition("!MISSING && THREADS == 11", value) && value == 1);
+    CHECK(macros.evaluate_condition("defined(MISSING) || MISSING + 2", value) && value == 1);
+    CHECK(!macros.evaluate_condition("SELF", value) && !macros.evaluate_condition("MISSING +", value) && !macros.evaluate_condition("", value));
+
+    return failures == 0 ? 0 : 1;
+}
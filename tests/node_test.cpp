@@ -0,0 +1,117 @@
+/*
+ *  node_test.cpp
+ *  behaviour tests of the node attributes stored by the graph
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "graph.hpp"
+#include <string>
+#include <vector>
+#include <sstream>
+#include <random>
+
+using namespace std;
+
+int main()
+{
+    // attributes are stored by value, interned, and carried over to the frozen graph
+    frozen_graph frozen;
+    uint32_t task, server, port, other_port, dispatched;
+    diagnostics diags;
+    {
+        graph g;
+        g.diags = &diags;
+        g.files = {"node_test.camkes", "imported.camkes"};
+        // names and identifiers are built in temporaries, the graph keeps its own copies
+        string name = "task";
+        task = g.add_component(name, source_location{0, 1});
+        name = "server";
+        server = g.add_component(name, source_location{1, 2});
+        string macro = "THREADS";
+        port = g.add_connection(string("conn"), name, string("p"), macro, UNKNOWN_THREADS, source_location{0, 3});
+        other_port = g.add_connection("fixed_conn", "server", "q", "2", 2, source_location{0, 4});
+        dispatched = g.add_component("dispatched", source_location{0, 5});
+        name = "overwritten";
+        macro = "overwritten";
+
+        // nodes added again keep their first attributes, whatever the kind asked for
+        CHECK(g.add_component("server", source_location{0, 9}) == server);
+        CHECK(g.add_connection("again", "server", "p", "3", 3, source_location{0, 9}) == port);
+        CHECK(g.add_component("server.p", source_location{0, 9}) == port);
+        CHECK(g.size() == 5 && g.get_kind(port) == type_t::connection && g.get_kind(server) == type_t::component);
+        CHECK(g.find("server", "p") == port && g.find("server", "r") == NO_NODE && g.get_identifier(port) == "server.p");
+
+        g.set_priority(task, 9);
+        g.set_priority(dispatched, 4);
+        g.set_protocol(port, "inherited", source_location{0, 6});
+        g.set_protocol(other_port, "fixed", source_location{0, 7});
+        // an unknown protocol is reported and the protocol already set is kept
+        g.set_protocol(other_port, "unknown", source_location{1, 8});
+        g.set_timing(task, timing_t::execution_time, 3);
+        g.set_timing(task, timing_t::period, 100);
+        g.set_timing(task, timing_t::release_time, 5);
+        g.set_timing(port, timing_t::execution_time_post, 4);
+        g.set_timing(dispatched, timing_t::period, 50);
+        // a dispatched task takes only the times it does not set itself
+        g.dispatch(task, dispatched);
+
+        // an edge added twice is stored once
+        CHECK(g.add_edge("task", "server.p") && g.add_edge("task", "server.p") && g.add_edge("server.p", "server"));
+        CHECK(g.add_edge("dispatched", "server.q") && g.add_edge("server.q", "server"));
+        frozen = g.freeze();
+    }
+
+    CHECK(frozen.size() == 5);
+    CHECK(frozen.identifiers[task] == "task" && frozen.identifiers[server] == "server" && frozen.identifiers[port] == "server.p");
+    CHECK(frozen.names[port] == "conn" && frozen.names[other_port] == "fixed_conn" && frozen.names[server] == "server");
+    CHECK(frozen.types[task] == type_t::task && frozen.types[dispatched] == type_t::task && frozen.types[server] == type_t::component && frozen.types[port] == type_t::connection);
+    CHECK(frozen.protocols[task] == protocol_t::none && frozen.protocols[port] == protocol_t::pip && frozen.protocols[other_port] == protocol_t::ipcp);
+    CHECK(frozen.assigned_priorities[task] == 9 && frozen.assigned_priorities[dispatched] == 4 && frozen.assigned_priorities[server] == DEFAULT_PRIORITY);
+    CHECK(frozen.thread_macros[port] == "THREADS" && frozen.declared_threads[port] == UNKNOWN_THREADS);
+    CHECK(frozen.thread_macros[other_port] == "2" && frozen.declared_threads[other_port] == 2);
+    CHECK(frozen.thread_macros[server].empty() && frozen.declared_threads[server] == UNKNOWN_THREADS);
+    CHECK(frozen.timings[task].execution_time == 3 && frozen.timings[task].execution_time_post == UNKNOWN_TIME);
+    CHECK(frozen.timings[port].execution_time_post == 4 && frozen.timings[port].period == UNKNOWN_TIME);
+    CHECK(frozen.timings[dispatched].period == 50 && frozen.timings[dispatched].release_time == 5 && frozen.timings[dispatched].execution_time == UNKNOWN_TIME);
+    CHECK(frozen.locations[server].file == 1 && frozen.locations[server].line == 2 && frozen.get_file(server) == "imported.camkes");
+    CHECK(frozen.requestor_count(port) == 1 && frozen.requestor_count(server) == 2 && frozen.requestor_count(task) == 0);
+    CHECK(diags.get_entries().size() == 1 && diags.get_entries()[0].code == "unknown-protocol" && diags.get_entries()[0].file == "imported.camkes");
+
+    // the analyses read the stored attributes, each kind through its own kernel
+    diagnostics analysed;
+    frozen.diags = &analysed;
+    analysis_result analysis = frozen.analyse(true);
+    CHECK(frozen.get_priority(port) == 9 && frozen.get_priority(other_port) == 4 && frozen.get_priority(server) == 9);
+    CHECK(frozen.get_thread_count(task) == 1 && frozen.get_thread_count(port) == 1 && frozen.get_thread_count(other_port) == 1);
+    CHECK(analysis.nodes.size() == 5 && analysis.storage != nullptr);
+
+    // many nodes get dense ids in insertion order, and every edge added between them is kept
+    mt19937_64 random(1);
+    graph large;
+    large.diags = &diags;
+    ostringstream cycles;
+    large.output = &cycles;
+    const uint32_t COUNT = 100000;
+    for (uint32_t i = 0; i < COUNT; i++)
+    {
+        CHECK(large.add_component("c" + to_string(i), source_location{0, i + 1}) == i);
+    }
+    size_t edges = 0;
+    for (uint32_t i = 1; i < COUNT; i++)
+    {
+        // requestors come before the node they request, so no edge closes a cycle
+        uint32_t requestor = random() % i;
+        edges += large.add_edge("c" + to_string(requestor), "c" + to_string(i));
+    }
+    frozen_graph large_frozen = large.freeze();
+    CHECK(large_frozen.size() == COUNT && large_frozen.requestor_ids.size() == edges && edges == COUNT - 1 && cycles.str().empty());
+    bool located = true;
+    for (uint32_t i = 0; i < COUNT; i++)
+    {
+        located = located && large_frozen.identifiers[i] == "c" + to_string(i) && large_frozen.locations[i].line == i + 1;
+    }
+    CHECK(located);
+
+    return failures == 0 ? 0 : 1;
+}
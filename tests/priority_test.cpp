@@ -0,0 +1,134 @@
+/*
+ *  priority_test.cpp
+ *  behaviour tests of the priority propagation
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "random_configuration.hpp"
+#include "camkes_parser.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+using namespace std;
+
+// the propagated priority of a node from the configuration, the largest priority of the tasks reaching it, searched top-down
+static size_t expected_priority(const random_configuration &generated, const string &identifier, unordered_map<string, size_t> &memo)
+{
+    auto it = memo.find(identifier);
+    if (it != memo.end())
+    {
+        return it->second;
+    }
+    size_t priority;
+    if (identifier[0] == 't')
+    {
+        priority = generated.priorities[stoul(identifier.substr(1))];
+    }
+    else
+    {
+        // a server has the priority of its port, which has the largest priority of its requestors
+        size_t server = stoul(identifier.substr(1, identifier.find('.') - 1));
+        priority = 0;
+        for (const string &requestor : generated.requestors[server])
+        {
+            priority = max(priority, expected_priority(generated, requestor, memo));
+        }
+    }
+    memo.emplace(identifier, priority);
+    return priority;
+}
+
+// the analysed nodes by identifier
+static unordered_map<string_view, const node_result *> nodes_by_identifier(const analysis_result &analysis)
+{
+    unordered_map<string_view, const node_result *> nodes;
+    for (const node_result &node : analysis.nodes)
+    {
+        nodes.emplace(node.identifier, &node);
+    }
+    return nodes;
+}
+
+// the requestors and priorities of every node match those computed from the configuration, with and without the ladder
+static void check_configuration(const camkes_parser &parser, const random_shape &shape)
+{
+    random_configuration generated = generate_random_configuration(shape);
+    for (bool ladder : {false, true})
+    {
+        parse_options options;
+        options.ladder = ladder;
+        parse_result result = parser.parse_buffer(generated.text, "random.camkes", options);
+        CHECK(result.parsed);
+        unordered_map<string_view, const node_result *> nodes = nodes_by_identifier(result.analysis);
+        CHECK(nodes.size() == shape.tasks + 2 * shape.servers);
+        unordered_map<string, size_t> memo;
+        for (size_t i = 0; i < shape.tasks; i++)
+        {
+            string task = "t" + to_string(i);
+            CHECK(nodes.count(task) == 1 && nodes[task]->type == type_t::task && nodes[task]->priority == generated.priorities[i]);
+        }
+        for (size_t j = 0; j < shape.servers; j++)
+        {
+            string server = "s" + to_string(j);
+            string port = server + ".p";
+            CHECK(nodes.count(server) == 1 && nodes.count(port) == 1);
+            if (nodes.count(server) == 0 || nodes.count(port) == 0)
+            {
+                continue;
+            }
+            vector<string> requestors(nodes[port]->requestors.begin(), nodes[port]->requestors.end());
+            vector<string> expected = generated.requestors[j];
+            sort(requestors.begin(), requestors.end());
+            sort(expected.begin(), expected.end());
+            CHECK(requestors == expected);
+            CHECK(nodes[server]->requestors == vector<string_view>{port});
+            size_t priority = expected_priority(generated, port, memo) + ladder;
+            CHECK(nodes[port]->priority == priority);
+            CHECK(nodes[server]->priority == priority);
+        }
+    }
+}
+
+int main()
+{
+    camkes_parser parser(2);
+
+    // random graphs with diamonds and nodes reached by several tasks
+    for (uint64_t seed = 1; seed <= 50; seed++)
+    {
+        random_shape shape;
+        shape.seed = seed;
+        check_configuration(parser, shape);
+        shape.tasks = 3;
+        shape.servers = 40;
+        shape.max_requestors = 4;
+        check_configuration(parser, shape);
+    }
+
+    // a chain deeper than a recursion through the requestors could go, each server requested by the one before
+    const size_t DEPTH = 20000;
+    string text = "assembly {\n\tcomposition {\n\t\tcomponent Task t;\n";
+    string configuration = "\t\tt._priority = 7;\n";
+    for (size_t j = 0; j < DEPTH; j++)
+    {
+        string server = "s" + to_string(j);
+        string requestor = j == 0 ? "t" : "s" + to_string(j - 1);
+        text += "\t\tcomponent Server " + server + ";\n";
+        text += "\t\tconnection rpc() c" + to_string(j) + "(from " + requestor + ".r, to " + server + ".p);\n";
+        configuration += "\t\t" + server + ".p_priority_protocol = \"propagated\";\n";
+    }
+    text += "\t}\n\tconfiguration {\n" + configuration + "\t}\n}\n";
+    // the cycles are checked once all edges are in, checking on every edge searches the whole chain each time
+    parse_options options;
+    options.batch_edges = true;
+    parse_result result = parser.parse_buffer(text, "chain.camkes", options);
+    CHECK(result.ok());
+    CHECK(result.analysis.nodes.size() == 2 * DEPTH + 1);
+    CHECK(all_of(result.analysis.nodes.begin(), result.analysis.nodes.end(), [](const node_result &node) { return node.priority == 7; }));
+
+    return failures == 0 ? 0 : 1;
+}
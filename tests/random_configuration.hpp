@@ -0,0 +1,98 @@
+/*
+ *  random_configuration.hpp
+ *  header file for the random configurations of the behaviour tests
+ *  author: jordan sun
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cstddef>
+
+// Shape of a random configuration: tasks t0, t1, ... and servers s0, s1, ..., each server with one port p whose
+// connection is requested by tasks and by servers before it, so the configuration has no cycle.
+struct random_shape
+{
+    size_t tasks = 8;
+    size_t servers = 16;
+    // requestors of each server port, at least one
+    size_t max_requestors = 3;
+    uint64_t seed = 1;
+};
+
+// The configuration as generated, to check the analysis against.
+struct random_configuration
+{
+    std::string text;
+    // priority of each task
+    std::vector<size_t> priorities;
+    // requestors of each server port, as identifiers
+    std::vector<std::vector<std::string>> requestors;
+    // protocol of each server port, as written in the configuration
+    std::vector<std::string> protocols;
+};
+
+// the text of a configuration, written again from its priorities, requestors and protocols after they are edited
+inline std::string configuration_text(const random_configuration &generated)
+{
+    std::string composition;
+    std::string configuration;
+    for (size_t i = 0; i < generated.priorities.size(); i++)
+    {
+        std::string task = "t" + std::to_string(i);
+        composition += "\t\tcomponent Task " + task + ";\n";
+        configuration += "\t\t" + task + "._priority = " + std::to_string(generated.priorities[i]) + ";\n";
+    }
+    for (size_t j = 0; j < generated.requestors.size(); j++)
+    {
+        std::string server = "s" + std::to_string(j);
+        composition += "\t\tcomponent Server " + server + ";\n";
+        composition += "\t\tconnection rpc() c" + std::to_string(j) + "(";
+        for (const std::string &requestor : generated.requestors[j])
+        {
+            composition += "from " + requestor + ".r_" + server + ", ";
+        }
+        composition += "to " + server + ".p);\n";
+        configuration += "\t\t" + server + ".p_priority_protocol = \"" + generated.protocols[j] + "\";\n";
+    }
+    return "assembly {\n\tcomposition {\n" + composition + "\t}\n\tconfiguration {\n" + configuration + "\t}\n}\n";
+}
+
+// generate a configuration of the shape, with a random priority for each task and protocol for each server port
+inline random_configuration generate_random_configuration(const random_shape &shape)
+{
+    static const char *const PROTOCOLS[] = {"fixed", "inherited", "propagated"};
+    std::mt19937_64 random(shape.seed);
+    random_configuration generated;
+    for (size_t i = 0; i < shape.tasks; i++)
+    {
+        generated.priorities.push_back(1 + random() % 254);
+    }
+    for (size_t j = 0; j < shape.servers; j++)
+    {
+        // requestors are drawn from the tasks and the servers before this one, without repeats
+        std::vector<std::string> requestors;
+        size_t count = 1 + random() % shape.max_requestors;
+        for (size_t k = 0; k < count; k++)
+        {
+            size_t pick = random() % (shape.tasks + j);
+            std::string requestor = pick < shape.tasks ? "t" + std::to_string(pick) : "s" + std::to_string(pick - shape.tasks);
+            bool repeated = false;
+            for (const std::string &other : requestors)
+            {
+                repeated = repeated || other == requestor;
+            }
+            if (!repeated)
+            {
+                requestors.push_back(requestor);
+            }
+        }
+        generated.requestors.push_back(requestors);
+        generated.protocols.push_back(PROTOCOLS[random() % 3]);
+    }
+    generated.text = configuration_text(generated);
+    return generated;
+}
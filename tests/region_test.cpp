@@ -0,0 +1,114 @@
+/*
+ *  region_test.cpp
+ *  behaviour tests of analysing the regions of a graph concurrently
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include "emitter.hpp"
+#include <string>
+#include <vector>
+#include <sstream>
+#include <random>
+
+using namespace std;
+
+// the graph with the threads behind each count and the diagnostics, as the command line prints them
+static string printed(const parse_result &result)
+{
+    ostringstream output;
+    CHECK(result.parsed);
+    if (result.parsed)
+    {
+        emit(result.analysis, output_format::text, true, output);
+        result.diags.print(output);
+    }
+    return output.str();
+}
+
+// Regions r0, r1, ... sharing no node, each of tasks and servers requested by the tasks and servers before them.
+// Some server ports get no protocol, so every job reports errors of its own, and servers with two ports are warned about.
+static string random_regions(const vector<size_t> &region_servers, uint64_t seed)
+{
+    static const char *const PROTOCOLS[] = {"fixed", "inherited", "propagated"};
+    mt19937_64 random(seed);
+    string composition;
+    string configuration;
+    for (size_t region = 0; region < region_servers.size(); region++)
+    {
+        string prefix = "r" + to_string(region) + "_";
+        size_t tasks = 1 + random() % 3;
+        vector<string> requestors;
+        for (size_t i = 0; i < tasks; i++)
+        {
+            string task = prefix + "t" + to_string(i);
+            composition += "\t\tcomponent Task " + task + ";\n";
+            configuration += "\t\t" + task + "._priority = " + to_string(1 + random() % 254) + ";\n";
+            requestors.push_back(task);
+        }
+        for (size_t j = 0; j < region_servers[region]; j++)
+        {
+            string server = prefix + "s" + to_string(j);
+            composition += "\t\tcomponent Server " + server + ";\n";
+            size_t ports = random() % 8 == 0 ? 2 : 1;
+            for (size_t port = 0; port < ports; port++)
+            {
+                string port_name = "p" + to_string(port);
+                composition += "\t\tconnection rpc() " + server + "_c" + to_string(port) + "(";
+                size_t count = 1 + random() % 3;
+                for (size_t k = 0; k < count; k++)
+                {
+                    composition += "from " + requestors[random() % requestors.size()] + ".r_" + server + "_" + to_string(port) + "_" + to_string(k) + ", ";
+                }
+                composition += "to " + server + "." + port_name + ");\n";
+                if (random() % 10 != 0)
+                {
+                    configuration += "\t\t" + server + "." + port_name + "_priority_protocol = \"" + PROTOCOLS[random() % 3] + "\";\n";
+                }
+            }
+            requestors.push_back(server);
+        }
+    }
+    return "assembly {\n\tcomposition {\n" + composition + "\t}\n\tconfiguration {\n" + configuration + "\t}\n}\n";
+}
+
+int main()
+{
+    camkes_parser sequential(1);
+    camkes_parser concurrent(4);
+    parse_options options;
+    options.trace = true;
+
+    // a graph without nodes has no region to analyse
+    parse_result empty = concurrent.parse_buffer("", "empty.camkes", options);
+    CHECK(empty.ok() && empty.analysis.nodes.empty());
+
+    // many small regions packed into jobs, single nodes, and regions larger than a job, which are never split
+    // the results and diagnostics merged from the jobs are those of a run in one thread, in the same order
+    for (uint64_t seed = 1; seed <= 4; seed++)
+    {
+        vector<size_t> region_servers;
+        mt19937_64 random(seed);
+        size_t regions = 40 + random() % 120;
+        for (size_t region = 0; region < regions; region++)
+        {
+            size_t shape = random() % 20;
+            region_servers.push_back(shape == 0 ? 0 : shape == 1 ? 1000 + random() % 500 : random() % 12);
+        }
+        string contents = random_regions(region_servers, seed);
+        string alone = printed(sequential.parse_buffer(contents, "regions.camkes", options));
+        CHECK(alone.find("has no protocol set") != string::npos && alone.find("more than one input port") != string::npos);
+        for (size_t run = 0; run < 2; run++)
+        {
+            string together = printed(concurrent.parse_buffer(contents, "regions.camkes", options));
+            if (together != alone)
+            {
+                cerr << "seed " << seed << ": analysing the regions concurrently changes the output" << endl;
+            }
+            CHECK(together == alone);
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
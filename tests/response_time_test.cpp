@@ -0,0 +1,243 @@
+/*
+ *  response_time_test.cpp
+ *  behaviour tests of the response time analysis
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include "response_time_analysis.hpp"
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <random>
+
+using namespace std;
+
+// solve the response times one task at a time in integers, with the ceiling as a division rounding up
+static vector<size_t> reference_response_times(const vector<size_t> &execution_times, const vector<size_t> &blocking, const vector<size_t> &periods, const vector<uint32_t> &group_starts)
+{
+    size_t n = periods.size();
+    vector<size_t> responses(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t response = execution_times[i] + blocking[i];
+        while (response <= periods[i])
+        {
+            size_t next = execution_times[i] + blocking[i];
+            for (size_t j = 0; j < n; j++)
+            {
+                if (j != i && group_starts[j] <= i)
+                {
+                    next += (response + periods[j] - 1) / periods[j] * execution_times[j];
+                }
+            }
+            if (next == response)
+            {
+                break;
+            }
+            response = next;
+        }
+        responses[i] = response;
+    }
+    return responses;
+}
+
+// the solver gives the same response times as the reference, including where a task stopped past its period
+static bool same_as_reference(const vector<size_t> &execution_times, const vector<size_t> &blocking, const vector<size_t> &periods, const vector<uint32_t> &group_starts)
+{
+    task_set set;
+    set.execution_times.assign(execution_times.begin(), execution_times.end());
+    set.blocking.assign(blocking.begin(), blocking.end());
+    set.periods.assign(periods.begin(), periods.end());
+    set.group_starts = group_starts;
+    vector<double> responses = solve_response_times(set);
+    vector<size_t> expected = reference_response_times(execution_times, blocking, periods, group_starts);
+    for (size_t i = 0; i < periods.size(); i++)
+    {
+        if (responses[i] != double(expected[i]))
+        {
+            cerr << "task " << i << " responds in " << size_t(responses[i]) << " rather than " << expected[i] << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// analyse a configuration, recording the diagnostics of the analysis with those of the parse
+static schedulability_result analyse(parse_result &result)
+{
+    CHECK(result.parsed);
+    if (!result.parsed)
+    {
+        return schedulability_result();
+    }
+    return response_time_analysis(*result.graph).analyse(result.diags);
+}
+
+// whether a deadline miss of the task was reported
+static bool deadline_missed(const parse_result &result, const string &task)
+{
+    for (const diagnostic &entry : result.diags.get_entries())
+    {
+        if (entry.code == "deadline-miss" && entry.subject == task)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *const MISSED_DEADLINE = R"(
+assembly {
+    composition {
+        component Task a;
+        component Task b;
+    }
+    configuration {
+        a._priority = 10;
+        a.execution_time_pre = 30;
+        a.period = 100;
+        b._priority = 5;
+        b.execution_time_pre = 80;
+        b.period = 120;
+    }
+}
+)";
+
+const char *const DISPATCHED = R"(
+assembly {
+    composition {
+        component Timer timer;
+        component Task handler;
+        component Task own;
+        component Task orphan;
+        component Task notified;
+        component Server s;
+        connection rpc() c(from handler.r, to s.p);
+        connection seL4RPCCall d1(from timer.tick, to handler.run);
+        connection seL4RPCCall d2(from timer.tick, to own.run);
+        connection seL4RPCCall d3(from missing.tick, to orphan.run);
+        connection seL4Notification d4(from timer.tick, to notified.run);
+    }
+    configuration {
+        timer.period = 100;
+        timer.release_time = 7;
+        handler._priority = 5;
+        own._priority = 4;
+        own.period = 40;
+        s.p_priority_protocol = "fixed";
+    }
+}
+)";
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        cerr << "Usage: " << argv[0] << " <test files directory>" << endl;
+        return 1;
+    }
+    camkes_parser parser(2);
+
+    // t1 and t2 call l1a, which calls l2.r1 and l2.r2, both calling l3, so each call of theirs costs 25 more
+    // t1 and t2 share priority 8 and interfere with each other: 26 + 21 + 203 = 250 and 203 + 21 + 26 = 250,
+    // t4 below them: 40 + 46 + 26 + 203 = 315, t3 at the bottom, never blocked: 4459 + 26 + 203 + 40 = 4728
+    parse_result result = parser.parse_file((filesystem::path(argv[1]) / "ipcp_pip_prop_1_0.camkes").string(), parse_options());
+    schedulability_result responses = analyse(result);
+    CHECK(responses.schedulable);
+    CHECK(responses.tasks.size() == 4);
+    if (responses.tasks.size() == 4)
+    {
+        const vector<string> identifiers = {"t1", "t2", "t4", "t3"};
+        const vector<size_t> execution_times = {26, 203, 40, 4459};
+        const vector<size_t> blocking = {21, 21, 46, 0};
+        const vector<size_t> response_times = {250, 250, 315, 4728};
+        for (size_t i = 0; i < 4; i++)
+        {
+            const task_response &task = responses.tasks[i];
+            CHECK(task.identifier == identifiers[i]);
+            CHECK(task.execution_time == execution_times[i]);
+            CHECK(task.blocking == blocking[i]);
+            CHECK(task.response_time == response_times[i]);
+            CHECK(task.schedulable);
+        }
+    }
+    CHECK(result.diags.error_count() == 0);
+
+    // b is interfered with by two jobs of a, 80 + 2 * 30 = 140, past its period of 120
+    result = parser.parse_buffer(MISSED_DEADLINE, "missed_deadline.camkes", parse_options());
+    responses = analyse(result);
+    CHECK(!responses.schedulable);
+    CHECK(responses.tasks.size() == 2);
+    if (responses.tasks.size() == 2)
+    {
+        CHECK(responses.tasks[0].identifier == "a" && responses.tasks[0].response_time == 30 && responses.tasks[0].schedulable);
+        CHECK(responses.tasks[1].identifier == "b" && responses.tasks[1].response_time == 140 && !responses.tasks[1].schedulable);
+    }
+    CHECK(deadline_missed(result, "b"));
+    CHECK(!deadline_missed(result, "a"));
+    CHECK(result.diags.error_count() == 1);
+
+    // a task released over seL4RPCCall takes the period and release time of its dispatcher it does not set itself,
+    // a dispatcher that is not declared and a connection that is not seL4RPCCall release nothing
+    result = parser.parse_buffer(DISPATCHED, "dispatched.camkes", parse_options());
+    CHECK(result.ok() && result.diags.get_entries().empty());
+    if (result.parsed)
+    {
+        const frozen_graph &frozen = *result.graph;
+        const node_timing &handler = frozen.timings[frozen.find("handler")];
+        const node_timing &own = frozen.timings[frozen.find("own")];
+        CHECK(handler.period == 100 && handler.release_time == 7);
+        CHECK(own.period == 40 && own.release_time == 7);
+        for (const char *task : {"orphan", "notified"})
+        {
+            CHECK(frozen.timings[frozen.find(task)].period == UNKNOWN_TIME && frozen.timings[frozen.find(task)].release_time == UNKNOWN_TIME);
+        }
+        CHECK(frozen.timings[frozen.find("timer")].period == 100 && frozen.find("missing") == NO_NODE);
+    }
+
+    // the rounded ceiling where a response time is one below, at and one above a multiple of the period of a higher task,
+    // from small periods to large ones, where the quotient is no longer exact
+    for (size_t period : {size_t(1), size_t(2), size_t(3), size_t(7), size_t(100), size_t(99991), size_t(1) << 30, (size_t(1) << 40) + 3})
+    {
+        for (size_t multiple = 1; multiple <= 5; multiple++)
+        {
+            for (int offset : {-1, 0, 1})
+            {
+                size_t start = multiple * period + offset;
+                if (start == 0)
+                {
+                    continue;
+                }
+                for (size_t cost : {size_t(1), period})
+                {
+                    // the lower task starts from its own time and blocking at the boundary, and has room to settle or stop
+                    CHECK(same_as_reference({cost, start - start / 2}, {0, start / 2}, {period, 8 * multiple * period + 8}, {0, 1}));
+                }
+            }
+        }
+    }
+
+    // random task sets, with periods that are multiples of each other so response times often land on them
+    mt19937_64 random(1);
+    const size_t PERIODS[] = {10, 20, 25, 50, 100, 200, 250, 500, 1000};
+    for (size_t round = 0; round < 2000; round++)
+    {
+        size_t n = 1 + random() % 12;
+        vector<size_t> execution_times;
+        vector<size_t> blocking;
+        vector<size_t> periods;
+        vector<uint32_t> group_starts;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            periods.push_back(PERIODS[random() % 9] * (1 + random() % 3));
+            execution_times.push_back(1 + random() % (periods.back() / 4));
+            blocking.push_back(random() % 10);
+            group_starts.push_back(i > 0 && random() % 3 == 0 ? group_starts[i - 1] : i);
+        }
+        CHECK(same_as_reference(execution_times, blocking, periods, group_starts));
+    }
+
+    return failures == 0 ? 0 : 1;
+}
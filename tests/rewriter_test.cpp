@@ -0,0 +1,164 @@
+/*
+ *  rewriter_test.cpp
+ *  behaviour tests of the configuration rewriter
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include "rewriter.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+// read a whole file, empty if it cannot be read
+static string read_file(const string &path)
+{
+    ifstream input_file(path, ios::binary);
+    ostringstream contents;
+    contents << input_file.rdbuf();
+    return contents.str();
+}
+
+// replace the values of a configuration with those computed from it, as if it were the file at name
+static string rewrite(const camkes_parser &parser, const string &contents, const string &name, const parse_options &options)
+{
+    parse_result result = parser.parse_buffer(contents, name, options);
+    CHECK(result.parsed);
+    string output;
+    if (result.parsed)
+    {
+        rewrite_configuration(contents.data(), contents.data() + contents.size(), *result.graph, output);
+    }
+    return output;
+}
+
+// get the lines of a text
+static vector<string> split_lines(const string &text)
+{
+    vector<string> lines;
+    istringstream stream(text);
+    string line;
+    while (getline(stream, line))
+    {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+const char *const NESTED = R"(component Inner {
+    composition {
+        component Task worker;
+        component Server store;
+        connection rpc() inner_c(from worker.r, to store.p);
+        export store.p -> p;
+    }
+    configuration {
+        worker._priority = 5;
+        store.p_priority_protocol = "propagated";
+        store.p_priority = 0;
+    }
+}
+component Outer {
+    composition {
+        component Inner front;
+        component Inner back;
+        export front.p -> front_p;
+    }
+}
+assembly {
+    composition {
+        component Task t;
+        component Outer o;
+        connection rpc() c(from t.r, to o.front_p);
+    }
+    configuration {
+        t._priority = 9;
+        o.front_p_priority = 0;
+        o.back_p_priority = 0;
+        store.p_priority = 0;
+    }
+}
+)";
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        cerr << "Usage: " << argv[0] << " <test files directory>" << endl;
+        return 1;
+    }
+    camkes_parser parser(2);
+
+    // rewriting a rewritten configuration changes nothing, with and without the ladder
+    vector<string> inputs;
+    for (const filesystem::directory_entry &entry : filesystem::directory_iterator(argv[1]))
+    {
+        if (entry.path().extension() == ".camkes")
+        {
+            inputs.push_back(entry.path().string());
+        }
+    }
+    sort(inputs.begin(), inputs.end());
+    CHECK(inputs.size() == 8);
+    for (const string &input : inputs)
+    {
+        for (bool ladder : {false, true})
+        {
+            parse_options options;
+            options.ladder = ladder;
+            string once = rewrite(parser, read_file(input), input, options);
+            string twice = rewrite(parser, once, input, options);
+            CHECK(!once.empty());
+            CHECK(once == twice);
+        }
+    }
+
+    // only the computed values are replaced, every other line is copied through
+    string input = (filesystem::path(argv[1]) / "ipcp_prop_pip_1_0.camkes").string();
+    string original = read_file(input);
+    string once = rewrite(parser, original, input, parse_options());
+    vector<string> original_lines = split_lines(original);
+    vector<string> once_lines = split_lines(once);
+    CHECK(original_lines.size() == once_lines.size());
+    vector<string> changed;
+    for (size_t i = 0; i < min(original_lines.size(), once_lines.size()); i++)
+    {
+        if (original_lines[i] != once_lines[i])
+        {
+            changed.push_back(once_lines[i]);
+        }
+    }
+    CHECK((changed == vector<string>{"#define l3_num_threads 4", "l1a.r_priority = 6;", "l1b.r_priority = 10;", "l2.r1_priority = 10;", "l2.r2_priority = 10;", "l3.r_priority = 10;"}));
+
+    // ports are resolved through the compositions, through every instance of a composite type, and through the exports
+    string nested = rewrite(parser, NESTED, "rewriter_test.camkes", parse_options());
+    vector<string> nested_lines = split_lines(nested);
+    CHECK(nested_lines.size() == 33 && nested_lines[10] == "        store.p_priority = 9;" && nested_lines[28] == "        o.front_p_priority = 9;");
+    // a port not exported, and a port named outside the scope it is declared in, are left alone
+    CHECK(nested_lines.size() == 33 && nested_lines[29] == "        o.back_p_priority = 0;" && nested_lines[30] == "        store.p_priority = 0;");
+    string nested_again = rewrite(parser, nested, "rewriter_test.camkes", parse_options());
+    CHECK(nested_again == nested);
+
+    // the output file is only written when its contents change
+    string path = "rewriter_test.camkes";
+    filesystem::remove(path);
+    bool written = false;
+    CHECK(write_if_changed(path, once, written) && written);
+    // back-date the file, so a rewrite would show even within the timestamp resolution
+    filesystem::file_time_type old_time = filesystem::last_write_time(path) - chrono::hours(1);
+    filesystem::last_write_time(path, old_time);
+    CHECK(write_if_changed(path, once, written) && !written);
+    CHECK(filesystem::last_write_time(path) == old_time);
+    CHECK(write_if_changed(path, original, written) && written);
+    CHECK(read_file(path) == original);
+    filesystem::remove(path);
+
+    return failures == 0 ? 0 : 1;
+}
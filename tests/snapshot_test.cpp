@@ -0,0 +1,191 @@
+/*
+ *  snapshot_test.cpp
+ *  behaviour tests of the snapshot cache
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "camkes_parser.hpp"
+#include "snapshot_cache.hpp"
+#include "emitter.hpp"
+#include "hash.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+using namespace std;
+
+const string DIRECTORY = "snapshot_test_files";
+const string CACHE_DIR = "snapshot_test_files/cache";
+
+// write a file of the test directory
+static void write_file(const string &name, const string &contents)
+{
+    ofstream(filesystem::path(DIRECTORY) / name, ios::binary | ios::trunc) << contents;
+}
+
+// the graph, the diagnostics and the rejected edges, as the command line prints them
+static string printed(const parse_result &result)
+{
+    ostringstream output;
+    CHECK(result.parsed);
+    if (result.parsed)
+    {
+        emit(result.analysis, output_format::text, true, output);
+        result.diags.print(output);
+        output << result.cycles;
+    }
+    return output.str();
+}
+
+// parse the main file through the cache
+static string parse(const camkes_parser &parser, const vector<string> &include_paths)
+{
+    parse_options options;
+    options.cache_dir = CACHE_DIR;
+    options.include_paths = include_paths;
+    options.trace = true;
+    return printed(parser.parse_file((filesystem::path(DIRECTORY) / "main.camkes").string(), options));
+}
+
+// whether the snapshot of the main file is used
+static bool cached(const vector<string> &include_paths)
+{
+    frozen_graph frozen;
+    string output;
+    vector<diagnostic> messages;
+    return snapshot_cache(CACHE_DIR).load((filesystem::path(DIRECTORY) / "main.camkes").string(), include_paths, frozen, output, messages);
+}
+
+// the only snapshot in the cache
+static filesystem::path snapshot_path()
+{
+    vector<filesystem::path> snapshots;
+    for (const filesystem::directory_entry &entry : filesystem::directory_iterator(CACHE_DIR))
+    {
+        snapshots.push_back(entry.path());
+    }
+    CHECK(snapshots.size() == 1);
+    return snapshots.empty() ? filesystem::path() : snapshots[0];
+}
+
+// read the snapshot, or write it back changed
+static string read_snapshot()
+{
+    ostringstream contents;
+    contents << ifstream(snapshot_path(), ios::binary).rdbuf();
+    return contents.str();
+}
+
+static void write_snapshot(const string &contents)
+{
+    ofstream(snapshot_path(), ios::binary | ios::trunc) << contents;
+}
+
+const char *const MAIN_FILE = R"(
+import "server.camkes";
+import "extra.camkes";
+assembly {
+    composition {
+        component Task t;
+        connection rpc() c(from t.r, to s.p);
+    }
+    configuration {
+        t._priority = 7;
+        t.execution_time_pre = 3;
+        t.period = 50;
+        s.p_priority_protocol = "inherited";
+        s.p_execution_time = 2;
+    }
+}
+)";
+
+const char *const SERVER_FILE = R"(
+assembly {
+    composition {
+        component Server s;
+    }
+}
+)";
+
+const char *const EXTRA_FILE = R"(
+assembly {
+    composition {
+        component Task u;
+        connection rpc() d(from u.r, to s.q);
+    }
+    configuration {
+        u._priority = 9;
+        s.q_priority_protocol = "fixed";
+    }
+}
+)";
+
+int main()
+{
+    filesystem::remove_all(DIRECTORY);
+    filesystem::create_directories(filesystem::path(DIRECTORY) / "include");
+    write_file("main.camkes", MAIN_FILE);
+    write_file("server.camkes", SERVER_FILE);
+    camkes_parser parser(2);
+    const vector<string> include_paths = {(filesystem::path(DIRECTORY) / "include").string()};
+
+    // the first parse writes the snapshot, the next one reads it and prints the same, timings and warnings included
+    string built = parse(parser, include_paths);
+    CHECK(built.find("cannot resolve import extra.camkes") != string::npos);
+    CHECK(cached(include_paths));
+    CHECK(!cached({}));
+    CHECK(parse(parser, include_paths) == built);
+
+    // a changed import is a miss, and the snapshot rebuilt from it is used again
+    write_file("server.camkes", string(SERVER_FILE) + "\n");
+    CHECK(!cached(include_paths));
+    CHECK(parse(parser, include_paths) == built);
+    CHECK(cached(include_paths));
+
+    // an import created where a missing one was searched for is a miss, in the include path as next to the importer
+    write_file("include/extra.camkes", EXTRA_FILE);
+    CHECK(!cached(include_paths));
+    string extended = parse(parser, include_paths);
+    CHECK(extended != built && extended.find("s.q") != string::npos);
+    CHECK(cached(include_paths));
+    write_file("extra.camkes", EXTRA_FILE);
+    CHECK(!cached(include_paths));
+    CHECK(parse(parser, include_paths) == extended);
+    CHECK(cached(include_paths));
+
+    // a truncated snapshot, a flipped byte anywhere, and a snapshot from a host of the other byte order are misses
+    string snapshot = read_snapshot();
+    for (size_t length : {size_t(0), size_t(7), size_t(20), snapshot.size() / 2, snapshot.size() - 1})
+    {
+        write_snapshot(snapshot.substr(0, length));
+        CHECK(!cached(include_paths));
+    }
+    for (size_t position = 0; position < snapshot.size(); position += 1 + snapshot.size() / 97)
+    {
+        string corrupt = snapshot;
+        corrupt[position] ^= 0x10;
+        write_snapshot(corrupt);
+        if (cached(include_paths))
+        {
+            cerr << "a snapshot with byte " << position << " flipped is used" << endl;
+        }
+        CHECK(!cached(include_paths));
+    }
+    // the byte order mark follows the magic and the version, the checksum is written again so only the mark differs
+    string swapped = snapshot.substr(0, snapshot.size() - sizeof(uint64_t));
+    swap(swapped[12], swapped[15]);
+    swap(swapped[13], swapped[14]);
+    uint64_t checksum = hash_bytes(swapped);
+    swapped.append(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+    write_snapshot(swapped);
+    CHECK(!cached(include_paths));
+    // each miss is rebuilt into the same output
+    CHECK(parse(parser, include_paths) == extended);
+    CHECK(read_snapshot() == snapshot);
+
+    filesystem::remove_all(DIRECTORY);
+    return failures == 0 ? 0 : 1;
+}
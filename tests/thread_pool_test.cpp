@@ -0,0 +1,118 @@
+/*
+ *  thread_pool_test.cpp
+ *  behaviour tests of the thread pool
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "thread_pool.hpp"
+#include <vector>
+#include <thread>
+#include <future>
+#include <atomic>
+#include <stdexcept>
+
+using namespace std;
+
+// sum of [begin, end) computed by tasks splitting the range in halves, each waiting on the half it submitted
+static size_t nested_sum(thread_pool &pool, size_t begin, size_t end)
+{
+    if (end - begin <= 4)
+    {
+        size_t sum = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            sum += i;
+        }
+        return sum;
+    }
+    size_t middle = begin + (end - begin) / 2;
+    task_future<size_t> upper = pool.submit([&pool, middle, end]() { return nested_sum(pool, middle, end); });
+    size_t lower = nested_sum(pool, begin, middle);
+    pool.wait(upper);
+    return lower + upper.get();
+}
+
+int main()
+{
+    // with every worker busy, waiting on a queued task runs it on the waiting thread, and only that task
+    {
+        thread_pool pool(2);
+        promise<void> gate;
+        shared_future<void> opened = gate.get_future().share();
+        atomic<size_t> blocked{0};
+        vector<task_future<void>> blockers;
+        for (size_t i = 0; i < pool.size(); i++)
+        {
+            blockers.push_back(pool.submit([&blocked, opened]()
+            {
+                blocked++;
+                opened.wait();
+            }));
+        }
+        while (blocked < pool.size())
+        {
+            this_thread::yield();
+        }
+        atomic<bool> unrelated_ran{false};
+        task_future<void> unrelated = pool.submit([&unrelated_ran]() { unrelated_ran = true; });
+        task_future<thread::id> awaited = pool.submit([]() { return this_thread::get_id(); });
+        pool.wait(awaited);
+        CHECK(awaited.get() == this_thread::get_id());
+        CHECK(!unrelated_ran);
+        gate.set_value();
+        pool.wait(unrelated);
+        CHECK(unrelated_ran);
+        for (task_future<void> &blocker : blockers)
+        {
+            pool.wait(blocker);
+        }
+    }
+
+    // waiting on a task a worker already runs blocks until it finishes, and rethrows what it threw
+    {
+        thread_pool pool(1);
+        task_future<int> failing = pool.submit([]() -> int { throw runtime_error("failed"); });
+        pool.wait(failing);
+        bool thrown = false;
+        try
+        {
+            failing.get();
+        }
+        catch (const runtime_error &)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    // tasks waiting on the tasks they submit finish on any number of workers, including one
+    for (size_t workers : {1, 2, 3, 8})
+    {
+        thread_pool pool(workers);
+        for (size_t round = 0; round < 20; round++)
+        {
+            CHECK(nested_sum(pool, 0, 1000) == 999 * 1000 / 2);
+            task_future<size_t> inside = pool.submit([&pool]() { return nested_sum(pool, 0, 1000); });
+            pool.wait(inside);
+            CHECK(inside.get() == 999 * 1000 / 2);
+        }
+    }
+
+    // parallel_for calls the function once for each index
+    {
+        thread_pool pool(4);
+        vector<atomic<size_t>> calls(10000);
+        pool.parallel_for(calls.size(), [&](size_t i) { calls[i]++; });
+        size_t total = 0;
+        bool once = true;
+        for (atomic<size_t> &count : calls)
+        {
+            total += count;
+            once = once && count == 1;
+        }
+        CHECK(once && total == calls.size());
+    }
+
+    return failures == 0 ? 0 : 1;
+}
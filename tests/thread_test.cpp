@@ -0,0 +1,168 @@
+/*
+ *  thread_test.cpp
+ *  behaviour tests of the thread counting
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "random_configuration.hpp"
+#include "camkes_parser.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <set>
+#include <unordered_map>
+
+using namespace std;
+
+typedef set<string_view> task_names;
+
+// What a node passes on to the nodes it requests, as the original recursive get_threads gathered it: the tasks reaching it,
+// the fixed sets condensed by ipcp and pip connections in visiting order, and the last decision on a nested thread, if any.
+// It does not depend on what was gathered before the node, so it is computed once per node.
+struct contribution
+{
+    task_names threads;
+    vector<task_names> fixed_threads_pool;
+    bool nested_decided = false;
+    bool require_nested_thread = false;
+};
+
+// Thread counting with ordered sets of task names, following the original node classes.
+class reference_counter
+{
+private:
+    unordered_map<string_view, const node_result *> nodes;
+    unordered_map<string_view, contribution> memo;
+
+public:
+    explicit reference_counter(const analysis_result &analysis)
+    {
+        for (const node_result &node : analysis.nodes)
+        {
+            nodes.emplace(node.identifier, &node);
+        }
+    }
+
+    // gather what the requestors of a node pass on, in order
+    contribution gather(const node_result &node)
+    {
+        contribution gathered;
+        for (string_view requestor : node.requestors)
+        {
+            const contribution &provided = provide(*nodes.at(requestor));
+            gathered.threads.insert(provided.threads.begin(), provided.threads.end());
+            gathered.fixed_threads_pool.insert(gathered.fixed_threads_pool.end(), provided.fixed_threads_pool.begin(), provided.fixed_threads_pool.end());
+            if (provided.nested_decided)
+            {
+                gathered.nested_decided = true;
+                gathered.require_nested_thread = provided.require_nested_thread;
+            }
+        }
+        return gathered;
+    }
+
+    // what a node passes on: a task its own thread, ipcp and pip connections one fixed set of everything they gather
+    const contribution &provide(const node_result &node)
+    {
+        auto it = memo.find(node.identifier);
+        if (it != memo.end())
+        {
+            return it->second;
+        }
+        contribution provided;
+        if (node.type == type_t::task)
+        {
+            provided.threads.insert(node.identifier);
+        }
+        else if (node.type == type_t::component || node.protocol == protocol_t::propagation)
+        {
+            provided = gather(node);
+        }
+        else if (node.protocol == protocol_t::ipcp || node.protocol == protocol_t::pip)
+        {
+            contribution nested = gather(node);
+            task_names condensed = nested.threads;
+            for (const task_names &fixed : nested.fixed_threads_pool)
+            {
+                condensed.insert(fixed.begin(), fixed.end());
+            }
+            provided.fixed_threads_pool.push_back(condensed);
+            provided.nested_decided = true;
+            provided.require_nested_thread = node.protocol == protocol_t::pip;
+        }
+        return memo.emplace(node.identifier, provided).first->second;
+    }
+
+    // the threads of a node: its tasks, one for each fixed set with a task outside them, and one for a nested thread
+    size_t count(const node_result &node)
+    {
+        if (node.type == type_t::task || node.protocol == protocol_t::ipcp)
+        {
+            return 1;
+        }
+        contribution requested = gather(node);
+        size_t count = requested.threads.size();
+        for (const task_names &fixed : requested.fixed_threads_pool)
+        {
+            for (string_view task : fixed)
+            {
+                if (requested.threads.count(task) == 0)
+                {
+                    count++;
+                    break;
+                }
+            }
+        }
+        return count + requested.require_nested_thread;
+    }
+};
+
+// the thread count and its trace of every node match the reference
+static void check_configuration(const camkes_parser &parser, const random_shape &shape)
+{
+    random_configuration generated = generate_random_configuration(shape);
+    parse_options options;
+    options.trace = true;
+    parse_result result = parser.parse_buffer(generated.text, "random.camkes", options);
+    CHECK(result.ok());
+    reference_counter reference(result.analysis);
+    for (const node_result &node : result.analysis.nodes)
+    {
+        size_t expected = reference.count(node);
+        if (node.thread_count != expected)
+        {
+            cerr << "seed " << shape.seed << ": " << node.identifier << " has " << node.thread_count << " threads rather than " << expected << endl;
+        }
+        CHECK(node.thread_count == expected);
+        if (!node.traced)
+        {
+            continue;
+        }
+        contribution requested = reference.gather(node);
+        CHECK(task_names(node.threads.begin(), node.threads.end()) == requested.threads);
+        CHECK(node.fixed_threads.size() == requested.fixed_threads_pool.size());
+        for (size_t i = 0; i < min(node.fixed_threads.size(), requested.fixed_threads_pool.size()); i++)
+        {
+            CHECK(task_names(node.fixed_threads[i].begin(), node.fixed_threads[i].end()) == requested.fixed_threads_pool[i]);
+        }
+        CHECK(node.nested_thread == requested.require_nested_thread);
+    }
+}
+
+int main()
+{
+    camkes_parser parser(2);
+    for (uint64_t seed = 1; seed <= 50; seed++)
+    {
+        random_shape shape;
+        shape.seed = seed;
+        check_configuration(parser, shape);
+        // more tasks than fit in one word of a thread set
+        shape.tasks = 150;
+        shape.servers = 30;
+        shape.max_requestors = 8;
+        check_configuration(parser, shape);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+/*
+ *  what_if_test.cpp
+ *  behaviour tests of the incremental what-if engine
+ *  author: jordan sun
+ */
+
+#include "check.hpp"
+#include "random_configuration.hpp"
+#include "camkes_parser.hpp"
+#include "what_if_engine.hpp"
+#include "emitter.hpp"
+#include <string>
+#include <vector>
+#include <set>
+#include <sstream>
+#include <random>
+
+using namespace std;
+
+static string emitted(const analysis_result &analysis)
+{
+    ostringstream output;
+    emit(analysis, output_format::text, true, output);
+    return output.str();
+}
+
+// identifiers of the nodes whose priority, thread count or protocol differ between two analyses of the same graph
+static set<string> changed_nodes(const analysis_result &before, const analysis_result &after)
+{
+    set<string> changed;
+    for (size_t i = 0; i < before.nodes.size() && i < after.nodes.size(); i++)
+    {
+        const node_result &a = before.nodes[i];
+        const node_result &b = after.nodes[i];
+        if (a.priority != b.priority || a.thread_count != b.thread_count || a.protocol != b.protocol)
+        {
+            changed.insert(string(b.identifier));
+        }
+    }
+    return changed;
+}
+
+static set<string> identifiers(const analysis_result &analysis)
+{
+    set<string> result;
+    for (const node_result &node : analysis.nodes)
+    {
+        result.insert(string(node.identifier));
+    }
+    return result;
+}
+
+// batches of random priority and protocol edits give the changed nodes and the values of a full rebuild of the edited configuration
+static void check_edits(const camkes_parser &parser, const random_shape &shape, bool ladder)
+{
+    static const char *const PROTOCOLS[] = {"fixed", "inherited", "propagated"};
+    random_configuration generated = generate_random_configuration(shape);
+    parse_options options;
+    options.ladder = ladder;
+    options.trace = true;
+    parse_result built = parser.parse_buffer(generated.text, "what_if.camkes", options);
+    CHECK(built.ok());
+    if (!built.ok())
+    {
+        return;
+    }
+    what_if_engine engine(*built.graph, true);
+    CHECK(emitted(engine.results()) == emitted(built.analysis));
+
+    mt19937_64 random(shape.seed);
+    analysis_result previous = built.analysis;
+    for (size_t round = 0; round < 30; round++)
+    {
+        // a batch may edit a node more than once, and may set a value it already has
+        vector<what_if_edit> edits;
+        size_t count = 1 + random() % 6;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (random() % 2 == 0)
+            {
+                size_t task = random() % shape.tasks;
+                generated.priorities[task] = random() % 4 == 0 ? generated.priorities[task] : 1 + random() % 254;
+                edits.push_back(what_if_edit::set_priority("t" + to_string(task), generated.priorities[task]));
+            }
+            else
+            {
+                size_t server = random() % shape.servers;
+                generated.protocols[server] = PROTOCOLS[random() % 3];
+                edits.push_back(what_if_edit::set_protocol("s" + to_string(server) + ".p", generated.protocols[server]));
+            }
+        }
+        analysis_result changed = engine.apply(edits);
+        parse_result rebuilt = parser.parse_buffer(configuration_text(generated), "what_if.camkes", options);
+        CHECK(rebuilt.ok());
+        if (!rebuilt.ok())
+        {
+            return;
+        }
+        bool same = emitted(engine.results()) == emitted(rebuilt.analysis);
+        bool same_changes = identifiers(changed) == changed_nodes(previous, rebuilt.analysis);
+        if (!same || !same_changes)
+        {
+            cerr << "seed " << shape.seed << (ladder ? " with the ladder" : "") << ", round " << round << ": the edits differ from a full rebuild" << endl;
+        }
+        CHECK(same && same_changes);
+        // the changed nodes carry their new values
+        for (const node_result &node : changed.nodes)
+        {
+            const node_result *full = nullptr;
+            for (const node_result &candidate : rebuilt.analysis.nodes)
+            {
+                full = candidate.identifier == node.identifier ? &candidate : full;
+            }
+            CHECK(full != nullptr && full->priority == node.priority && full->thread_count == node.thread_count && full->protocol == node.protocol);
+        }
+        previous = rebuilt.analysis;
+    }
+    CHECK(engine.diags.error_count() == 0);
+}
+
+int main()
+{
+    camkes_parser parser(2);
+    for (uint64_t seed = 1; seed <= 40; seed++)
+    {
+        random_shape shape;
+        shape.seed = seed;
+        shape.tasks = 2 + seed % 12;
+        shape.servers = 5 + seed % 40;
+        shape.max_requestors = 1 + seed % 4;
+        check_edits(parser, shape, seed % 2 == 0);
+    }
+
+    // edits to unknown nodes, to nodes of the wrong kind or to unknown protocols are reported and change nothing
+    random_shape shape;
+    random_configuration generated = generate_random_configuration(shape);
+    parse_result built = parser.parse_buffer(generated.text, "what_if.camkes", parse_options());
+    what_if_engine engine(*built.graph);
+    analysis_result changed = engine.apply({
+        what_if_edit::set_priority("missing", 3),
+        what_if_edit::set_priority("s0.p", 3),
+        what_if_edit::set_protocol("missing.p", "fixed"),
+        what_if_edit::set_protocol("t0", "fixed"),
+        what_if_edit::set_protocol("s0.p", "unknown"),
+    });
+    CHECK(changed.nodes.empty() && emitted(engine.results()) == emitted(built.analysis));
+    CHECK(engine.diags.error_count() == 5);
+    for (const char *code : {"unknown-component", "not-a-component", "unknown-connection", "not-a-connection", "unknown-protocol"})
+    {
+        bool reported = false;
+        for (const diagnostic &entry : engine.diags.get_entries())
+        {
+            reported = reported || entry.code == code;
+        }
+        CHECK(reported);
+    }
+
+    return failures == 0 ? 0 : 1;
+}